@@ -0,0 +1,110 @@
+#include "main/model.h"
+#include "main/rayTracer.h"
+#include "obj/generators.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compares bounding volume hierarchy used by RayTracer::rayTrace() with
+// checking every triangle one by one. Reports build time of the hierarchy,
+// number of traced rays per second and number of rays, for which both
+// methods disagree.
+
+const int kNumOfRaysSquared = 60;
+const int kMaxTracking = 4;
+const float kSkipPower = 500;
+const float kSkipFrequency = 1000;
+
+const std::vector<std::string> kDefaultModels = {
+    "./validationDiffusors/1D_1m_modulo23_500Hz_46n_30stopni_5potega.obj",
+    "./validationDiffusors/1D_2m_modulo13_250Hz_9n_15stopni_5potega.obj",
+    "./validationDiffusors/2D_1m_200Hz_modulo7_30stopni_6n.obj",
+    "./validationDiffusors/2D_2m_6n_modulo7_200Hz_15stopni_5potega.obj"};
+
+// Collects source rays and their specular reflections, so that measured rays
+// are the same as the ones traced in the simulation.
+std::vector<core::Ray> collectRays(Model *model, const RayTracer &tracer) {
+  std::vector<core::Ray> rays;
+  generators::PointSpeakerRayFactory source(kNumOfRaysSquared, kSkipPower,
+                                            model);
+  core::Ray ray;
+  while (source.genRay(&ray)) {
+    core::Ray current = ray;
+    for (int tracking = 0; tracking < kMaxTracking; ++tracking) {
+      rays.push_back(current);
+      core::RayHitData hitData;
+      if (tracer.rayTrace(current, kSkipFrequency, &hitData) !=
+          RayTracer::TraceResult::HIT_TRIANGLE) {
+        break;
+      }
+      current = tracer.getReflected(&hitData);
+    }
+  }
+  return rays;
+}
+
+template <typename TraceFunction>
+double measureRaysPerSecond(const std::vector<core::Ray> &rays,
+                            TraceFunction trace) {
+  auto start = std::chrono::steady_clock::now();
+  for (const core::Ray &ray : rays) {
+    core::RayHitData hitData;
+    [[maybe_unused]] RayTracer::TraceResult result =
+        trace(ray, kSkipFrequency, &hitData);
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return rays.size() / seconds;
+}
+
+// ARGS MAY CONTAIN:
+// paths to .obj files, that will be used instead of validation diffusors.
+int main(int argc, char *argv[]) {
+  std::vector<std::string> paths(&argv[1], &argv[argc]);
+  if (paths.empty()) {
+    paths = kDefaultModels;
+  }
+
+  for (const std::string &path : paths) {
+    std::unique_ptr<Model> model = Model::NewLoadFromObjectFile(path);
+    RayTracer tracer(model.get());
+    std::vector<core::Ray> rays = collectRays(model.get(), tracer);
+
+    int mismatches = 0;
+    for (const core::Ray &ray : rays) {
+      core::RayHitData accelerated, reference;
+      RayTracer::TraceResult acceleratedResult =
+          tracer.rayTrace(ray, kSkipFrequency, &accelerated);
+      RayTracer::TraceResult referenceResult =
+          tracer.rayTraceWithoutAcceleration(ray, kSkipFrequency, &reference);
+      if (acceleratedResult != referenceResult ||
+          (referenceResult == RayTracer::TraceResult::HIT_TRIANGLE &&
+           std::abs(accelerated.time - reference.time) >
+               constants::kAccuracy)) {
+        ++mismatches;
+      }
+    }
+
+    double accelerated = measureRaysPerSecond(
+        rays, [&](const core::Ray &ray, float frequency,
+                  core::RayHitData *hitData) {
+          return tracer.rayTrace(ray, frequency, hitData);
+        });
+    double reference = measureRaysPerSecond(
+        rays, [&](const core::Ray &ray, float frequency,
+                  core::RayHitData *hitData) {
+          return tracer.rayTraceWithoutAcceleration(ray, frequency, hitData);
+        });
+
+    std::cout << path << "\n"
+              << tracer.hierarchy() << "\tTraced rays: " << rays.size() << "\n"
+              << "\tHierarchy: " << accelerated << " [rays/s]\n"
+              << "\tLinear search: " << reference << " [rays/s]\n"
+              << "\tSpeedup: " << accelerated / reference << "x\n"
+              << "\tMismatches: " << mismatches << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include "main/checkpoint.h"
+#include "main/resultsCalculation.h"
+#include "main/trackers.h"
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using Collectors = std::vector<std::unique_ptr<objects::EnergyCollector>>;
+
+const int kSampleRate = 96e3;
+
+// Loads shards "<shards path>.<kind>.i" saved by validation with shard i of
+// |numOfShards| and sums their energy.
+std::unordered_map<float, Collectors> mergeShards(const std::string &shardsPath,
+                                                  const std::string &kind,
+                                                  int numOfShards) {
+  std::vector<checkpoints::Checkpoint> shards;
+  for (int shard = 0; shard < numOfShards; ++shard) {
+    const std::string path =
+        shardsPath + "." + kind + "." + std::to_string(shard);
+    std::optional<checkpoints::Checkpoint> checkpoint = checkpoints::load(path);
+    if (!checkpoint) {
+      std::stringstream ss;
+      ss << "Shard: " << path << " does not exist!";
+      throw std::invalid_argument(ss.str());
+    }
+    shards.push_back(std::move(*checkpoint));
+  }
+  return checkpoints::toCollectors(checkpoints::mergeShards(std::move(shards)));
+}
+
+// ARGS MUST CONTAIN:
+// #2 raport path
+// #3 numOfShards
+// #4 shards path (optional, raport path by default), raport path given to
+//    validation of every shard.
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> args(&argv[0], &argv[0 + argc]);
+  const std::string raportPath = args[1];
+  const int numOfShards = std::stoi(args[2]);
+  const std::string shardsPath = args.size() > 3 ? args[3] : raportPath;
+
+  std::cout << "merging " << numOfShards << " shards of: " << shardsPath
+            << std::endl;
+  std::unordered_map<float, Collectors> mapOfCollectors =
+      mergeShards(shardsPath, "model", numOfShards);
+  std::unordered_map<float, Collectors> referenceMapOfCollectors =
+      mergeShards(shardsPath, "reference", numOfShards);
+
+  WaveObjectFactory waveFactory(kSampleRate);
+
+  std::vector<ResultInterface *> acousticParameters;
+
+  // #1 Diffusion Coefficient
+  DiffusionCoefficient diffusion(&waveFactory);
+  acousticParameters.push_back(&diffusion);
+
+  // #2 Normalized Diffusion Coefficient
+  NormalizedDiffusionCoefficient normalizedDiffusion(&waveFactory,
+                                                     referenceMapOfCollectors);
+  acousticParameters.push_back(&normalizedDiffusion);
+
+  trackers::ResultTracker resultTracker;
+  for (ResultInterface *result : acousticParameters) {
+    std::map<float, float> resultPerFrequency =
+        result->getResults(mapOfCollectors);
+    resultTracker.registerResult(result->getName(), resultPerFrequency);
+  }
+  resultTracker.generateRaport();
+  resultTracker.saveRaport(raportPath);
+  std::cout << trackers::AsyncFileWriter::instance() << std::endl;
+}
@@ -0,0 +1,151 @@
+#include "main/model.h"
+#include "main/resultsCalculation.h"
+#include "main/sceneManager.h"
+#include "main/simulator.h"
+#include "obj/generators.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Compares how fast diffusion coefficient converges with the number of rays
+// for every way of aiming source rays at the model. Error of each run is the
+// mean absolute difference from the reference diffusion coefficient, averaged
+// over |kFrequencies|. Reference is the mean of |kNumOfReferenceSeeds| runs
+// with |kReferenceRaysSquared|^2 rays of the scrambled Sobol source, scrambled
+// with seeds that no compared run uses, so compared runs are not a part of
+// the reference. Errors of the scrambled Sobol source are averaged over
+// |kNumOfSeeds| seeds, other sources do not depend on the seed.
+
+using Collectors = std::vector<std::unique_ptr<objects::EnergyCollector>>;
+
+const int kSampleRate = 96e3;
+const float kSourcePower = 500;
+const int kNumOfCollectors = 37;
+const int kMaxTracking = 4;
+const int kReferenceRaysSquared = 256;
+const int kNumOfReferenceSeeds = 8;
+const uint64_t kFirstReferenceSeed = 1000;
+const int kNumOfSeeds = 8;
+const std::vector<int> kNumOfRaysSquared = {8, 16, 32, 64, 128};
+const std::vector<float> kFrequencies = {250, 500, 1000, 2000};
+const std::vector<generators::SourceSampling> kSamplings = {
+    generators::SourceSampling::kGrid, generators::SourceSampling::kHalton,
+    generators::SourceSampling::kSobol,
+    generators::SourceSampling::kScrambledSobol};
+
+const std::vector<std::string> kDefaultModels = {
+    "./validationDiffusors/1D_1m_modulo23_500Hz_46n_30stopni_5potega.obj",
+    "./validationDiffusors/1D_2m_modulo13_250Hz_9n_15stopni_5potega.obj",
+    "./validationDiffusors/2D_1m_200Hz_modulo7_30stopni_6n.obj",
+    "./validationDiffusors/2D_2m_6n_modulo7_200Hz_15stopni_5potega.obj"};
+
+std::map<float, float> diffusionCoefficient(Model *model,
+                                            generators::SourceSampling sampling,
+                                            int numOfRaysSquared,
+                                            uint64_t seed) {
+  trackers::FakePositionTracker positionTracker;
+  trackers::FakeCollectorsTracker collectorsTracker;
+  collectionRules::NonLinearEnergyCollection energyCollectionRules;
+  // Specular reflections keep differences between results caused only by the
+  // source, and let SceneManager trace every path once for all frequencies.
+  FakeReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  BasicSimulationProperties basicProperties(kFrequencies, kSourcePower,
+                                            kNumOfCollectors, numOfRaysSquared,
+                                            kMaxTracking);
+  basicProperties.sourceSampling = sampling;
+  basicProperties.seed = seed;
+  SimulationProperties properties(&energyCollectionRules, basicProperties);
+  SceneManager manager(model, properties, &positionTracker,
+                       &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> collectors =
+      manager.newRun(&collectorBuilder);
+
+  WaveObjectFactory waveFactory(kSampleRate);
+  DiffusionCoefficient diffusion(&waveFactory);
+  return diffusion.getResults(collectors);
+}
+
+std::map<float, float> referenceDiffusionCoefficient(Model *model) {
+  std::map<float, float> reference;
+  for (int index = 0; index < kNumOfReferenceSeeds; ++index) {
+    for (const auto &[frequency, value] : diffusionCoefficient(
+             model, generators::SourceSampling::kScrambledSobol,
+             kReferenceRaysSquared, kFirstReferenceSeed + index)) {
+      reference[frequency] += value / kNumOfReferenceSeeds;
+    }
+  }
+  return reference;
+}
+
+float meanAbsoluteError(const std::map<float, float> &results,
+                        const std::map<float, float> &reference) {
+  float error = 0;
+  for (const auto &[frequency, value] : results) {
+    error += std::abs(value - reference.at(frequency));
+  }
+  return error / results.size();
+}
+
+// Returns mean absolute error of runs with |sampling| averaged over seeds.
+float meanAbsoluteError(Model *model, generators::SourceSampling sampling,
+                        int numOfRaysSquared,
+                        const std::map<float, float> &reference) {
+  const int numOfSeeds =
+      sampling == generators::SourceSampling::kScrambledSobol ? kNumOfSeeds
+                                                              : 1;
+  float error = 0;
+  for (int seed = 0; seed < numOfSeeds; ++seed) {
+    error += meanAbsoluteError(
+        diffusionCoefficient(model, sampling, numOfRaysSquared, seed),
+        reference);
+  }
+  return error / numOfSeeds;
+}
+
+// ARGS MAY CONTAIN:
+// paths to .obj files, that will be used instead of validation diffusors.
+int main(int argc, char *argv[]) {
+  std::vector<std::string> paths(&argv[1], &argv[argc]);
+  if (paths.empty()) {
+    paths = kDefaultModels;
+  }
+
+  std::vector<std::string> report;
+  for (const std::string &path : paths) {
+    std::unique_ptr<Model> model = Model::NewLoadFromObjectFile(path);
+    std::map<float, float> reference =
+        referenceDiffusionCoefficient(model.get());
+
+    std::stringstream table;
+    table << path << "\n" << std::setw(16) << "rays";
+    for (generators::SourceSampling sampling : kSamplings) {
+      std::stringstream name;
+      name << sampling;
+      table << std::setw(16) << name.str();
+    }
+    table << "\n";
+    for (int numOfRaysSquared : kNumOfRaysSquared) {
+      table << std::setw(16) << numOfRaysSquared * numOfRaysSquared;
+      for (generators::SourceSampling sampling : kSamplings) {
+        table << std::setw(16)
+              << meanAbsoluteError(model.get(), sampling, numOfRaysSquared,
+                                   reference);
+      }
+      table << "\n";
+    }
+    report.push_back(table.str());
+  }
+
+  std::cout << "\nMEAN ABSOLUTE ERROR OF DIFFUSION COEFFICIENT\n";
+  for (const std::string &table : report) {
+    std::cout << table << "\n";
+  }
+  return 0;
+}
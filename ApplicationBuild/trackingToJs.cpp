@@ -0,0 +1,20 @@
+#include "main/trackers.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Converts trackings saved by trackers::BinaryPositionTracker into the
+// "trackingData.js" file displayed by the GUI.
+// ARGS MAY CONTAIN:
+// #2 path to the directory with "trackingData.bin" and "trackingData.index"
+//    files, "./server/data" by default. "trackingData.js" is written there.
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> args(&argv[0], &argv[0 + argc]);
+  const std::string dataPath = args.size() > 1 ? args[1] : "./server/data";
+
+  std::cout << "converting trackings at: " << dataPath << std::endl;
+  trackers::convertBinaryTrackingToJs(dataPath);
+  return 0;
+}
@@ -3,9 +3,11 @@
 #include "main/resultsCalculation.h"
 #include "main/sceneManager.h"
 #include "main/simulator.h"
+#include "main/trackers.h"
 #include "obj/generators.h"
 
 #include <algorithm>
+#include <iostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +32,15 @@ float kDefaultModelSize = 1.0;
 // #5 numOfCollectors
 // #6 numOfRaysSquared
 // #7 maxTracking
+// #8 numOfThreads (optional, 1 by default)
+// #9 seed (optional, 0 by default)
+// #10 diffusionTolerance (optional, 0 by default). When given, rays are traced
+//     in batches until diffusion coefficient is known within tolerance and
+//     #6 numOfRaysSquared squared is the limit of rays per frequency.
+// #11 shard (optional) as "i/N". When given, only shard i of N traces its part
+//     of rays and saves collected energy to "<raport path>.model.i" and
+//     "<raport path>.reference.i" instead of the raport. Raport is then made
+//     by mergeShards from files of all N shards.
 
 int main(int argc, char *argv[]) {
   std::vector<std::string> args(&argv[0], &argv[0 + argc]);
@@ -52,7 +63,30 @@ int main(int argc, char *argv[]) {
   //   energyCollectionRules;
   BasicSimulationProperties basicProperties(
       frequencies, sourcePower, numOfCollectors, numOfRaysSquared, maxTracking);
+  if (args.size() > 7) {
+    basicProperties.numOfThreads = std::stoi(args[7]);
+  }
+  if (args.size() > 8) {
+    basicProperties.seed = std::stoull(args[8]);
+  }
+  if (args.size() > 9) {
+    basicProperties.diffusionTolerance = std::stof(args[9]);
+  }
+  BasicSimulationProperties referenceBasicProperties = basicProperties;
+  if (args.size() > 10) {
+    const size_t separator = args[10].find('/');
+    basicProperties.shardIndex = std::stoi(args[10].substr(0, separator));
+    basicProperties.numOfShards = std::stoi(args[10].substr(separator + 1));
+    const std::string shard = std::to_string(basicProperties.shardIndex);
+    referenceBasicProperties = basicProperties;
+    basicProperties.checkpointPath =
+        std::string(raportPath) + ".model." + shard;
+    referenceBasicProperties.checkpointPath =
+        std::string(raportPath) + ".reference." + shard;
+  }
   SimulationProperties properties(&energyCollectionRules, basicProperties);
+  SimulationProperties referenceProperties(&energyCollectionRules,
+                                           referenceBasicProperties);
 
   XAxisCollectorBuilder collectorBuilder;
   SimpleFourSidedReflectionEngine reflectionEngine;
@@ -64,11 +98,17 @@ int main(int argc, char *argv[]) {
 
   std::unique_ptr<Model> referenceModel =
       Model::NewReferenceModel(model->sideSize());
-  SceneManager referenceModelManager(referenceModel.get(), properties,
+  SceneManager referenceModelManager(referenceModel.get(), referenceProperties,
                                      &positionTracker, &collectorsTracker,
                                      &reflectionEngine);
   std::unordered_map<float, Collectors> referenceMapOfCollectors =
       referenceModelManager.newRun(&collectorBuilder);
+  if (basicProperties.numOfShards > 1) {
+    std::cout << "shard saved to: " << basicProperties.checkpointPath << " and "
+              << referenceBasicProperties.checkpointPath << std::endl;
+    std::cout << trackers::AsyncFileWriter::instance() << std::endl;
+    return 0;
+  }
 
   WaveObjectFactory waveFactory(kSampleRate);
 
@@ -89,10 +129,14 @@ int main(int argc, char *argv[]) {
         result->getResults(mapOfCollectors);
     resultTracker.registerResult(result->getName(), resultPerFrequency);
   }
+  if (!manager.raysUsed().empty()) {
+    resultTracker.registerResult("Rays Used", manager.raysUsed());
+  }
 
   trackers::Json raport = resultTracker.generateRaport();
   // TODO: This should not be member of restultsTracker()
   // make another interface for it;
   // resultTracker.compareDataToReference();
   resultTracker.saveRaport(raportPath.data());
+  std::cout << trackers::AsyncFileWriter::instance() << std::endl;
 }
@@ -0,0 +1,28 @@
+#include "benchmarks/allocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<size_t> allocations{0};
+} // namespace
+
+size_t numOfAllocations() { return allocations; }
+
+// Array and nothrow forms of the default operators call these ones. They are
+// not inlined even with link time optimization.
+__attribute__((noinline)) void *operator new(size_t size) {
+  ++allocations;
+  if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+  std::free(memory);
+}
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept {
+  std::free(memory);
+}
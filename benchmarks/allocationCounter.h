@@ -0,0 +1,13 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+// Returns number of calls to the global operator new made by the program so
+// far. Replacements of the global operators new and delete, that count the
+// calls, are defined in allocationCounter.cpp and never inlined into callers,
+// so compiler does not pair allocations made by them with the built in
+// operators.
+size_t numOfAllocations();
+
+#endif
@@ -0,0 +1,138 @@
+#include "main/model.h"
+#include "main/resultsCalculation.h"
+#include "main/simulator.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Measures collection of energy of rays that reached the sphere wall and
+// calculation of total pressure from the collected energy.
+
+const int kNumOfCollectors = 37;
+const int kNumOfHits = 4096;
+const int kSampleRate = 96e3;
+const float kSkipFrequency = 1000;
+
+// Returns hits on the sphere wall in random directions, arriving at random
+// time between 10 and 100 ms.
+std::vector<core::RayHitData> sphereWallHits(float sphereWallRadius) {
+  std::mt19937 engine(2137);
+  std::normal_distribution<float> direction(0, 1);
+  std::uniform_real_distribution<float> arrivalTime(0.01, 0.1);
+  std::vector<core::RayHitData> hits;
+  for (int hit = 0; hit < kNumOfHits; ++hit) {
+    core::Vec3 randomDirection(direction(engine), direction(engine),
+                               direction(engine));
+    hits.emplace_back(sphereWallRadius, core::Vec3::kZ,
+                      core::Ray(core::Vec3::kZero, randomDirection.normalize()),
+                      kSkipFrequency, arrivalTime(engine));
+  }
+  return hits;
+}
+
+// Measures collection that checks every collector when |state.range(0)| is 0,
+// and collection that checks only candidates from CollectorIndex otherwise.
+template <typename EnergyCollectionRules>
+void BM_CollectEnergy(benchmark::State &state) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  Collectors collectors = GeometricDomeCollectorBuilder().buildCollectors(
+      model.get(), kNumOfCollectors);
+  const collectionRules::CollectorIndex index(collectors);
+  std::vector<core::RayHitData> hits =
+      sphereWallHits(getSphereWallRadius(*model));
+  EnergyCollectionRules energyCollectionRules;
+  const bool indexed = state.range(0) != 0;
+
+  for (auto _ : state) {
+    for (core::RayHitData hitData : hits) {
+      if (indexed) {
+        energyCollectionRules.collectEnergy(collectors, index, &hitData);
+      } else {
+        energyCollectionRules.collectEnergy(collectors, &hitData);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * hits.size());
+  state.SetLabel(indexed ? "indexed" : "all collectors");
+}
+BENCHMARK_TEMPLATE(BM_CollectEnergy, collectionRules::LinearEnergyCollection)
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK_TEMPLATE(BM_CollectEnergy,
+                   collectionRules::LinearEnergyCollectionWithPhaseImpact)
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK_TEMPLATE(BM_CollectEnergy,
+                   collectionRules::NonLinearEnergyCollection)
+    ->Arg(0)
+    ->Arg(1);
+
+// Collects energy in |state.range(0)| frequency bands, either in all bands at
+// once (|state.range(1)| is 1) or separately for every band.
+template <typename EnergyCollectionRules>
+void BM_CollectEnergyInBands(benchmark::State &state) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  const int numOfBands = state.range(0);
+  const bool allBandsAtOnce = state.range(1) != 0;
+  std::vector<float> frequencies;
+  std::vector<Collectors> collectorsPerBand;
+  std::vector<Collectors *> bands;
+  for (int band = 0; band < numOfBands; ++band) {
+    frequencies.push_back(100 * std::pow(2.0f, band / 3.0f));
+    collectorsPerBand.push_back(GeometricDomeCollectorBuilder().buildCollectors(
+        model.get(), kNumOfCollectors));
+  }
+  for (Collectors &collectors : collectorsPerBand) {
+    bands.push_back(&collectors);
+  }
+  const collectionRules::CollectorIndex index(collectorsPerBand.front());
+  std::vector<core::RayHitData> hits =
+      sphereWallHits(getSphereWallRadius(*model));
+  EnergyCollectionRules energyCollectionRules;
+
+  for (auto _ : state) {
+    for (core::RayHitData hitData : hits) {
+      if (allBandsAtOnce) {
+        energyCollectionRules.collectEnergyInBands(bands, frequencies, index,
+                                                   hitData);
+        continue;
+      }
+      for (int band = 0; band < numOfBands; ++band) {
+        hitData.frequency = frequencies[band];
+        energyCollectionRules.collectEnergy(collectorsPerBand[band], index,
+                                            &hitData);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * hits.size() * numOfBands);
+  state.SetLabel(allBandsAtOnce ? "all bands at once" : "band by band");
+}
+BENCHMARK_TEMPLATE(BM_CollectEnergyInBands,
+                   collectionRules::LinearEnergyCollectionWithPhaseImpact)
+    ->Args({20, 0})
+    ->Args({20, 1});
+BENCHMARK_TEMPLATE(BM_CollectEnergyInBands,
+                   collectionRules::NonLinearEnergyCollection)
+    ->Args({20, 0})
+    ->Args({20, 1});
+
+// |state.range(0)| is the duration of the wave in [ms].
+void BM_WaveObjectGetTotalPressure(benchmark::State &state) {
+  const int numOfSamples = kSampleRate * state.range(0) / 1000;
+  std::vector<float> samples(numOfSamples);
+  for (int sample = 0; sample < numOfSamples; ++sample) {
+    samples[sample] = 1.0f / (1 + sample);
+  }
+  WaveObject wave(kSampleRate, samples);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(wave.getTotalPressure());
+  }
+  state.SetItemsProcessed(state.iterations() * numOfSamples);
+}
+BENCHMARK(BM_WaveObjectGetTotalPressure)->Arg(100)->Arg(1000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,124 @@
+#include "benchmarks/validationModels.h"
+#include "main/model.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Measures loading of the validation diffusors from .obj files and from the
+// same meshes converted to binary .stl and .ply files. Reports loaded
+// triangles and bytes per second.
+
+using LoadFunction = std::function<std::unique_ptr<Model>(std::string_view)>;
+
+void BM_LoadModel(benchmark::State &state, std::string path,
+                  LoadFunction load) {
+  size_t numOfTriangles = 0;
+  for (auto _ : state) {
+    std::unique_ptr<Model> model = load(path);
+    numOfTriangles = model->triangles().size();
+    benchmark::DoNotOptimize(model);
+  }
+  state.SetItemsProcessed(state.iterations() * numOfTriangles);
+  state.SetBytesProcessed(state.iterations() *
+                          std::filesystem::file_size(path));
+}
+
+template <typename T> void write(T value, std::ofstream *file) {
+  file->write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Writes |point| in coordinates of the file, in which z axis represents y
+// axis of the simulation.
+void writePoint(const core::Vec3 &point, std::ofstream *file) {
+  write(point.x(), file);
+  write(point.z(), file);
+  write(point.y(), file);
+}
+
+void writeStl(const Model &model, const std::string &path) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << std::string(80, ' ');
+  write<uint32_t>(model.triangles().size(), &file);
+  for (const objects::TriangleObj &triangle : model.triangles()) {
+    writePoint(core::Vec3::kZero, &file);
+    for (const core::Vec3 &point : triangle.getPoints()) {
+      writePoint(point, &file);
+    }
+    write<uint16_t>(0, &file);
+  }
+}
+
+void writePly(const Model &model, const std::string &path) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  const size_t numOfTriangles = model.triangles().size();
+  file << "ply\n"
+       << "format binary_little_endian 1.0\n"
+       << "element vertex " << 3 * numOfTriangles << "\n"
+       << "property float x\n"
+       << "property float y\n"
+       << "property float z\n"
+       << "element face " << numOfTriangles << "\n"
+       << "property list uchar uint vertex_indices\n"
+       << "end_header\n";
+  for (const objects::TriangleObj &triangle : model.triangles()) {
+    for (const core::Vec3 &point : triangle.getPoints()) {
+      writePoint(point, &file);
+    }
+  }
+  for (uint32_t index = 0; index < numOfTriangles; ++index) {
+    write<uint8_t>(3, &file);
+    write<uint32_t>(3 * index, &file);
+    write<uint32_t>(3 * index + 1, &file);
+    write<uint32_t>(3 * index + 2, &file);
+  }
+}
+
+void registerBenchmark(std::string_view function, std::string_view path,
+                       LoadFunction load) {
+  std::string name(function);
+  name += "/";
+  name += modelName(path);
+  benchmark::RegisterBenchmark(name.c_str(), BM_LoadModel, std::string(path),
+                               load)
+      ->Unit(benchmark::kMillisecond);
+}
+
+int main(int argc, char *argv[]) {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path();
+  for (std::string_view path : kValidationModels) {
+    registerBenchmark("BM_NewLoadFromObjectFile", path,
+                      Model::NewLoadFromObjectFile);
+    // Parses .obj file every time, like loaders of other formats.
+    registerBenchmark("BM_ParseObjectFile", path,
+                      [](std::string_view objPath) {
+                        return std::make_unique<Model>(
+                            objLoader::loadTriangles(objPath));
+                      });
+
+    std::unique_ptr<Model> model = Model::NewLoadFromObjectFile(path);
+    const std::string stlPath =
+        (directory / (std::string(modelName(path)) + ".stl")).string();
+    writeStl(*model, stlPath);
+    registerBenchmark("BM_NewLoadFromStlFile", stlPath,
+                      Model::NewLoadFromStlFile);
+    const std::string plyPath =
+        (directory / (std::string(modelName(path)) + ".ply")).string();
+    writePly(*model, plyPath);
+    registerBenchmark("BM_NewLoadFromPlyFile", plyPath,
+                      Model::NewLoadFromPlyFile);
+  }
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
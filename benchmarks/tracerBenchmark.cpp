@@ -0,0 +1,248 @@
+#include "benchmarks/allocationCounter.h"
+#include "benchmarks/validationModels.h"
+#include "main/model.h"
+#include "main/policySimulator.h"
+#include "main/rayTracer.h"
+#include "main/simulator.h"
+#include "obj/generators.h"
+#include "obj/objects.h"
+
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Measures ray-triangle intersection, tracing rays through validation
+// diffusors and modeling of the reflected sound wave. Every benchmark reports
+// number of processed rays per second, reflection benchmarks also number of
+// memory allocations per reflected ray.
+
+const int kNumOfRaysSquared = 60;
+const int kMaxTracking = 4;
+const float kSkipPower = 500;
+const float kSkipFrequency = 1000;
+
+// Collects source rays and their specular reflections, so that measured rays
+// are the same as the ones traced in the simulation.
+std::vector<core::Ray> collectRays(Model *model, const RayTracer &tracer) {
+  std::vector<core::Ray> rays;
+  generators::PointSpeakerRayFactory source(kNumOfRaysSquared, kSkipPower,
+                                            model);
+  core::Ray ray;
+  while (source.genRay(&ray)) {
+    core::Ray current = ray;
+    for (int tracking = 0; tracking < kMaxTracking; ++tracking) {
+      rays.push_back(current);
+      core::RayHitData hitData;
+      if (tracer.rayTrace(current, kSkipFrequency, &hitData) !=
+          RayTracer::TraceResult::HIT_TRIANGLE) {
+        break;
+      }
+      current = tracer.getReflected(&hitData);
+    }
+  }
+  return rays;
+}
+
+void setRaysPerSecond(benchmark::State &state, size_t raysPerIteration) {
+  state.counters["rays"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * raysPerIteration),
+      benchmark::Counter::kIsRate);
+}
+
+// Rays cross the triangle plane on a grid twice as big as the triangle, so
+// about one of eight rays hits it.
+void BM_TriangleHitObject(benchmark::State &state) {
+  objects::TriangleObj triangle(core::Vec3(0, 0, 0), core::Vec3(1, 0, 0),
+                                core::Vec3(0, 1, 0));
+  const int kGridSize = 64;
+  std::vector<core::Ray> rays;
+  for (int x = 0; x < kGridSize; ++x) {
+    for (int y = 0; y < kGridSize; ++y) {
+      core::Vec3 target(-0.5 + 2.0f * x / kGridSize,
+                        -0.5 + 2.0f * y / kGridSize, 0);
+      core::Vec3 origin(0.25, 0.25, 1);
+      rays.emplace_back(origin, (target - origin).normalize());
+    }
+  }
+
+  for (auto _ : state) {
+    for (const core::Ray &ray : rays) {
+      core::RayHitData hitData;
+      benchmark::DoNotOptimize(
+          triangle.hitObject(ray, kSkipFrequency, &hitData));
+    }
+  }
+  setRaysPerSecond(state, rays.size());
+}
+BENCHMARK(BM_TriangleHitObject);
+
+void BM_RayTrace(benchmark::State &state, std::string_view path) {
+  std::unique_ptr<Model> model = Model::NewLoadFromObjectFile(path);
+  RayTracer tracer(model.get());
+  std::vector<core::Ray> rays = collectRays(model.get(), tracer);
+
+  for (auto _ : state) {
+    for (const core::Ray &ray : rays) {
+      core::RayHitData hitData;
+      benchmark::DoNotOptimize(tracer.rayTrace(ray, kSkipFrequency, &hitData));
+    }
+  }
+  setRaysPerSecond(state, rays.size());
+  state.counters["triangles"] = model->triangles().size();
+}
+
+std::vector<core::Ray> reflectedRays() {
+  std::vector<core::Ray> reflected;
+  for (int index = 0; index < 1024; ++index) {
+    const float angle = 2 * constants::kPi * index / 1024;
+    reflected.emplace_back(core::Vec3(0, 0, 1),
+                           core::Vec3(std::cos(angle), std::sin(angle), 1)
+                               .normalize());
+  }
+  return reflected;
+}
+
+std::vector<core::CounterRandomStream> randomStreams(size_t numOfStreams) {
+  std::vector<core::CounterRandomStream> streams;
+  for (size_t index = 0; index < numOfStreams; ++index) {
+    streams.emplace_back(/*seed=*/0, 0, 0, index);
+  }
+  return streams;
+}
+
+void setAllocationsPerRay(benchmark::State &state, size_t allocations,
+                          size_t raysPerIteration) {
+  state.counters["allocations"] =
+      static_cast<double>(allocations) /
+      std::max<double>(1, state.iterations() * raysPerIteration);
+}
+
+template <typename ReflectionEngine>
+void BM_FourSidedReflection(benchmark::State &state) {
+  ReflectionEngine reflectionEngine;
+  std::vector<core::Ray> reflected = reflectedRays();
+
+  const size_t allocationsBefore = numOfAllocations();
+  for (auto _ : state) {
+    for (const core::Ray &ray : reflected) {
+      benchmark::DoNotOptimize(
+          reflectionEngine.modelReflectedSoundWave(ray, kSkipFrequency));
+    }
+  }
+  setAllocationsPerRay(state, numOfAllocations() - allocationsBefore,
+                       reflected.size());
+  setRaysPerSecond(state, reflected.size());
+}
+BENCHMARK_TEMPLATE(BM_FourSidedReflection, SimpleFourSidedReflectionEngine);
+BENCHMARK_TEMPLATE(BM_FourSidedReflection,
+                   StochasticFourSidedReflectionEngine);
+
+// Version used by the Simulator, which reflects rays into reused buffer.
+template <typename ReflectionEngine>
+void BM_FourSidedReflectionIntoBuffer(benchmark::State &state) {
+  ReflectionEngine reflectionEngine;
+  std::vector<core::Ray> reflected = reflectedRays();
+  const std::vector<core::CounterRandomStream> streams =
+      randomStreams(reflected.size());
+  ReflectedRays output;
+
+  const size_t allocationsBefore = numOfAllocations();
+  for (auto _ : state) {
+    for (size_t index = 0; index < reflected.size(); ++index) {
+      core::CounterRandomStream randomStream = streams[index];
+      reflectionEngine.modelReflectedSoundWave(
+          reflected[index], kSkipFrequency, &randomStream, &output);
+      benchmark::DoNotOptimize(output);
+    }
+  }
+  setAllocationsPerRay(state, numOfAllocations() - allocationsBefore,
+                       reflected.size());
+  setRaysPerSecond(state, reflected.size());
+}
+BENCHMARK_TEMPLATE(BM_FourSidedReflectionIntoBuffer,
+                   SimpleFourSidedReflectionEngine);
+BENCHMARK_TEMPLATE(BM_FourSidedReflectionIntoBuffer,
+                   StochasticFourSidedReflectionEngine);
+
+template <typename ReflectionEngine>
+void BM_FourSidedReflectionBatch(benchmark::State &state) {
+  ReflectionEngine reflectionEngine;
+  std::vector<core::Ray> reflected = reflectedRays();
+  const std::vector<core::CounterRandomStream> initialStreams =
+      randomStreams(reflected.size());
+  std::vector<core::CounterRandomStream> streams = initialStreams;
+  std::vector<ReflectedRays> output(reflected.size());
+
+  const size_t allocationsBefore = numOfAllocations();
+  for (auto _ : state) {
+    std::copy(initialStreams.begin(), initialStreams.end(), streams.begin());
+    reflectionEngine.modelReflectedSoundWaves(reflected.data(),
+                                              reflected.size(), kSkipFrequency,
+                                              streams.data(), output.data());
+    benchmark::DoNotOptimize(output.data());
+  }
+  setAllocationsPerRay(state, numOfAllocations() - allocationsBefore,
+                       reflected.size());
+  setRaysPerSecond(state, reflected.size());
+}
+BENCHMARK_TEMPLATE(BM_FourSidedReflectionBatch,
+                   SimpleFourSidedReflectionEngine);
+BENCHMARK_TEMPLATE(BM_FourSidedReflectionBatch,
+                   StochasticFourSidedReflectionEngine);
+
+// Traces rays of the point speaker through the validation diffusor with
+// calls on the policies bound at compile time or virtual.
+template <typename Source, typename Tracker, typename Reflection>
+void BM_PolicySimulator(benchmark::State &state) {
+  std::unique_ptr<Model> model =
+      Model::NewLoadFromObjectFile(kValidationModels[0]);
+  RayTracer tracer(model.get());
+  const objects::SphereWall sphereWall(getSphereWallRadius(*model));
+  trackers::FakePositionTracker positionTracker;
+  collectionRules::NonLinearEnergyCollection energyCollectionRules;
+  StochasticFourSidedReflectionEngine reflectionEngine;
+  EscapeEvents escapeEvents;
+
+  for (auto _ : state) {
+    generators::PointSpeakerRayFactory source(kNumOfRaysSquared, kSkipPower,
+                                              model.get());
+    PolicySimulator<Source, Tracker, collectionRules::CollectEnergyInterface,
+                    Reflection>
+        simulator(&tracer, &sphereWall, &source, &positionTracker,
+                  &energyCollectionRules, &reflectionEngine, /*seed=*/0,
+                  /*energyCutoff=*/0, /*russianRoulette=*/false);
+    TracingStatistics statistics;
+    escapeEvents.clear();
+    simulator.traceSource({kSkipFrequency, kMaxTracking,
+                           /*collectors=*/nullptr, /*collectorIndex=*/nullptr,
+                           &escapeEvents, &positionTracker, &statistics});
+    benchmark::DoNotOptimize(escapeEvents.data());
+  }
+  setRaysPerSecond(state, kNumOfRaysSquared * kNumOfRaysSquared);
+}
+BENCHMARK_TEMPLATE(BM_PolicySimulator, generators::PointSpeakerRayFactory,
+                   trackers::FakePositionTracker,
+                   StochasticFourSidedReflectionEngine)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PolicySimulator, generators::RayFactory,
+                   trackers::PositionTrackerInterface,
+                   ReflectionEngineInterface)
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char *argv[]) {
+  for (std::string_view path : kValidationModels) {
+    std::string name = "BM_RayTrace/";
+    name += modelName(path);
+    benchmark::RegisterBenchmark(name.c_str(), BM_RayTrace, path)
+        ->Unit(benchmark::kMillisecond);
+  }
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef VALIDATION_MODELS_H
+#define VALIDATION_MODELS_H
+
+#include <string_view>
+
+// Models measured by the benchmarks. Paths are relative to the workspace root,
+// which is working directory of "bazel run".
+inline constexpr std::string_view kValidationModels[] = {
+    "./validationDiffusors/1D_1m_modulo23_500Hz_46n_30stopni_5potega.obj",
+    "./validationDiffusors/1D_2m_modulo13_250Hz_9n_15stopni_5potega.obj",
+    "./validationDiffusors/2D_1m_200Hz_modulo7_30stopni_6n.obj",
+    "./validationDiffusors/2D_2m_6n_modulo7_200Hz_15stopni_5potega.obj"};
+
+// Returns name of the model file without directories and extension.
+inline std::string_view modelName(std::string_view path) {
+  path = path.substr(path.find_last_of('/') + 1);
+  return path.substr(0, path.find_last_of('.'));
+}
+
+#endif
@@ -4,16 +4,36 @@ void Printable::printItself(std::ostream &os) const noexcept {
   os << "NOT IMPLEMENTED!";
 }
 
+uint64_t fnv1aHash(std::string_view text) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char character : text) {
+    hash ^= static_cast<unsigned char>(character);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
 void RandomEngine::printItself(std::ostream &os) const noexcept {
   os << "RANDOM ENGINE\n"
      << "\trendering random numbers from -1 to 1";
 }
 
-RandomEngine::RandomEngine() { std::srand((unsigned int)std::time(nullptr)); }
+namespace {
+std::mt19937 &threadGenerator() {
+  thread_local std::mt19937 generator(std::random_device{}());
+  return generator;
+}
+} // namespace
+
+RandomEngine::RandomEngine() {}
+
+void RandomEngine::seedCurrentThread(uint32_t seed) {
+  threadGenerator().seed(seed);
+}
 
 float RandomEngine::getRandomFloat() const {
-  return 2 * (static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX)) -
-         1;
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  return distribution(threadGenerator());
 }
 int RandomEngine::getRandomIntInRange(int min, int max) const {
   if (max < min) {
@@ -22,5 +42,6 @@ int RandomEngine::getRandomIntInRange(int min, int max) const {
        << "Max: " << max << " cannot be bigger then min: " << min << '\n';
     throw std::invalid_argument(ss.str());
   }
-  return static_cast<int>(std::rand() % (max - min + 1)) + min;
+  std::uniform_int_distribution<int> distribution(min, max);
+  return distribution(threadGenerator());
 }
\ No newline at end of file
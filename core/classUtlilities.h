@@ -2,12 +2,14 @@
 #define CLASS_UTILITIES_H
 
 #include <boost/core/noncopyable.hpp>
+#include <cstdint>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <limits>
 #include <random>
 #include <sstream>
+#include <string_view>
 
 
 class Printable {
@@ -21,10 +23,18 @@ inline std::ostream &operator<<(std::ostream &os, const Printable &printable) {
   return os;
 }
 
+// Returns 64 bit FNV-1a hash of the |text|.
+uint64_t fnv1aHash(std::string_view text);
+
+// Every thread draws numbers from its own generator, so RandomEngine can be
+// used concurrently. Generators are seeded randomly, unless
+// seedCurrentThread() is called.
 struct RandomEngine : public Printable, private boost::noncopyable {
   explicit RandomEngine();
   float getRandomFloat() const;
   int getRandomIntInRange(int min, int max) const;
+  // Makes sequence of numbers drawn by the calling thread reproducible.
+  static void seedCurrentThread(uint32_t seed);
   void printItself(std::ostream &os) const noexcept override;
 };
 
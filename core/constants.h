@@ -8,6 +8,9 @@ namespace constants {
 // calculation, or accuracy of time in seconds in hit time calculation
 const float kAccuracy = 0.00005;
 const float kAreaAccuracy = 0.0001;
+// Tolerance of barycentric coordinates in ray-triangle intersection, prevents
+// rays from slipping between two triangles sharing an edge.
+const float kBarycentricAccuracy = 0.00001;
 // Measured in 20'C at 1000 hPa
 const float kSoundSpeed = 343.216;
 const float kPi = std::acos(-1);
@@ -0,0 +1,77 @@
+#include "core/counterRandom.h"
+
+namespace core {
+
+namespace {
+constexpr uint32_t kPhiloxMultiplier0 = 0xD2511F53;
+constexpr uint32_t kPhiloxMultiplier1 = 0xCD9E8D57;
+constexpr uint32_t kPhiloxWeyl0 = 0x9E3779B9;
+constexpr uint32_t kPhiloxWeyl1 = 0xBB67AE85;
+constexpr int kPhiloxRounds = 10;
+
+inline void multiplyHighLow(uint32_t a, uint32_t b, uint32_t *high,
+                            uint32_t *low) {
+  const uint64_t product = static_cast<uint64_t>(a) * b;
+  *high = static_cast<uint32_t>(product >> 32);
+  *low = static_cast<uint32_t>(product);
+}
+} // namespace
+
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter,
+                                   std::array<uint32_t, 2> key) {
+  for (int round = 0; round < kPhiloxRounds; ++round) {
+    if (round > 0) {
+      key[0] += kPhiloxWeyl0;
+      key[1] += kPhiloxWeyl1;
+    }
+    uint32_t high0, low0, high1, low1;
+    multiplyHighLow(kPhiloxMultiplier0, counter[0], &high0, &low0);
+    multiplyHighLow(kPhiloxMultiplier1, counter[2], &high1, &low1);
+    counter = {high1 ^ counter[1] ^ key[0], low1, high0 ^ counter[3] ^ key[1],
+               low0};
+  }
+  return counter;
+}
+
+CounterRandomStream::CounterRandomStream(uint64_t seed, uint32_t stream0,
+                                         uint32_t stream1, uint64_t stream2)
+    : key_({static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}),
+      counter_({stream0, stream1, static_cast<uint32_t>(stream2),
+                static_cast<uint32_t>(stream2 >> 32)}),
+      block_({}), position_(4) {}
+
+uint32_t CounterRandomStream::nextUint() {
+  if (position_ == 4) {
+    block_ = philox4x32(counter_, key_);
+    ++counter_[3];
+    position_ = 0;
+  }
+  return block_[position_++];
+}
+
+float CounterRandomStream::nextFloat() {
+  // 24 most significant bits fit exactly into float mantissa.
+  return static_cast<float>(nextUint() >> 8) * (2.0f / (1 << 24)) - 1.0f;
+}
+
+uint64_t CounterRandomStream::childPathId(uint64_t pathId,
+                                          uint32_t childIndex) {
+  // Finalizer of the SplitMix64, so that ids of paths of different lengths
+  // do not collide in any regular way.
+  uint64_t hash = pathId * 0x9E3779B97F4A7C15ull + childIndex + 1;
+  hash ^= hash >> 30;
+  hash *= 0xBF58476D1CE4E5B9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94D049BB133111EBull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+void CounterRandomStream::printItself(std::ostream &os) const noexcept {
+  os << "COUNTER RANDOM STREAM\n"
+     << "\tKey: " << key_[0] << ", " << key_[1] << "\n"
+     << "\tCounter: " << counter_[0] << ", " << counter_[1] << ", "
+     << counter_[2] << ", " << counter_[3];
+}
+
+} // namespace core
@@ -0,0 +1,51 @@
+#ifndef COUNTER_RANDOM_H
+#define COUNTER_RANDOM_H
+
+#include "core/classUtlilities.h"
+
+#include <array>
+#include <cstdint>
+
+namespace core {
+
+// Philox4x32-10 block cipher from "Parallel Random Numbers: As Easy as 1, 2, 3"
+// by Salmon et al. Returns 4 random words for given |counter| and |key|.
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter,
+                                   std::array<uint32_t, 2> key);
+
+// Counter based random number generator. Numbers depend only on the |seed|
+// and the three stream words given in the constructor and the number of values
+// drawn before, so every stream can be recreated in any thread in any order.
+// Simulator uses frequency, index of the source ray and id of the reflection
+// path as stream words. 64 bit |stream2| fills the second half of the Philox
+// counter and every block of 4 drawn values increments its high word, so
+// streams overlap only when their |stream2| differ by a multiple of 2^32
+// smaller than the number of drawn blocks.
+class CounterRandomStream : public Printable {
+public:
+  CounterRandomStream(uint64_t seed, uint32_t stream0, uint32_t stream1,
+                      uint64_t stream2);
+
+  uint32_t nextUint();
+  // Returns random float in range [-1, 1), the same as
+  // RandomEngine::getRandomFloat().
+  float nextFloat();
+
+  // Returns id of the |childIndex|-th reflection of the path with given
+  // |pathId|. Path of the source ray has id 0. Ids are 64 bit hashes, so
+  // paths of the same source ray collide with negligible probability even
+  // when millions of them are traced.
+  static uint64_t childPathId(uint64_t pathId, uint32_t childIndex);
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  std::array<uint32_t, 2> key_;
+  std::array<uint32_t, 4> counter_;
+  std::array<uint32_t, 4> block_;
+  int position_;
+};
+
+} // namespace core
+
+#endif
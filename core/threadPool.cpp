@@ -0,0 +1,79 @@
+#include "core/threadPool.h"
+
+namespace core {
+
+ThreadPool::ThreadPool(int numOfThreads) : stopping_(false) {
+  if (numOfThreads < 1) {
+    std::stringstream ss;
+    ss << "Error in ThreadPool::ThreadPool()\n"
+       << "|numOfThreads| must be greater then 0, |numOfThreads|: "
+       << numOfThreads;
+    throw std::invalid_argument(ss.str());
+  }
+  workers_.reserve(numOfThreads);
+  for (int index = 0; index < numOfThreads; ++index) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+  std::packaged_task<void()> packagedTask(std::move(task));
+  std::future<void> result = packagedTask.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(std::move(packagedTask));
+  }
+  condition_.notify_one();
+  return result;
+}
+
+void ThreadPool::parallelFor(size_t numOfTasks,
+                             const std::function<void(size_t)> &task) {
+  std::vector<std::future<void>> results;
+  results.reserve(numOfTasks);
+  for (size_t index = 0; index < numOfTasks; ++index) {
+    results.push_back(submit([&task, index]() { task(index); }));
+  }
+  // Waits for every task before rethrowing, so that none of them outlives
+  // |task|.
+  for (std::future<void> &result : results) {
+    result.wait();
+  }
+  for (std::future<void> &result : results) {
+    result.get();
+  }
+}
+
+void ThreadPool::workerLoop() {
+  while (true) {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+    task();
+  }
+}
+
+void ThreadPool::printItself(std::ostream &os) const noexcept {
+  os << "THREAD POOL\n"
+     << "\tNumber of threads: " << workers_.size();
+}
+
+} // namespace core
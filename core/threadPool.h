@@ -0,0 +1,50 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "core/classUtlilities.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+// Fixed number of worker threads executing submitted tasks in FIFO order.
+// Workers are started in the constructor and joined in the destructor, after
+// all already submitted tasks are finished.
+class ThreadPool : public Printable, private boost::noncopyable {
+public:
+  // |numOfThreads| must be greater then 0.
+  explicit ThreadPool(int numOfThreads);
+  ~ThreadPool();
+
+  // Schedules |task| for execution. Exception thrown by the |task| is
+  // rethrown by get() of the returned future.
+  std::future<void> submit(std::function<void()> task);
+
+  // Calls |task| with every index from range [0, |numOfTasks|) and blocks
+  // until all of them are finished. Rethrows first exception thrown by any of
+  // the tasks.
+  void parallelFor(size_t numOfTasks, const std::function<void(size_t)> &task);
+
+  int numOfThreads() const { return static_cast<int>(workers_.size()); }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  void workerLoop();
+
+  std::vector<std::thread> workers_;
+  std::queue<std::packaged_task<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopping_;
+};
+
+} // namespace core
+
+#endif
@@ -0,0 +1,351 @@
+#include "main/boundingVolumeHierarchy.h"
+
+void AxisAlignedBox::grow(const core::Vec3 &point) {
+  const std::array<float, 3> coords = {point.x(), point.y(), point.z()};
+  for (int axis = 0; axis < 3; ++axis) {
+    min[axis] = std::min(min[axis], coords[axis]);
+    max[axis] = std::max(max[axis], coords[axis]);
+  }
+}
+
+void AxisAlignedBox::grow(const AxisAlignedBox &other) {
+  for (int axis = 0; axis < 3; ++axis) {
+    min[axis] = std::min(min[axis], other.min[axis]);
+    max[axis] = std::max(max[axis], other.max[axis]);
+  }
+}
+
+void AxisAlignedBox::pad(float margin) {
+  for (int axis = 0; axis < 3; ++axis) {
+    min[axis] -= margin;
+    max[axis] += margin;
+  }
+}
+
+float AxisAlignedBox::surfaceArea() const {
+  if (empty()) {
+    return 0;
+  }
+  float dx = max[0] - min[0];
+  float dy = max[1] - min[1];
+  float dz = max[2] - min[2];
+  return 2 * (dx * dy + dy * dz + dz * dx);
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(
+    const std::vector<objects::TriangleObj> *triangles)
+    : triangles_(triangles) {
+  if (triangles_ != nullptr && !triangles_->empty()) {
+    build();
+  }
+}
+
+void BoundingVolumeHierarchy::build() {
+  auto start = std::chrono::steady_clock::now();
+
+  const size_t numOfTriangles = triangles_->size();
+  std::vector<BuildItem> items;
+  items.reserve(numOfTriangles);
+  triangleIndices_.resize(numOfTriangles);
+
+  for (size_t index = 0; index < numOfTriangles; ++index) {
+    const objects::TriangleObj &triangle = (*triangles_)[index];
+    BuildItem item;
+    for (const core::Vec3 &point : triangle.getPoints()) {
+      item.box.grow(point);
+    }
+    // Triangle hit test accepts points that are slightly outside of the
+    // triangle, so box has to be enlarged to not cull them.
+    item.box.pad(triangle.hitMargin());
+    item.centroid = triangle.getOrigin();
+    items.push_back(item);
+    triangleIndices_[index] = static_cast<uint32_t>(index);
+  }
+
+  // Binary tree with leaves holding at least one triangle has at most
+  // 2 * N - 1 nodes.
+  nodes_.reserve(2 * numOfTriangles);
+  BvhNode root;
+  root.leftOrFirst = 0;
+  root.count = static_cast<uint32_t>(numOfTriangles);
+  nodes_.push_back(root);
+  updateNodeBounds(0, items);
+  subdivide(0, /*depth=*/1, items);
+  nodes_.shrink_to_fit();
+  buildPacks();
+
+  statistics_.numOfTriangles = numOfTriangles;
+  statistics_.numOfNodes = nodes_.size();
+  statistics_.buildTimeMs =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+}
+
+void BoundingVolumeHierarchy::updateNodeBounds(
+    uint32_t nodeIndex, const std::vector<BuildItem> &items) {
+  BvhNode &node = nodes_[nodeIndex];
+  node.box = AxisAlignedBox();
+  for (uint32_t index = 0; index < node.count; ++index) {
+    node.box.grow(items[triangleIndices_[node.leftOrFirst + index]].box);
+  }
+}
+
+float BoundingVolumeHierarchy::findBestSplit(
+    const BvhNode &node, const std::vector<BuildItem> &items, int *axis,
+    float *splitPosition) const {
+  float bestCost = std::numeric_limits<float>::max();
+
+  for (int currentAxis = 0; currentAxis < 3; ++currentAxis) {
+    float centroidMin = std::numeric_limits<float>::max();
+    float centroidMax = std::numeric_limits<float>::lowest();
+    for (uint32_t index = 0; index < node.count; ++index) {
+      const core::Vec3 &centroid =
+          items[triangleIndices_[node.leftOrFirst + index]].centroid;
+      const float coord = currentAxis == 0   ? centroid.x()
+                          : currentAxis == 1 ? centroid.y()
+                                             : centroid.z();
+      centroidMin = std::min(centroidMin, coord);
+      centroidMax = std::max(centroidMax, coord);
+    }
+    if (centroidMax - centroidMin <= constants::kAccuracy) {
+      continue;
+    }
+
+    std::array<AxisAlignedBox, kNumOfBins> bins;
+    std::array<uint32_t, kNumOfBins> binCounts = {};
+    const float scale = kNumOfBins / (centroidMax - centroidMin);
+    for (uint32_t index = 0; index < node.count; ++index) {
+      const BuildItem &item = items[triangleIndices_[node.leftOrFirst + index]];
+      const float coord = currentAxis == 0   ? item.centroid.x()
+                          : currentAxis == 1 ? item.centroid.y()
+                                             : item.centroid.z();
+      int bin = std::min(kNumOfBins - 1,
+                         static_cast<int>((coord - centroidMin) * scale));
+      bins[bin].grow(item.box);
+      ++binCounts[bin];
+    }
+
+    // Sweeps bins from both sides to get area and count of every split
+    // candidate in linear time.
+    std::array<float, kNumOfBins - 1> leftAreas, rightAreas;
+    std::array<uint32_t, kNumOfBins - 1> leftCounts, rightCounts;
+    AxisAlignedBox leftBox, rightBox;
+    uint32_t leftSum = 0, rightSum = 0;
+    for (int bin = 0; bin < kNumOfBins - 1; ++bin) {
+      leftSum += binCounts[bin];
+      leftCounts[bin] = leftSum;
+      leftBox.grow(bins[bin]);
+      leftAreas[bin] = leftBox.surfaceArea();
+
+      rightSum += binCounts[kNumOfBins - 1 - bin];
+      rightCounts[kNumOfBins - 2 - bin] = rightSum;
+      rightBox.grow(bins[kNumOfBins - 1 - bin]);
+      rightAreas[kNumOfBins - 2 - bin] = rightBox.surfaceArea();
+    }
+
+    for (int bin = 0; bin < kNumOfBins - 1; ++bin) {
+      if (leftCounts[bin] == 0 || rightCounts[bin] == 0) {
+        continue;
+      }
+      float cost = leftCounts[bin] * leftAreas[bin] +
+                   rightCounts[bin] * rightAreas[bin];
+      if (cost < bestCost) {
+        bestCost = cost;
+        *axis = currentAxis;
+        *splitPosition = centroidMin + (bin + 1) / scale;
+      }
+    }
+  }
+  return bestCost;
+}
+
+void BoundingVolumeHierarchy::subdivide(uint32_t nodeIndex, int depth,
+                                        const std::vector<BuildItem> &items) {
+  statistics_.maxDepth = std::max(statistics_.maxDepth, depth);
+  BvhNode node = nodes_[nodeIndex];
+  if (node.count <= kMaxLeafSize) {
+    ++statistics_.numOfLeaves;
+    return;
+  }
+
+  int axis = 0;
+  float splitPosition = 0;
+  // Below |kMaxSahDepth| only halving is performed, which guarantees that
+  // traversal stack never overflows.
+  float splitCost = depth < kMaxSahDepth
+                        ? findBestSplit(node, items, &axis, &splitPosition)
+                        : std::numeric_limits<float>::max();
+
+  uint32_t first = node.leftOrFirst;
+  uint32_t last = node.leftOrFirst + node.count;
+  uint32_t middle = first;
+  if (splitCost < std::numeric_limits<float>::max()) {
+    auto begin = triangleIndices_.begin();
+    middle = static_cast<uint32_t>(
+        std::partition(begin + first, begin + last,
+                       [&](uint32_t triangleIndex) -> bool {
+                         const core::Vec3 &centroid =
+                             items[triangleIndex].centroid;
+                         const float coord = axis == 0   ? centroid.x()
+                                             : axis == 1 ? centroid.y()
+                                                         : centroid.z();
+                         return coord < splitPosition;
+                       }) -
+        begin);
+  }
+  // Centroids are (almost) at the same position, so there is no reasonable
+  // split. Triangles are divided in half to keep leaves small.
+  if (middle == first || middle == last) {
+    middle = first + node.count / 2;
+  }
+
+  uint32_t leftIndex = static_cast<uint32_t>(nodes_.size());
+  BvhNode left, right;
+  left.leftOrFirst = first;
+  left.count = middle - first;
+  right.leftOrFirst = middle;
+  right.count = last - middle;
+  nodes_.push_back(left);
+  nodes_.push_back(right);
+
+  nodes_[nodeIndex].leftOrFirst = leftIndex;
+  nodes_[nodeIndex].count = 0;
+
+  updateNodeBounds(leftIndex, items);
+  updateNodeBounds(leftIndex + 1, items);
+  subdivide(leftIndex, depth + 1, items);
+  subdivide(leftIndex + 1, depth + 1, items);
+}
+
+void BoundingVolumeHierarchy::buildPacks() {
+  packs_.clear();
+  packs_.reserve(statistics_.numOfLeaves);
+  for (BvhNode &node : nodes_) {
+    if (!node.isLeaf()) {
+      continue;
+    }
+    objects::TrianglePack pack;
+    for (uint32_t index = 0; index < node.count; ++index) {
+      uint32_t triangleIndex = triangleIndices_[node.leftOrFirst + index];
+      pack.add((*triangles_)[triangleIndex], triangleIndex);
+    }
+    node.leftOrFirst = static_cast<uint32_t>(packs_.size());
+    packs_.push_back(pack);
+  }
+}
+
+float BoundingVolumeHierarchy::intersectBox(
+    const AxisAlignedBox &box, const std::array<float, 3> &origin,
+    const std::array<float, 3> &inverseDirection, float maxTime) {
+  float entry = 0;
+  float exit = maxTime;
+  for (int axis = 0; axis < 3; ++axis) {
+    float t0 = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+    float t1 = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+    entry = std::max(entry, std::min(t0, t1));
+    exit = std::min(exit, std::max(t0, t1));
+  }
+  return entry <= exit ? entry : std::numeric_limits<float>::max();
+}
+
+bool BoundingVolumeHierarchy::closestHit(const core::Ray &ray, float frequency,
+                                         core::RayHitData *hitData) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+
+  const core::Vec3 direction = ray.direction();
+  const std::array<float, 3> origin = {ray.origin().x(), ray.origin().y(),
+                                       ray.origin().z()};
+  const std::array<float, 3> directionCoords = {direction.x(), direction.y(),
+                                                direction.z()};
+  // Huge but finite value prevents 0 * inf = NaN when ray origin lies exactly
+  // on the box plane.
+  std::array<float, 3> inverseDirection;
+  for (int axis = 0; axis < 3; ++axis) {
+    inverseDirection[axis] =
+        std::abs(directionCoords[axis]) > 1e-20f
+            ? 1.0f / directionCoords[axis]
+            : std::copysign(1e30f, directionCoords[axis]);
+  }
+
+  float closestTime = std::numeric_limits<float>::max();
+  uint32_t closestTriangle = std::numeric_limits<uint32_t>::max();
+#ifndef AREA_SUM_TRIANGLE_INTERSECTION
+  const objects::PackedRay packedRay(ray);
+  const objects::TrianglePackKernel kernel = objects::getTrianglePackKernel();
+#endif
+
+  // Traversal pushes at most one node per level of the tree.
+  std::array<uint32_t, kMaxTraversalDepth> stack;
+  int stackSize = 0;
+  stack[stackSize++] = 0;
+
+  while (stackSize > 0) {
+    const BvhNode &node = nodes_[stack[--stackSize]];
+    if (intersectBox(node.box, origin, inverseDirection, closestTime) ==
+        std::numeric_limits<float>::max()) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      const objects::TrianglePack &pack = packs_[node.leftOrFirst];
+#ifdef AREA_SUM_TRIANGLE_INTERSECTION
+      // Packs hold data only for Moller-Trumbore algorithm, so triangles are
+      // checked one by one.
+      for (int lane = 0; lane < pack.size; ++lane) {
+        uint32_t triangleIndex = pack.triangleIndex[lane];
+        float time, u, v;
+        if ((*triangles_)[triangleIndex].intersect(ray, &time, &u, &v) &&
+            (time < closestTime ||
+             (time == closestTime && triangleIndex < closestTriangle))) {
+          closestTime = time;
+          closestTriangle = triangleIndex;
+        }
+      }
+#else
+      kernel(pack, packedRay, &closestTime, &closestTriangle);
+#endif
+      continue;
+    }
+
+    // Visits closer child first, so that farther one can be culled by the
+    // already found hit.
+    uint32_t nearChild = node.leftOrFirst;
+    uint32_t farChild = node.leftOrFirst + 1;
+    float nearTime = intersectBox(nodes_[nearChild].box, origin,
+                                  inverseDirection, closestTime);
+    float farTime = intersectBox(nodes_[farChild].box, origin,
+                                 inverseDirection, closestTime);
+    if (nearTime > farTime) {
+      std::swap(nearChild, farChild);
+      std::swap(nearTime, farTime);
+    }
+    if (farTime != std::numeric_limits<float>::max()) {
+      stack[stackSize++] = farChild;
+    }
+    if (nearTime != std::numeric_limits<float>::max()) {
+      stack[stackSize++] = nearChild;
+    }
+  }
+
+  if (closestTriangle == std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  *hitData = core::RayHitData(closestTime,
+                              (*triangles_)[closestTriangle].normal(), ray,
+                              frequency);
+  return true;
+}
+
+void BoundingVolumeHierarchy::printItself(std::ostream &os) const noexcept {
+  os << "BOUNDING VOLUME HIERARCHY\n"
+     << "\tTriangles: " << statistics_.numOfTriangles << "\n"
+     << "\tNodes: " << statistics_.numOfNodes << "\n"
+     << "\tLeaves: " << statistics_.numOfLeaves << "\n"
+     << "\tMax depth: " << statistics_.maxDepth << "\n"
+     << "\tTriangle kernel: "
+     << objects::simdLevelName(objects::detectSimdLevel()) << "\n"
+     << "\tBuild time: " << statistics_.buildTimeMs << " [ms]\n";
+}
@@ -0,0 +1,123 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include "core/classUtlilities.h"
+#include "core/constants.h"
+#include "core/ray.h"
+#include "core/vec3.h"
+#include "obj/objects.h"
+#include "obj/trianglePack.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Axis aligned bounding box stored as plain floats. It is intentionally not
+// Printable, so that BVH nodes stay small and do not carry vptrs.
+struct AxisAlignedBox {
+  std::array<float, 3> min = {std::numeric_limits<float>::max(),
+                              std::numeric_limits<float>::max(),
+                              std::numeric_limits<float>::max()};
+  std::array<float, 3> max = {std::numeric_limits<float>::lowest(),
+                              std::numeric_limits<float>::lowest(),
+                              std::numeric_limits<float>::lowest()};
+
+  void grow(const core::Vec3 &point);
+  void grow(const AxisAlignedBox &other);
+  // Enlarges box by |margin| in every direction.
+  void pad(float margin);
+  bool empty() const { return min[0] > max[0]; }
+  float surfaceArea() const;
+};
+
+// Single node of the flattened hierarchy. Interior nodes have |count| equal to
+// 0 and their children are stored at |leftOrFirst| and |leftOrFirst| + 1.
+// Leaves hold |count| triangles stored in the triangle pack at index
+// |leftOrFirst|.
+struct BvhNode {
+  AxisAlignedBox box;
+  uint32_t leftOrFirst;
+  uint32_t count;
+
+  bool isLeaf() const { return count > 0; }
+};
+
+// Bounding volume hierarchy over triangles of the model, build with binned
+// surface area heuristic (SAH). Hierarchy keeps pointer to the given
+// |triangles|, so they have to outlive it and cannot be modified.
+class BoundingVolumeHierarchy : public Printable {
+public:
+  struct Statistics {
+    double buildTimeMs = 0;
+    size_t numOfTriangles = 0;
+    size_t numOfNodes = 0;
+    size_t numOfLeaves = 0;
+    int maxDepth = 0;
+  };
+
+  // Maximum number of triangles held by a single leaf, every leaf fits into
+  // one triangle pack.
+  static constexpr uint32_t kMaxLeafSize = objects::TrianglePack::kWidth;
+  // Number of bins used by SAH along each axis.
+  static constexpr int kNumOfBins = 12;
+  // Depth up to which SAH splits are used. Deeper nodes are split in half, so
+  // tree depth never exceeds |kMaxSahDepth| + log2(number of triangles).
+  static constexpr int kMaxSahDepth = 64;
+  static constexpr int kMaxTraversalDepth = kMaxSahDepth + 34;
+
+  explicit BoundingVolumeHierarchy(
+      const std::vector<objects::TriangleObj> *triangles = nullptr);
+
+  // Finds closest triangle hit by the |ray|. Returns true if hit occurred,
+  // |hitData| is modified only in that case. If two triangles are hit at the
+  // same time, the one with lower index in the model wins, which gives exactly
+  // the same results as checking triangles one by one.
+  [[nodiscard]] bool closestHit(const core::Ray &ray, float frequency,
+                                core::RayHitData *hitData) const;
+
+  const Statistics &statistics() const { return statistics_; }
+  const std::vector<BvhNode> &nodes() const { return nodes_; }
+  const std::vector<uint32_t> &triangleIndices() const {
+    return triangleIndices_;
+  }
+  const std::vector<objects::TrianglePack> &packs() const { return packs_; }
+  bool empty() const { return nodes_.empty(); }
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  struct BuildItem {
+    AxisAlignedBox box;
+    core::Vec3 centroid;
+  };
+
+  void build();
+  void subdivide(uint32_t nodeIndex, int depth,
+                 const std::vector<BuildItem> &items);
+  // Returns cost of the best found split, |axis| and |splitPosition| are
+  // modified to describe it.
+  float findBestSplit(const BvhNode &node, const std::vector<BuildItem> &items,
+                      int *axis, float *splitPosition) const;
+  void updateNodeBounds(uint32_t nodeIndex,
+                        const std::vector<BuildItem> &items);
+  // Copies triangles of every leaf into its own pack and makes the leaf point
+  // to it.
+  void buildPacks();
+
+  // Returns entry time of the |ray| into |box| or max float when ray misses it.
+  static float intersectBox(const AxisAlignedBox &box,
+                            const std::array<float, 3> &origin,
+                            const std::array<float, 3> &inverseDirection,
+                            float maxTime);
+
+  const std::vector<objects::TriangleObj> *triangles_;
+  std::vector<BvhNode> nodes_;
+  std::vector<uint32_t> triangleIndices_;
+  std::vector<objects::TrianglePack> packs_;
+  Statistics statistics_;
+};
+
+#endif
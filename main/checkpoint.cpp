@@ -0,0 +1,351 @@
+#include "main/checkpoint.h"
+
+namespace checkpoints {
+
+namespace {
+
+constexpr char kMagic[8] = {'D', 'C', 'R', 'T', 'C', 'K', 'P', 'T'};
+constexpr uint32_t kVersion = 2;
+
+template <typename T> void writeValue(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T readValue(std::istream &is) {
+  T value;
+  if (!is.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+    throw std::invalid_argument("Checkpoint ends unexpectedly!");
+  }
+  return value;
+}
+
+void writeStatistics(const TracingStatistics &statistics, std::ostream &os) {
+  writeValue<int32_t>(os, statistics.depthLimit);
+  writeValue<int32_t>(os, statistics.maxReachedDepth);
+  writeValue<uint64_t>(os, statistics.maxPendingRays);
+  writeValue<double>(os, statistics.emittedEnergy);
+  writeValue<double>(os, statistics.discardedEnergy);
+  writeValue<uint64_t>(os, statistics.discardedRays);
+  writeValue<double>(os, statistics.energyAtDepthLimit);
+}
+
+TracingStatistics readStatistics(std::istream &is) {
+  TracingStatistics statistics;
+  statistics.depthLimit = readValue<int32_t>(is);
+  statistics.maxReachedDepth = readValue<int32_t>(is);
+  statistics.maxPendingRays = readValue<uint64_t>(is);
+  statistics.emittedEnergy = readValue<double>(is);
+  statistics.discardedEnergy = readValue<double>(is);
+  statistics.discardedRays = readValue<uint64_t>(is);
+  statistics.energyAtDepthLimit = readValue<double>(is);
+  return statistics;
+}
+
+void writeHistogram(const objects::EnergyHistogram &histogram,
+                    std::ostream &os) {
+  const std::vector<float> &samples = histogram.samples();
+  uint64_t numOfNonZero = 0;
+  for (float energy : samples) {
+    numOfNonZero += energy != 0;
+  }
+  writeValue<int32_t>(os, histogram.sampleRate());
+  writeValue<uint64_t>(os, samples.size());
+  writeValue<uint64_t>(os, numOfNonZero);
+  for (size_t index = 0; index < samples.size(); ++index) {
+    if (samples[index] != 0) {
+      writeValue<uint64_t>(os, index);
+      writeValue<float>(os, samples[index]);
+    }
+  }
+}
+
+objects::EnergyHistogram readHistogram(std::istream &is) {
+  const int32_t sampleRate = readValue<int32_t>(is);
+  const uint64_t length = readValue<uint64_t>(is);
+  const uint64_t numOfNonZero = readValue<uint64_t>(is);
+  if (numOfNonZero > length) {
+    throw std::invalid_argument(
+        "Checkpoint histogram has more non-zero samples than samples!");
+  }
+  std::vector<float> samples(length, 0);
+  for (uint64_t sample = 0; sample < numOfNonZero; ++sample) {
+    const uint64_t index = readValue<uint64_t>(is);
+    if (index >= length) {
+      std::stringstream ss;
+      ss << "Sample index: " << index
+         << " in checkpoint histogram is out of range of its length: "
+         << length;
+      throw std::invalid_argument(ss.str());
+    }
+    samples[index] = readValue<float>(is);
+  }
+  return objects::EnergyHistogram(sampleRate, std::move(samples));
+}
+
+} // namespace
+
+void Checkpoint::printItself(std::ostream &os) const noexcept {
+  os << "Checkpoint\n"
+     << "\tFingerprint: " << fingerprint << "\n";
+  for (const auto &band : bands) {
+    os << "\t" << band->frequency << " Hz: rays [" << band->firstRay << ", "
+       << band->nextRay << ") of [" << band->firstRay << ", " << band->lastRay
+       << ") traced, source has " << band->numOfRays << " rays\n";
+  }
+}
+
+void write(const Checkpoint &checkpoint, std::ostream &os) {
+  os.write(kMagic, sizeof(kMagic));
+  writeValue<uint32_t>(os, kVersion);
+  writeValue<uint64_t>(os, checkpoint.fingerprint);
+  writeValue<uint32_t>(os, checkpoint.collectors.size());
+  for (const CollectorGeometry &collector : checkpoint.collectors) {
+    writeValue<float>(os, collector.origin.x());
+    writeValue<float>(os, collector.origin.y());
+    writeValue<float>(os, collector.origin.z());
+    writeValue<float>(os, collector.radius);
+  }
+  writeValue<uint32_t>(os, checkpoint.bands.size());
+  for (const auto &band : checkpoint.bands) {
+    writeValue<float>(os, band->frequency);
+    writeValue<int32_t>(os, band->firstRay);
+    writeValue<int32_t>(os, band->nextRay);
+    writeValue<int32_t>(os, band->lastRay);
+    writeValue<int32_t>(os, band->numOfRays);
+    writeStatistics(band->statistics, os);
+    writeValue<uint32_t>(os, band->energies.size());
+    for (const objects::EnergyHistogram &energy : band->energies) {
+      writeHistogram(energy, os);
+    }
+  }
+}
+
+Checkpoint read(std::istream &is) {
+  char magic[sizeof(kMagic)];
+  if (!is.read(magic, sizeof(magic)) ||
+      !std::equal(std::begin(magic), std::end(magic), std::begin(kMagic))) {
+    throw std::invalid_argument("Given stream does not contain checkpoint!");
+  }
+  const uint32_t version = readValue<uint32_t>(is);
+  if (version != kVersion) {
+    std::stringstream ss;
+    ss << "Checkpoint version: " << version
+       << " is not supported! Supported version: " << kVersion;
+    throw std::invalid_argument(ss.str());
+  }
+
+  Checkpoint checkpoint;
+  checkpoint.fingerprint = readValue<uint64_t>(is);
+  const uint32_t numOfCollectors = readValue<uint32_t>(is);
+  for (uint32_t collector = 0; collector < numOfCollectors; ++collector) {
+    const float x = readValue<float>(is);
+    const float y = readValue<float>(is);
+    const float z = readValue<float>(is);
+    const float radius = readValue<float>(is);
+    checkpoint.collectors.push_back({core::Vec3(x, y, z), radius});
+  }
+  const uint32_t numOfBands = readValue<uint32_t>(is);
+  for (uint32_t bandIndex = 0; bandIndex < numOfBands; ++bandIndex) {
+    auto band = std::make_shared<BandProgress>();
+    band->frequency = readValue<float>(is);
+    band->firstRay = readValue<int32_t>(is);
+    band->nextRay = readValue<int32_t>(is);
+    band->lastRay = readValue<int32_t>(is);
+    band->numOfRays = readValue<int32_t>(is);
+    band->statistics = readStatistics(is);
+    const uint32_t numOfEnergies = readValue<uint32_t>(is);
+    for (uint32_t energy = 0; energy < numOfEnergies; ++energy) {
+      band->energies.push_back(readHistogram(is));
+    }
+    checkpoint.bands.push_back(std::move(band));
+  }
+  return checkpoint;
+}
+
+std::unordered_map<float, Collectors>
+toCollectors(const Checkpoint &checkpoint) {
+  std::unordered_map<float, Collectors> collectorsPerFrequency;
+  for (const auto &band : checkpoint.bands) {
+    if (band->energies.size() != checkpoint.collectors.size()) {
+      std::stringstream ss;
+      ss << "Band: " << band->frequency << " Hz of: \n"
+         << checkpoint << "has energy of " << band->energies.size()
+         << " collectors instead of " << checkpoint.collectors.size();
+      throw std::invalid_argument(ss.str());
+    }
+    Collectors collectors;
+    for (size_t index = 0; index < checkpoint.collectors.size(); ++index) {
+      const CollectorGeometry &geometry = checkpoint.collectors[index];
+      collectors.push_back(std::make_unique<objects::EnergyCollector>(
+          geometry.origin, geometry.radius));
+      collectors.back()->setEnergy(band->energies[index]);
+    }
+    collectorsPerFrequency.insert(
+        std::make_pair(band->frequency, std::move(collectors)));
+  }
+  return collectorsPerFrequency;
+}
+
+Checkpoint mergeShards(std::vector<Checkpoint> shards) {
+  if (shards.empty()) {
+    throw std::invalid_argument("There are no shards to merge!");
+  }
+  auto firstRayOf = [](const Checkpoint &shard) {
+    return shard.bands.empty() ? 0 : shard.bands.front()->firstRay;
+  };
+  std::sort(shards.begin(), shards.end(),
+            [&](const Checkpoint &first, const Checkpoint &second) {
+              return firstRayOf(first) < firstRayOf(second);
+            });
+
+  const Checkpoint &front = shards.front();
+  Checkpoint merged;
+  merged.fingerprint = front.fingerprint;
+  merged.collectors = front.collectors;
+  for (size_t bandIndex = 0; bandIndex < front.bands.size(); ++bandIndex) {
+    auto band = std::make_shared<BandProgress>();
+    band->frequency = front.bands[bandIndex]->frequency;
+    band->numOfRays = front.bands[bandIndex]->numOfRays;
+    for (const objects::EnergyHistogram &energy :
+         front.bands[bandIndex]->energies) {
+      band->energies.emplace_back(energy.sampleRate());
+    }
+    band->statistics.depthLimit = front.bands[bandIndex]->statistics.depthLimit;
+
+    for (const Checkpoint &shard : shards) {
+      std::stringstream error;
+      if (shard.fingerprint != merged.fingerprint ||
+          shard.collectors.size() != merged.collectors.size() ||
+          shard.bands.size() != front.bands.size()) {
+        error << "belongs to a different simulation";
+      } else {
+        const BandProgress &shardBand = *shard.bands[bandIndex];
+        if (shardBand.frequency != band->frequency ||
+            shardBand.numOfRays != band->numOfRays) {
+          error << "belongs to a different simulation";
+        } else if (!shardBand.completed()) {
+          error << "is not completed";
+        } else if (shardBand.firstRay != band->lastRay) {
+          error << "starts at ray: " << shardBand.firstRay
+                << " instead of ray: " << band->lastRay;
+        } else if (shardBand.energies.size() != band->energies.size()) {
+          error << "has energy of " << shardBand.energies.size()
+                << " collectors instead of " << band->energies.size();
+        } else {
+          band->lastRay = shardBand.lastRay;
+          band->statistics.merge(shardBand.statistics);
+          for (size_t index = 0; index < band->energies.size(); ++index) {
+            band->energies[index].addEnergy(shardBand.energies[index]);
+          }
+        }
+      }
+      if (!error.str().empty()) {
+        std::stringstream ss;
+        ss << "Cannot merge shards! Shard: \n"
+           << shard << "in band: " << band->frequency << " Hz "
+           << error.str();
+        throw std::invalid_argument(ss.str());
+      }
+    }
+
+    if (band->lastRay != band->numOfRays) {
+      std::stringstream ss;
+      ss << "Cannot merge shards! Shards of band: " << band->frequency
+         << " Hz traced only " << band->lastRay << " of " << band->numOfRays
+         << " rays";
+      throw std::invalid_argument(ss.str());
+    }
+    band->nextRay = band->lastRay;
+    merged.bands.push_back(std::move(band));
+  }
+  return merged;
+}
+
+std::optional<Checkpoint> load(std::string_view path) {
+  std::ifstream file(std::string(path), std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  return read(file);
+}
+
+AsyncCheckpointWriter::AsyncCheckpointWriter(std::string_view path)
+    : path_(path), thread_(&AsyncCheckpointWriter::writeLoop, this) {}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_all();
+  thread_.join();
+}
+
+void AsyncCheckpointWriter::save(Checkpoint checkpoint) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = std::move(checkpoint);
+  }
+  condition_.notify_all();
+}
+
+void AsyncCheckpointWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_.wait(lock, [this] { return !pending_ && !writing_; });
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+int AsyncCheckpointWriter::numOfWrites() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numOfWrites_;
+}
+
+void AsyncCheckpointWriter::writeLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    condition_.wait(lock, [this] { return stop_ || pending_; });
+    if (!pending_) {
+      return;
+    }
+    Checkpoint checkpoint = std::move(*pending_);
+    pending_.reset();
+    writing_ = true;
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      const std::string temporaryPath = path_ + ".tmp";
+      {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        write(checkpoint, file);
+        if (!file.flush()) {
+          throw std::invalid_argument("Cannot write checkpoint to: " +
+                                      temporaryPath);
+        }
+      }
+      if (std::rename(temporaryPath.c_str(), path_.c_str()) != 0) {
+        throw std::invalid_argument("Cannot move checkpoint to: " + path_);
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    writing_ = false;
+    if (error) {
+      error_ = error;
+    } else {
+      ++numOfWrites_;
+    }
+    condition_.notify_all();
+  }
+}
+
+void AsyncCheckpointWriter::printItself(std::ostream &os) const noexcept {
+  os << "Async Checkpoint Writer\n"
+     << "\tPath: " << path_ << "\n";
+}
+
+} // namespace checkpoints
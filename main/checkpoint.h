@@ -0,0 +1,122 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "core/classUtlilities.h"
+#include "core/vec3.h"
+#include "main/simulator.h"
+#include "obj/energyHistogram.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace checkpoints {
+
+// Progress of the simulation of single frequency over rays of the source with
+// indices in range [|firstRay|, |lastRay|) out of all |numOfRays| rays. Rays
+// from |firstRay| up to |nextRay| are already traced, their energy is
+// collected in |energies|, one histogram per collector, and described by
+// |statistics|. Range is smaller than the whole source only in shards.
+struct BandProgress {
+  float frequency = 0;
+  int firstRay = 0;
+  int nextRay = 0;
+  int lastRay = 0;
+  int numOfRays = 0;
+  TracingStatistics statistics;
+  std::vector<objects::EnergyHistogram> energies;
+
+  bool completed() const { return nextRay >= lastRay; }
+};
+
+struct CollectorGeometry {
+  core::Vec3 origin;
+  float radius;
+};
+
+// Everything needed to resume the simulation. Random numbers of the
+// simulation depend only on the seed and on indices of rays, so position of
+// every band in its source is the whole state of the random numbers.
+// |fingerprint| identifies the simulation, so that checkpoint of a different
+// simulation is never resumed. Bands are shared, so that saving new checkpoint
+// copies only bands that changed.
+struct Checkpoint : public Printable {
+  uint64_t fingerprint = 0;
+  // Positions of collectors, the same in every band.
+  std::vector<CollectorGeometry> collectors;
+  std::vector<std::shared_ptr<const BandProgress>> bands;
+
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+// Returns collectors of every band with energy collected in the |checkpoint|.
+std::unordered_map<float, Collectors>
+toCollectors(const Checkpoint &checkpoint);
+
+// Sums energy collected by |shards| of the same simulation, which together
+// traced every ray of the source exactly once. Shards are added in order of
+// their rays, so result does not depend on the order of |shards|. Throws
+// std::invalid_argument when shards are not complete, belong to different
+// simulations or their ranges of rays are not disjoint or leave a gap.
+Checkpoint mergeShards(std::vector<Checkpoint> shards);
+
+// Checkpoint is stored in the native byte order as: magic, version,
+// fingerprint, collectors and bands. Histograms are sparse: only indices and
+// energies of samples that received any energy are stored.
+void write(const Checkpoint &checkpoint, std::ostream &os);
+// Throws std::invalid_argument when |is| does not contain valid checkpoint.
+Checkpoint read(std::istream &is);
+// Returns checkpoint saved at |path| or nothing, when there is no such file.
+std::optional<Checkpoint> load(std::string_view path);
+
+// Writes checkpoints to the file at |path| in the background thread, so
+// tracing threads only wait for the copy of collected energy. When new
+// checkpoint is saved before the previous one is written, only the newest one
+// is written. Checkpoint is written to the temporary file first and then
+// renamed, so the file at |path| always contains complete checkpoint.
+class AsyncCheckpointWriter : public Printable, private boost::noncopyable {
+public:
+  explicit AsyncCheckpointWriter(std::string_view path);
+  // Waits until the last saved checkpoint is written.
+  ~AsyncCheckpointWriter();
+
+  void save(Checkpoint checkpoint);
+  // Blocks until every saved checkpoint is written. Rethrows exception of the
+  // last failed write.
+  void flush();
+  // Number of checkpoints actually written to the file.
+  int numOfWrites() const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  void writeLoop();
+
+  std::string path_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::optional<Checkpoint> pending_;
+  bool writing_ = false;
+  bool stop_ = false;
+  int numOfWrites_ = 0;
+  std::exception_ptr error_;
+  std::thread thread_;
+};
+
+} // namespace checkpoints
+
+#endif
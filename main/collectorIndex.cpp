@@ -0,0 +1,129 @@
+#include "main/collectorIndex.h"
+
+namespace collectionRules {
+
+namespace {
+// Margin protecting from rounding errors when checking, if collector is
+// visible from the bin [rad].
+constexpr float kAngularMargin = 1e-3;
+} // namespace
+
+CollectorIndex::CollectorIndex(const Collectors &collectors,
+                               const core::Vec3 &center)
+    : center_(center), bins_(kNumOfBins) {
+  struct Cap {
+    core::Vec3 direction;
+    float angularRadius;
+    bool containsCenter;
+  };
+  std::vector<Cap> caps;
+  caps.reserve(collectors.size());
+  for (uint32_t index = 0; index < collectors.size(); ++index) {
+    allCollectors_.push_back(index);
+    const core::Vec3 toCollector = collectors[index]->getOrigin() - center_;
+    const float distance = toCollector.magnitude();
+    const float radius = collectors[index]->getRadius();
+    if (distance <= radius + constants::kAccuracy) {
+      caps.push_back({core::Vec3::kZ, constants::kPi, true});
+    } else {
+      caps.push_back(
+          {toCollector / distance, std::asin(radius / distance), false});
+    }
+  }
+
+  const float binSize = 2.0f / kBinsPerFaceSide;
+  for (int face = 0; face < 6; ++face) {
+    for (int uIndex = 0; uIndex < kBinsPerFaceSide; ++uIndex) {
+      for (int vIndex = 0; vIndex < kBinsPerFaceSide; ++vIndex) {
+        const float uMin = -1 + uIndex * binSize;
+        const float vMin = -1 + vIndex * binSize;
+        const core::Vec3 binDirection =
+            faceDirection(face, uMin + binSize / 2, vMin + binSize / 2)
+                .normalize();
+        // Bin is bounded by great circles, so its farthest point from the
+        // center direction is one of the corners.
+        float binRadius = 0;
+        for (float u : {uMin, uMin + binSize}) {
+          for (float v : {vMin, vMin + binSize}) {
+            const float cosine = std::clamp(
+                binDirection.scalarProduct(faceDirection(face, u, v).normalize()),
+                -1.0f, 1.0f);
+            binRadius = std::max(binRadius, std::acos(cosine));
+          }
+        }
+
+        std::vector<uint32_t> &bin =
+            bins_[(face * kBinsPerFaceSide + uIndex) * kBinsPerFaceSide +
+                  vIndex];
+        for (uint32_t index = 0; index < caps.size(); ++index) {
+          const Cap &cap = caps[index];
+          const float maxAngle =
+              cap.angularRadius + binRadius + kAngularMargin;
+          if (cap.containsCenter || maxAngle >= constants::kPi ||
+              binDirection.scalarProduct(cap.direction) >= std::cos(maxAngle)) {
+            bin.push_back(index);
+          }
+        }
+      }
+    }
+  }
+}
+
+core::Vec3 CollectorIndex::faceDirection(int face, float u, float v) {
+  const int axis = face / 2;
+  const float sign = face % 2 == 0 ? 1 : -1;
+  std::array<float, 3> coords;
+  coords[axis] = sign;
+  coords[(axis + 1) % 3] = u;
+  coords[(axis + 2) % 3] = v;
+  return core::Vec3(coords[0], coords[1], coords[2]);
+}
+
+int CollectorIndex::binIndex(const core::Vec3 &direction) {
+  const std::array<float, 3> coords = {direction.x(), direction.y(),
+                                       direction.z()};
+  int axis = 0;
+  for (int current = 1; current < 3; ++current) {
+    if (std::abs(coords[current]) > std::abs(coords[axis])) {
+      axis = current;
+    }
+  }
+  const int face = 2 * axis + (coords[axis] < 0 ? 1 : 0);
+  const float inverse = 1 / std::abs(coords[axis]);
+  auto toBin = [](float coord) -> int {
+    return std::clamp(
+        static_cast<int>((coord + 1) * (kBinsPerFaceSide / 2.0f)), 0,
+        kBinsPerFaceSide - 1);
+  };
+  const int uIndex = toBin(coords[(axis + 1) % 3] * inverse);
+  const int vIndex = toBin(coords[(axis + 2) % 3] * inverse);
+  return (face * kBinsPerFaceSide + uIndex) * kBinsPerFaceSide + vIndex;
+}
+
+const std::vector<uint32_t> &
+CollectorIndex::candidates(const core::Vec3 &position) const {
+  const core::Vec3 direction = position - center_;
+  if (direction == core::Vec3::kZero) {
+    return allCollectors_;
+  }
+  return bins_[binIndex(direction)];
+}
+
+float CollectorIndex::averageNumOfCandidates() const {
+  size_t sum = 0;
+  for (const std::vector<uint32_t> &bin : bins_) {
+    sum += bin.size();
+  }
+  return static_cast<float>(sum) / bins_.size();
+}
+
+void CollectorIndex::printItself(std::ostream &os) const noexcept {
+  os << "COLLECTOR INDEX\n"
+     << "\tCenter: " << center_ << "\n"
+     << "\tNumber of collectors: " << allCollectors_.size() << "\n"
+     << "\tNumber of bins: " << bins_.size() << "\n"
+     << "\tAverage number of candidates: " << averageNumOfCandidates()
+     << "\n";
+}
+
+} // namespace collectionRules
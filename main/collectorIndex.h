@@ -0,0 +1,57 @@
+#ifndef COLLECTOR_INDEX_H
+#define COLLECTOR_INDEX_H
+
+#include "core/classUtlilities.h"
+#include "core/constants.h"
+#include "core/vec3.h"
+#include "obj/objects.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace collectionRules {
+
+using Collectors = std::vector<std::unique_ptr<objects::EnergyCollector>>;
+
+// Angular index of energy collectors placed around |center|. Directions from
+// |center| are divided into bins of a cube map: every face of the cube is split
+// into |kBinsPerFaceSide|^2 bins. Every bin keeps collectors, whose sphere may
+// contain a point seen from |center| in one of the directions of the bin.
+// Lookup requires only a few comparisons and one division, instead of checking
+// distance to every collector.
+class CollectorIndex : public Printable {
+public:
+  static constexpr int kBinsPerFaceSide = 16;
+  static constexpr int kNumOfBins = 6 * kBinsPerFaceSide * kBinsPerFaceSide;
+
+  explicit CollectorIndex(const Collectors &collectors,
+                          const core::Vec3 &center = core::Vec3::kZero);
+
+  // Returns ascending indices of the collectors that may contain |position|.
+  // Every collector that contains |position| is guaranteed to be returned.
+  const std::vector<uint32_t> &candidates(const core::Vec3 &position) const;
+
+  size_t numOfCollectors() const { return allCollectors_.size(); }
+  // Average number of candidates over all bins.
+  float averageNumOfCandidates() const;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  // Returns index of the bin containing given non-zero |direction|.
+  static int binIndex(const core::Vec3 &direction);
+  // Returns direction pointing to given |u|, |v| coordinates in range
+  // [-1, 1] at the given cube |face|.
+  static core::Vec3 faceDirection(int face, float u, float v);
+
+  core::Vec3 center_;
+  std::vector<std::vector<uint32_t>> bins_;
+  std::vector<uint32_t> allCollectors_;
+};
+
+} // namespace collectionRules
+
+#endif
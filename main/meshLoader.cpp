@@ -0,0 +1,406 @@
+#include "main/meshLoader.h"
+
+#include <algorithm>
+
+namespace meshLoader {
+
+namespace {
+
+[[noreturn]] void throwInvalidFile(std::string_view format,
+                                   std::string_view reason) {
+  std::stringstream ss;
+  ss << "Invalid " << format << " file: " << reason;
+  throw std::invalid_argument(ss.str());
+}
+
+bool isLittleEndianHost() {
+  const uint16_t one = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 1;
+}
+
+// Reads value of type T at |data|, which is stored in the byte order of the
+// host, unless |swapBytes| is true. Mapped memory is not aligned for T, so
+// value is copied.
+template <typename T> T readValue(const char *data, bool swapBytes) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, data, sizeof(T));
+  if (swapBytes) {
+    std::reverse(std::begin(bytes), std::end(bytes));
+  }
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+// Like std::stof(), parses number in the |token| of the |format| file.
+template <typename T> T parseNumber(std::string_view token,
+                                    std::string_view format) {
+  const char *first = token.data();
+  const char *last = first + token.size();
+  if (first != last && *first == '+') {
+    ++first;
+  }
+  T value;
+  if (token.empty() || std::from_chars(first, last, value).ec != std::errc()) {
+    std::stringstream ss;
+    ss << "\"" << token << "\" is not a number";
+    throwInvalidFile(format, ss.str());
+  }
+  return value;
+}
+
+// Adds triangle to |triangles| or prints warning, when it is invalid.
+void addTriangle(const core::Vec3 &point1, const core::Vec3 &point2,
+                 const core::Vec3 &point3,
+                 std::vector<objects::TriangleObj> *triangles) {
+  try {
+    triangles->emplace_back(point1, point2, point3);
+  } catch (const std::exception &e) {
+    std::cout << "WARNING! \n"
+              << e.what() << "\n"
+              << "It wont be included in simulation" << std::endl;
+  }
+}
+
+// Z coordinate of the file represents y coordinate in this simulation.
+core::Vec3 swapAxes(float x, float y, float z) { return core::Vec3(x, z, y); }
+
+// Binary .stl file: 80 bytes of header, number of triangles and triangles.
+constexpr size_t kStlHeaderSize = 80 + sizeof(uint32_t);
+// Normal, three points and attributes.
+constexpr size_t kStlTriangleSize = 12 * sizeof(float) + sizeof(uint16_t);
+
+core::Vec3 readStlPoint(const char *data, bool swapBytes) {
+  return swapAxes(readValue<float>(data, swapBytes),
+                  readValue<float>(data + sizeof(float), swapBytes),
+                  readValue<float>(data + 2 * sizeof(float), swapBytes));
+}
+
+std::vector<objects::TriangleObj> parseBinaryStl(std::string_view contents,
+                                                 uint32_t numOfTriangles) {
+  // Binary .stl files are always little endian.
+  const bool swapBytes = !isLittleEndianHost();
+  std::vector<objects::TriangleObj> triangles;
+  triangles.reserve(numOfTriangles);
+  const char *data = contents.data() + kStlHeaderSize;
+  for (uint32_t index = 0; index < numOfTriangles; ++index) {
+    // Normal of the file is skipped, so normals are the same as normals of
+    // triangles loaded from .obj files.
+    const char *points = data + 3 * sizeof(float);
+    addTriangle(readStlPoint(points, swapBytes),
+                readStlPoint(points + 3 * sizeof(float), swapBytes),
+                readStlPoint(points + 6 * sizeof(float), swapBytes),
+                &triangles);
+    data += kStlTriangleSize;
+  }
+  return triangles;
+}
+
+std::vector<objects::TriangleObj> parseAsciiStl(std::string_view contents) {
+  std::vector<objects::TriangleObj> triangles;
+  std::vector<core::Vec3> loop;
+  objLoader::Tokenizer tokenizer(contents);
+  for (std::string_view token = tokenizer.next(); !token.empty();
+       token = tokenizer.next()) {
+    if (token == "vertex") {
+      const float x = parseNumber<float>(tokenizer.next(), ".stl");
+      const float y = parseNumber<float>(tokenizer.next(), ".stl");
+      const float z = parseNumber<float>(tokenizer.next(), ".stl");
+      loop.push_back(swapAxes(x, y, z));
+    } else if (token == "endloop") {
+      if (loop.size() < 3) {
+        throwInvalidFile(".stl", "facet has less than 3 vertices");
+      }
+      for (size_t vertex = 1; vertex + 1 < loop.size(); ++vertex) {
+        addTriangle(loop[0], loop[vertex], loop[vertex + 1], &triangles);
+      }
+      loop.clear();
+    }
+  }
+  return triangles;
+}
+
+enum class PlyType {
+  kInt8,
+  kUint8,
+  kInt16,
+  kUint16,
+  kInt32,
+  kUint32,
+  kFloat32,
+  kFloat64
+};
+
+PlyType parsePlyType(std::string_view name) {
+  if (name == "char" || name == "int8") {
+    return PlyType::kInt8;
+  } else if (name == "uchar" || name == "uint8") {
+    return PlyType::kUint8;
+  } else if (name == "short" || name == "int16") {
+    return PlyType::kInt16;
+  } else if (name == "ushort" || name == "uint16") {
+    return PlyType::kUint16;
+  } else if (name == "int" || name == "int32") {
+    return PlyType::kInt32;
+  } else if (name == "uint" || name == "uint32") {
+    return PlyType::kUint32;
+  } else if (name == "float" || name == "float32") {
+    return PlyType::kFloat32;
+  } else if (name == "double" || name == "float64") {
+    return PlyType::kFloat64;
+  }
+  std::stringstream ss;
+  ss << "unknown type \"" << name << "\"";
+  throwInvalidFile(".ply", ss.str());
+}
+
+struct PlyProperty {
+  std::string_view name;
+  PlyType type;
+  // List properties start with the number of values of |type|.
+  bool isList = false;
+  PlyType countType;
+};
+
+struct PlyElement {
+  std::string_view name;
+  size_t count = 0;
+  std::vector<PlyProperty> properties;
+};
+
+enum class PlyFormat { kAscii, kBinaryLittleEndian, kBinaryBigEndian };
+
+struct PlyHeader {
+  PlyFormat format = PlyFormat::kAscii;
+  std::vector<PlyElement> elements;
+  // Contents after the header.
+  std::string_view body;
+};
+
+PlyHeader parsePlyHeader(std::string_view contents) {
+  PlyHeader header;
+  bool formatDeclared = false;
+  bool firstLine = true;
+  while (!contents.empty()) {
+    const size_t lineEnd = std::min(contents.find('\n'), contents.size());
+    objLoader::Tokenizer tokenizer(contents.substr(0, lineEnd));
+    contents.remove_prefix(std::min(lineEnd + 1, contents.size()));
+
+    const std::string_view keyword = tokenizer.next();
+    if (firstLine) {
+      if (keyword != "ply") {
+        throwInvalidFile(".ply", "file does not start with \"ply\"");
+      }
+      firstLine = false;
+    } else if (keyword == "format") {
+      const std::string_view format = tokenizer.next();
+      if (format == "ascii") {
+        header.format = PlyFormat::kAscii;
+      } else if (format == "binary_little_endian") {
+        header.format = PlyFormat::kBinaryLittleEndian;
+      } else if (format == "binary_big_endian") {
+        header.format = PlyFormat::kBinaryBigEndian;
+      } else {
+        throwInvalidFile(".ply", "unknown format");
+      }
+      formatDeclared = true;
+    } else if (keyword == "element") {
+      PlyElement element;
+      element.name = tokenizer.next();
+      element.count = parseNumber<size_t>(tokenizer.next(), ".ply");
+      header.elements.push_back(element);
+    } else if (keyword == "property") {
+      if (header.elements.empty()) {
+        throwInvalidFile(".ply", "property declared before element");
+      }
+      PlyProperty property;
+      std::string_view type = tokenizer.next();
+      if (type == "list") {
+        property.isList = true;
+        property.countType = parsePlyType(tokenizer.next());
+        type = tokenizer.next();
+      }
+      property.type = parsePlyType(type);
+      property.name = tokenizer.next();
+      header.elements.back().properties.push_back(property);
+    } else if (keyword == "end_header") {
+      if (!formatDeclared) {
+        throwInvalidFile(".ply", "format is not declared");
+      }
+      header.body = contents;
+      return header;
+    }
+  }
+  throwInvalidFile(".ply", "header does not end with \"end_header\"");
+}
+
+// Reads values of properties from binary body of the .ply file.
+class BinaryPlyReader {
+public:
+  BinaryPlyReader(std::string_view body, bool swapBytes)
+      : rest_(body), swapBytes_(swapBytes) {}
+
+  double read(PlyType type) {
+    switch (type) {
+    case PlyType::kInt8:
+      return read<int8_t>();
+    case PlyType::kUint8:
+      return read<uint8_t>();
+    case PlyType::kInt16:
+      return read<int16_t>();
+    case PlyType::kUint16:
+      return read<uint16_t>();
+    case PlyType::kInt32:
+      return read<int32_t>();
+    case PlyType::kUint32:
+      return read<uint32_t>();
+    case PlyType::kFloat32:
+      return read<float>();
+    case PlyType::kFloat64:
+      return read<double>();
+    }
+    return 0;
+  }
+
+private:
+  template <typename T> T read() {
+    if (rest_.size() < sizeof(T)) {
+      throwInvalidFile(".ply", "file ends unexpectedly");
+    }
+    const T value = readValue<T>(rest_.data(), swapBytes_);
+    rest_.remove_prefix(sizeof(T));
+    return value;
+  }
+
+  std::string_view rest_;
+  bool swapBytes_;
+};
+
+// Reads values of properties from ASCII body of the .ply file.
+class AsciiPlyReader {
+public:
+  explicit AsciiPlyReader(std::string_view body) : tokenizer_(body) {}
+
+  double read(PlyType type) {
+    const std::string_view token = tokenizer_.next();
+    if (token.empty()) {
+      throwInvalidFile(".ply", "file ends unexpectedly");
+    }
+    // Floats are parsed like in .obj files, so the same points are loaded.
+    if (type == PlyType::kFloat32) {
+      return parseNumber<float>(token, ".ply");
+    }
+    return parseNumber<double>(token, ".ply");
+  }
+
+private:
+  objLoader::Tokenizer tokenizer_;
+};
+
+// Splits polygon into triangles sharing its first point.
+void addFace(const std::vector<core::Vec3> &points,
+             const std::vector<double> &face,
+             std::vector<objects::TriangleObj> *triangles) {
+  for (double index : face) {
+    if (index < 0 || index >= points.size()) {
+      std::stringstream ss;
+      ss << "point: " << index << " of the face is not declared, file has "
+         << points.size() << " points";
+      throwInvalidFile(".ply", ss.str());
+    }
+  }
+  for (size_t vertex = 1; vertex + 1 < face.size(); ++vertex) {
+    addTriangle(points[face[0]], points[face[vertex]], points[face[vertex + 1]],
+                triangles);
+  }
+}
+
+template <typename Reader>
+std::vector<objects::TriangleObj> readPlyBody(const PlyHeader &header,
+                                              Reader reader) {
+  std::vector<core::Vec3> points;
+  std::vector<objects::TriangleObj> triangles;
+  std::vector<double> face;
+  for (const PlyElement &element : header.elements) {
+    const bool isVertex = element.name == "vertex";
+    const bool isFace = element.name == "face";
+    if (isVertex) {
+      points.reserve(element.count);
+    } else if (isFace) {
+      triangles.reserve(element.count);
+    }
+    for (size_t item = 0; item < element.count; ++item) {
+      float coordinates[3] = {0, 0, 0};
+      for (const PlyProperty &property : element.properties) {
+        if (property.isList) {
+          const double size = reader.read(property.countType);
+          face.clear();
+          for (double value = 0; value < size; ++value) {
+            face.push_back(reader.read(property.type));
+          }
+          if (isFace && (property.name == "vertex_indices" ||
+                         property.name == "vertex_index")) {
+            addFace(points, face, &triangles);
+          }
+          continue;
+        }
+        const double value = reader.read(property.type);
+        if (isVertex && property.name.size() == 1 &&
+            property.name[0] >= 'x' && property.name[0] <= 'z') {
+          coordinates[property.name[0] - 'x'] = value;
+        }
+      }
+      if (isVertex) {
+        points.push_back(
+            swapAxes(coordinates[0], coordinates[1], coordinates[2]));
+      }
+    }
+  }
+  return triangles;
+}
+
+} // namespace
+
+std::vector<objects::TriangleObj> parseStl(std::string_view contents) {
+  if (contents.size() >= kStlHeaderSize) {
+    const uint32_t numOfTriangles =
+        readValue<uint32_t>(contents.data() + 80, !isLittleEndianHost());
+    if (contents.size() ==
+        kStlHeaderSize + uint64_t(numOfTriangles) * kStlTriangleSize) {
+      return parseBinaryStl(contents, numOfTriangles);
+    }
+  }
+  if (contents.substr(0, 5) == "solid") {
+    return parseAsciiStl(contents);
+  }
+  throwInvalidFile(".stl", "size does not match the number of triangles");
+}
+
+std::vector<objects::TriangleObj> parsePly(std::string_view contents) {
+  const PlyHeader header = parsePlyHeader(contents);
+  switch (header.format) {
+  case PlyFormat::kAscii:
+    return readPlyBody(header, AsciiPlyReader(header.body));
+  case PlyFormat::kBinaryLittleEndian:
+    return readPlyBody(header,
+                       BinaryPlyReader(header.body, !isLittleEndianHost()));
+  case PlyFormat::kBinaryBigEndian:
+    return readPlyBody(header,
+                       BinaryPlyReader(header.body, isLittleEndianHost()));
+  }
+  return {};
+}
+
+std::vector<objects::TriangleObj> loadStlTriangles(std::string_view path) {
+  objLoader::MappedFile file(path);
+  return parseStl(file.contents());
+}
+
+std::vector<objects::TriangleObj> loadPlyTriangles(std::string_view path) {
+  objLoader::MappedFile file(path);
+  return parsePly(file.contents());
+}
+
+} // namespace meshLoader
@@ -0,0 +1,43 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include "main/objLoader.h"
+#include "obj/objects.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// Loaders of meshes exported by CAD software. Like objLoader, they swap y and
+// z axes of the file, split polygons into triangles sharing the first vertex
+// and skip invalid triangles with a warning. Binary files are read directly
+// from the mapped memory.
+namespace meshLoader {
+
+// Returns triangles of binary or ASCII .stl file |contents|. Binary file is
+// recognized by its size, which is given by the number of its triangles.
+// Throws std::invalid_argument when |contents| are not valid .stl file.
+std::vector<objects::TriangleObj> parseStl(std::string_view contents);
+
+// Returns triangles of faces of ASCII, binary little endian or binary big
+// endian .ply file |contents|. Points are given by "x", "y" and "z"
+// properties of the "vertex" element and faces by "vertex_indices" list of
+// the "face" element. Other elements and properties are skipped. Throws
+// std::invalid_argument when |contents| are not valid .ply file.
+std::vector<objects::TriangleObj> parsePly(std::string_view contents);
+
+// Maps the file at |path| and returns triangles of parseStl().
+std::vector<objects::TriangleObj> loadStlTriangles(std::string_view path);
+// Maps the file at |path| and returns triangles of parsePly().
+std::vector<objects::TriangleObj> loadPlyTriangles(std::string_view path);
+
+} // namespace meshLoader
+
+#endif
@@ -2,6 +2,8 @@
 #define MODEL_H
 
 #include "core/classUtlilities.h"
+#include "main/meshLoader.h"
+#include "main/modelCache.h"
 #include "obj/objects.h"
 
 #include <algorithm>
@@ -12,6 +14,7 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 // Holds all Triangle Objects that together represent model
@@ -32,15 +35,23 @@ private:
 
 class Model : public ModelInterface {
 public:
-  // Creates model object from given path to .obj file.
+  // Creates model object from given path to .obj file. Triangles are loaded
+  // from the cache next to the file, when it is up to date. See
+  // modelCache::loadTriangles().
   static std::unique_ptr<Model> NewLoadFromObjectFile(std::string_view path);
+  // Creates model object from given path to binary or ASCII .stl file. See
+  // meshLoader::parseStl().
+  static std::unique_ptr<Model> NewLoadFromStlFile(std::string_view path);
+  // Creates model object from given path to .ply file. See
+  // meshLoader::parsePly().
+  static std::unique_ptr<Model> NewLoadFromPlyFile(std::string_view path);
   // Creates Model object that represent perfectly flat square on XY surface at
   // Z = 0, positioned at the middle of the simulation.
   // This model is made out of two equal-arm / rectangular Triangle Objects,
   // where |sideSize| represents sides length at a right angle.
   static std::unique_ptr<Model> NewReferenceModel(float sideSize);
 
-  Model(const std::vector<objects::TriangleObj> &triangles);
+  Model(std::vector<objects::TriangleObj> triangles);
   const std::vector<objects::TriangleObj> &triangles() const override;
 
   bool empty() const override;
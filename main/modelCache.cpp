@@ -0,0 +1,151 @@
+#include "main/modelCache.h"
+
+#include <unistd.h>
+
+namespace modelCache {
+
+namespace {
+
+constexpr char kMagic[8] = {'D', 'C', 'R', 'T', 'M', 'O', 'D', 'L'};
+constexpr uint32_t kVersion = 1;
+// Points, normal, edges and origin followed by area and parallel threshold.
+constexpr uint32_t kFloatsPerTriangle = 3 * 3 + 4 * 3 + 2;
+constexpr size_t kHeaderSize = sizeof(kMagic) + 2 * sizeof(uint32_t) +
+                               2 * sizeof(uint64_t);
+
+template <typename T> void writeValue(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Reads value at the beginning of |contents| and removes it from |contents|.
+// Mapped memory is not aligned for T, so value is copied.
+template <typename T> T readValue(std::string_view *contents) {
+  T value;
+  std::memcpy(&value, contents->data(), sizeof(T));
+  contents->remove_prefix(sizeof(T));
+  return value;
+}
+
+float *writeVec3(const core::Vec3 &vec, float *data) {
+  data[0] = vec.x();
+  data[1] = vec.y();
+  data[2] = vec.z();
+  return data + 3;
+}
+
+core::Vec3 readVec3(const float *data) {
+  return core::Vec3(data[0], data[1], data[2]);
+}
+
+} // namespace
+
+std::string cachePath(std::string_view objPath) {
+  return std::string(objPath) + ".cache";
+}
+
+void write(const std::vector<objects::TriangleObj> &triangles,
+           uint64_t sourceHash, std::ostream &os) {
+  os.write(kMagic, sizeof(kMagic));
+  writeValue<uint32_t>(os, kVersion);
+  writeValue<uint32_t>(os, kFloatsPerTriangle);
+  writeValue<uint64_t>(os, sourceHash);
+  writeValue<uint64_t>(os, triangles.size());
+  float record[kFloatsPerTriangle];
+  for (const objects::TriangleObj &triangle : triangles) {
+    const objects::TriangleObj::Attributes attributes = triangle.attributes();
+    float *data = writeVec3(triangle.point1(), record);
+    data = writeVec3(triangle.point2(), data);
+    data = writeVec3(triangle.point3(), data);
+    data = writeVec3(attributes.normal, data);
+    data = writeVec3(attributes.edge1, data);
+    data = writeVec3(attributes.edge2, data);
+    data = writeVec3(attributes.origin, data);
+    data[0] = attributes.area;
+    data[1] = attributes.parallelThreshold;
+    os.write(reinterpret_cast<const char *>(record), sizeof(record));
+  }
+}
+
+std::optional<std::vector<objects::TriangleObj>>
+read(std::string_view contents, uint64_t sourceHash) {
+  if (contents.size() < kHeaderSize ||
+      contents.substr(0, sizeof(kMagic)) !=
+          std::string_view(kMagic, sizeof(kMagic))) {
+    return std::nullopt;
+  }
+  contents.remove_prefix(sizeof(kMagic));
+  const uint32_t version = readValue<uint32_t>(&contents);
+  const uint32_t floatsPerTriangle = readValue<uint32_t>(&contents);
+  const uint64_t hash = readValue<uint64_t>(&contents);
+  const uint64_t numOfTriangles = readValue<uint64_t>(&contents);
+  constexpr size_t kBytesPerTriangle = kFloatsPerTriangle * sizeof(float);
+  if (version != kVersion || floatsPerTriangle != kFloatsPerTriangle ||
+      hash != sourceHash ||
+      contents.size() / kBytesPerTriangle != numOfTriangles ||
+      contents.size() % kBytesPerTriangle != 0) {
+    return std::nullopt;
+  }
+
+  std::vector<objects::TriangleObj> triangles;
+  triangles.reserve(numOfTriangles);
+  float record[kFloatsPerTriangle];
+  for (uint64_t index = 0; index < numOfTriangles; ++index) {
+    std::memcpy(record, contents.data() + index * kBytesPerTriangle,
+                kBytesPerTriangle);
+    objects::TriangleObj::Attributes attributes = {
+        readVec3(record + 9),  readVec3(record + 12), readVec3(record + 15),
+        readVec3(record + 18), record[21],            record[22]};
+    triangles.emplace_back(readVec3(record), readVec3(record + 3),
+                           readVec3(record + 6), attributes);
+  }
+  return triangles;
+}
+
+bool save(const std::vector<objects::TriangleObj> &triangles,
+          uint64_t sourceHash, const std::string &path) {
+  std::stringstream temporaryPathStream;
+  temporaryPathStream << path << ".tmp." << getpid() << "."
+                      << std::this_thread::get_id();
+  const std::string temporaryPath = temporaryPathStream.str();
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return false;
+    }
+    write(triangles, sourceHash, file);
+    if (!file.flush()) {
+      std::remove(temporaryPath.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::vector<objects::TriangleObj> loadTriangles(std::string_view objPath) {
+  objLoader::MappedFile source(objPath);
+  const uint64_t sourceHash = fnv1aHash(source.contents());
+  const std::string path = cachePath(objPath);
+  if (std::ifstream(path).is_open()) {
+    objLoader::MappedFile cache(path);
+    std::optional<std::vector<objects::TriangleObj>> triangles =
+        read(cache.contents(), sourceHash);
+    if (triangles.has_value()) {
+      return std::move(*triangles);
+    }
+  }
+
+  std::vector<objects::TriangleObj> triangles =
+      objLoader::parseTrianglesInParallel(source.contents());
+  if (!save(triangles, sourceHash, path)) {
+    std::cout << "WARNING! \n"
+              << "Cannot save model cache: " << path << "\n"
+              << "Model will be parsed again in the next run" << std::endl;
+  }
+  return triangles;
+}
+
+} // namespace modelCache
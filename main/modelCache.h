@@ -0,0 +1,54 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include "core/classUtlilities.h"
+#include "main/objLoader.h"
+#include "obj/objects.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace modelCache {
+
+// Cache of the .obj file at |objPath|, stored next to it.
+std::string cachePath(std::string_view objPath);
+
+// Cache is stored in the native byte order as: magic, version, number of
+// floats per triangle, hash of the source .obj file, number of triangles and
+// triangles. Every triangle is stored as its points and attributes, so it is
+// created without any computation. Data added to the cache, e.g.
+// acceleration structures, requires new version.
+void write(const std::vector<objects::TriangleObj> &triangles,
+           uint64_t sourceHash, std::ostream &os);
+// Returns triangles of the cache |contents| or nothing, when |contents| is
+// not a complete cache of the current version created from the source with
+// |sourceHash|.
+std::optional<std::vector<objects::TriangleObj>>
+read(std::string_view contents, uint64_t sourceHash);
+// Writes cache to the temporary file first and renames it to |path|, so
+// |path| never contains incomplete cache. Name of the temporary file contains
+// the process and the thread, so processes loading the same model do not
+// write to the same file. Returns false, when cache cannot be written.
+bool save(const std::vector<objects::TriangleObj> &triangles,
+          uint64_t sourceHash, const std::string &path);
+
+// Returns triangles of the .obj file at |objPath| from its cache, when cache
+// was created from the same contents of the file. Otherwise parses the file
+// with objLoader::parseTrianglesInParallel() and saves new cache. Failure to
+// save the cache is not an error, so models in read only directories are
+// still loaded.
+std::vector<objects::TriangleObj> loadTriangles(std::string_view objPath);
+
+} // namespace modelCache
+
+#endif
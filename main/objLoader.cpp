@@ -0,0 +1,254 @@
+#include "main/objLoader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace objLoader {
+
+MappedFile::MappedFile(std::string_view path)
+    : path_(path), data_(nullptr), size_(0) {
+  const int descriptor = ::open(path_.c_str(), O_RDONLY);
+  struct stat status;
+  if (descriptor < 0 || ::fstat(descriptor, &status) != 0 ||
+      !S_ISREG(status.st_mode)) {
+    if (descriptor >= 0) {
+      ::close(descriptor);
+    }
+    std::stringstream ss;
+    ss << "Invalid path of the .obj \n"
+       << "Path: " << path_;
+    throw std::invalid_argument(ss.str());
+  }
+  size_ = status.st_size;
+  if (size_ > 0) {
+    void *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (data == MAP_FAILED) {
+      ::close(descriptor);
+      std::stringstream ss;
+      ss << "Cannot map into memory: " << *this;
+      throw std::invalid_argument(ss.str());
+    }
+    // File is read once from the beginning to the end.
+    ::madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(data);
+  }
+  // Mapping stays valid after the descriptor is closed.
+  ::close(descriptor);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+}
+
+void MappedFile::printItself(std::ostream &os) const noexcept {
+  os << "Mapped File: " << path_ << ", " << size_ << " bytes\n";
+}
+
+namespace {
+
+[[noreturn]] void throwInvalidLine(std::string_view declaration,
+                                   std::string_view line) {
+  std::stringstream ss;
+  ss << "Invalid " << declaration << " declaration in object file at:\n"
+     << "line: " << line;
+  throw std::invalid_argument(ss.str());
+}
+
+// Like std::stof(), parses number at the beginning of the |token|.
+float parseFloat(std::string_view token, std::string_view line) {
+  const char *first = token.data();
+  const char *last = first + token.size();
+  if (first != last && *first == '+') {
+    ++first;
+  }
+  float value;
+  if (std::from_chars(first, last, value).ec != std::errc()) {
+    throwInvalidLine("point", line);
+  }
+  return value;
+}
+
+// Returns zero based index of the point given by "v", "v/vt", "v//vn" or
+// "v/vt/vn" face vertex.
+uint32_t parsePointIndex(std::string_view token, std::string_view line) {
+  uint32_t index = 0;
+  const char *last = token.data() + token.size();
+  auto [end, error] = std::from_chars(token.data(), last, index);
+  if (error != std::errc() || index == 0 || (end != last && *end != '/')) {
+    throwInvalidLine("face", line);
+  }
+  return index - 1;
+}
+
+// Points and faces declared in the single chunk of the file.
+struct Chunk {
+  std::string_view contents;
+  std::vector<core::Vec3> points;
+  // Indices of points of every face, |faceSizes|[i] consecutive indices for
+  // the face i.
+  std::vector<uint32_t> faceIndices;
+  std::vector<uint32_t> faceSizes;
+  std::vector<objects::TriangleObj> triangles;
+  std::vector<std::string> warnings;
+};
+
+void parseChunk(Chunk *chunk) {
+  std::string_view rest = chunk->contents;
+  while (!rest.empty()) {
+    const size_t lineEnd = std::min(rest.find('\n'), rest.size());
+    const std::string_view line = rest.substr(0, lineEnd);
+    rest.remove_prefix(std::min(lineEnd + 1, rest.size()));
+
+    Tokenizer tokenizer(line);
+    const std::string_view keyword = tokenizer.next();
+    if (keyword == "v") {
+      // Z coordinate in .obj files represents y coordinate in this
+      // simulation.
+      const float x = parseFloat(tokenizer.next(), line);
+      const float z = parseFloat(tokenizer.next(), line);
+      const float y = parseFloat(tokenizer.next(), line);
+      chunk->points.emplace_back(x, y, z);
+    } else if (keyword == "f") {
+      uint32_t faceSize = 0;
+      for (std::string_view token = tokenizer.next(); !token.empty();
+           token = tokenizer.next()) {
+        chunk->faceIndices.push_back(parsePointIndex(token, line));
+        ++faceSize;
+      }
+      chunk->faceSizes.push_back(faceSize);
+    }
+  }
+}
+
+// Splits polygons of the |chunk| into triangles made of |points|.
+void buildTriangles(const std::vector<core::Vec3> &points, Chunk *chunk) {
+  // Triangles are expensive to copy, so vector is never reallocated.
+  size_t numOfTriangles = 0;
+  for (uint32_t faceSize : chunk->faceSizes) {
+    numOfTriangles += faceSize > 2 ? faceSize - 2 : 0;
+  }
+  chunk->triangles.reserve(numOfTriangles);
+  size_t firstIndex = 0;
+  for (uint32_t faceSize : chunk->faceSizes) {
+    const uint32_t *face = chunk->faceIndices.data() + firstIndex;
+    firstIndex += faceSize;
+    for (uint32_t vertex = 0; vertex < faceSize; ++vertex) {
+      if (face[vertex] >= points.size()) {
+        std::stringstream ss;
+        ss << "Invalid face declaration in object file:\n"
+           << "point: " << face[vertex] + 1 << " is not declared, file has "
+           << points.size() << " points";
+        throw std::invalid_argument(ss.str());
+      }
+    }
+    for (uint32_t triangle = 0; triangle + 2 < faceSize; ++triangle) {
+      try {
+        chunk->triangles.emplace_back(points[face[0]],
+                                      points[face[triangle + 1]],
+                                      points[face[triangle + 2]]);
+      } catch (const std::exception &e) {
+        chunk->warnings.push_back(e.what());
+      }
+    }
+  }
+}
+
+// Returns chunks of about |kBytesPerChunk| bytes, which end at line ends.
+std::vector<Chunk> splitIntoChunks(std::string_view contents) {
+  std::vector<Chunk> chunks;
+  while (!contents.empty()) {
+    size_t chunkEnd = contents.size();
+    if (contents.size() > kBytesPerChunk) {
+      // Without line end after |kBytesPerChunk| bytes, the rest is the last
+      // chunk.
+      const size_t lineEnd = contents.find('\n', kBytesPerChunk);
+      if (lineEnd != std::string_view::npos) {
+        chunkEnd = lineEnd + 1;
+      }
+    }
+    chunks.emplace_back();
+    chunks.back().contents = contents.substr(0, chunkEnd);
+    contents.remove_prefix(chunkEnd);
+  }
+  return chunks;
+}
+
+} // namespace
+
+std::vector<objects::TriangleObj> parseTriangles(std::string_view contents,
+                                                 core::ThreadPool *threadPool) {
+  std::vector<Chunk> chunks = splitIntoChunks(contents);
+  auto forEachChunk = [&](const std::function<void(Chunk *)> &task) {
+    if (threadPool == nullptr || chunks.size() < 2) {
+      for (Chunk &chunk : chunks) {
+        task(&chunk);
+      }
+    } else {
+      threadPool->parallelFor(chunks.size(),
+                              [&](size_t index) { task(&chunks[index]); });
+    }
+  };
+
+  forEachChunk(parseChunk);
+  // Faces may refer to points of any chunk.
+  std::vector<core::Vec3> points;
+  if (chunks.size() == 1) {
+    points = std::move(chunks[0].points);
+  } else {
+    size_t numOfPoints = 0;
+    for (const Chunk &chunk : chunks) {
+      numOfPoints += chunk.points.size();
+    }
+    points.reserve(numOfPoints);
+    for (Chunk &chunk : chunks) {
+      points.insert(points.end(), chunk.points.cbegin(), chunk.points.cend());
+      chunk.points = std::vector<core::Vec3>();
+    }
+  }
+  forEachChunk([&](Chunk *chunk) { buildTriangles(points, chunk); });
+
+  size_t numOfTriangles = 0;
+  for (const Chunk &chunk : chunks) {
+    for (const std::string &warning : chunk.warnings) {
+      std::cout << "WARNING! \n"
+                << warning << "\n"
+                << "It wont be included in simulation" << std::endl;
+    }
+    numOfTriangles += chunk.triangles.size();
+  }
+  if (chunks.size() == 1) {
+    return std::move(chunks[0].triangles);
+  }
+  std::vector<objects::TriangleObj> triangles;
+  triangles.reserve(numOfTriangles);
+  for (Chunk &chunk : chunks) {
+    // Copying would recompute attributes of every triangle.
+    for (const objects::TriangleObj &triangle : chunk.triangles) {
+      triangles.emplace_back(triangle.point1(), triangle.point2(),
+                             triangle.point3(), triangle.attributes());
+    }
+    chunk.triangles = std::vector<objects::TriangleObj>();
+  }
+  return triangles;
+}
+
+std::vector<objects::TriangleObj>
+parseTrianglesInParallel(std::string_view contents) {
+  if (contents.size() <= kBytesPerChunk) {
+    return parseTriangles(contents);
+  }
+  core::ThreadPool threadPool(
+      std::max(1u, std::thread::hardware_concurrency()));
+  return parseTriangles(contents, &threadPool);
+}
+
+std::vector<objects::TriangleObj> loadTriangles(std::string_view path) {
+  MappedFile file(path);
+  return parseTrianglesInParallel(file.contents());
+}
+
+} // namespace objLoader
@@ -0,0 +1,100 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include "core/classUtlilities.h"
+#include "core/threadPool.h"
+#include "core/vec3.h"
+#include "obj/objects.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace objLoader {
+
+// Contents of the file at |path| mapped read-only into memory, so they can be
+// parsed without copying. Throws std::invalid_argument when the file cannot
+// be opened.
+class MappedFile : public Printable, private boost::noncopyable {
+public:
+  explicit MappedFile(std::string_view path);
+  ~MappedFile();
+
+  std::string_view contents() const { return {data_, size_}; }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  std::string path_;
+  const char *data_;
+  size_t size_;
+};
+
+// Splits the text into tokens separated by whitespace without copying. New
+// lines separate tokens as well, so lines are usually split first.
+class Tokenizer {
+public:
+  explicit Tokenizer(std::string_view text) : rest_(text) {}
+
+  // Returns empty token when there are no more tokens.
+  std::string_view next() {
+    size_t begin = 0;
+    while (begin < rest_.size() && isSpace(rest_[begin])) {
+      ++begin;
+    }
+    size_t end = begin;
+    while (end < rest_.size() && !isSpace(rest_[end])) {
+      ++end;
+    }
+    std::string_view token = rest_.substr(begin, end - begin);
+    rest_.remove_prefix(end);
+    return token;
+  }
+  // Text after the last returned token.
+  std::string_view rest() const { return rest_; }
+
+private:
+  static bool isSpace(char character) {
+    return character == ' ' || character == '\t' || character == '\r' ||
+           character == '\n' || character == '\v' || character == '\f';
+  }
+
+  std::string_view rest_;
+};
+
+// Contents longer than this are split at line ends into chunks of about this
+// size, which are parsed independently.
+constexpr size_t kBytesPerChunk = 1 << 22;
+
+// Returns triangles of the faces declared in .obj file |contents|, in the
+// order of declaration. Only "v" and "f" lines are read: faces refer to
+// vertices by positive index, vertices given as "v/vt/vn" use only "v", and
+// polygons are split into triangles sharing the first vertex. Z axis of the
+// file is the y axis of the simulation. Invalid triangles are skipped with a
+// warning. With |threadPool| chunks are parsed by its threads. Throws
+// std::invalid_argument when vertex or face cannot be parsed.
+std::vector<objects::TriangleObj>
+parseTriangles(std::string_view contents,
+               core::ThreadPool *threadPool = nullptr);
+
+// Returns triangles of parseTriangles(). Contents with more than one chunk
+// are parsed by all hardware threads.
+std::vector<objects::TriangleObj>
+parseTrianglesInParallel(std::string_view contents);
+
+// Maps the .obj file at |path| and returns triangles of
+// parseTrianglesInParallel().
+std::vector<objects::TriangleObj> loadTriangles(std::string_view path);
+
+} // namespace objLoader
+
+#endif
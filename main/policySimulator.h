@@ -0,0 +1,263 @@
+#ifndef POLICY_SIMULATOR_H
+#define POLICY_SIMULATOR_H
+
+#include "core/constants.h"
+#include "core/counterRandom.h"
+#include "core/ray.h"
+#include "main/rayTracer.h"
+#include "main/simulator.h"
+#include "obj/objects.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Ray tracing loop of the Simulator, in which calls on the |Source|,
+// |Tracker|, |Rules| and |Reflection| are bound at compile time. Interfaces
+// are abstract, so every non-abstract policy is called directly and can be
+// inlined, e.g. calls on trackers::FakePositionTracker disappear entirely.
+// Objects must then be exactly of the policy type, not of its subclass. When
+// policy is an interface, its calls stay virtual. Simulator picks policies
+// from dynamic types of its objects, so it is only needed to trace rays
+// without Simulator.
+template <typename Source, typename Tracker, typename Rules,
+          typename Reflection>
+class PolicySimulator {
+public:
+  PolicySimulator(const RayTracer *tracer,
+                  const objects::SphereWall *sphereWall, Source *source,
+                  Tracker *tracker, Rules *rules, const Reflection *reflection,
+                  uint64_t seed, float energyCutoff, bool russianRoulette)
+      : tracer_(tracer), sphereWall_(sphereWall), source_(source),
+        tracker_(tracker), rules_(rules), reflection_(reflection), seed_(seed),
+        energyCutoff_(energyCutoff), russianRoulette_(russianRoulette){};
+
+  // Traces every ray left in the source one after another. Positions are
+  // passed to the |Tracker| policy instead of the tracker of |context|.
+  void traceSource(const TracingContext &context) const {
+    core::Ray currentRay;
+    uint32_t sourceRayIndex = 0;
+    while (genRay(&currentRay)) {
+      traceSourceRay(context, &currentRay, sourceRayIndex);
+      ++sourceRayIndex;
+    }
+  }
+
+  // Traces rays of the source with indices in range [|firstRay|, |lastRay|).
+  void traceRange(const TracingContext &context, int firstRay,
+                  int lastRay) const {
+    for (int rayIndex = firstRay; rayIndex < lastRay; ++rayIndex) {
+      core::Ray currentRay;
+      if (!rayAt(rayIndex, &currentRay)) {
+        continue;
+      }
+      traceSourceRay(context, &currentRay, rayIndex);
+    }
+  }
+
+  // Traces |currentRay| and all of its reflections in depth-first order with
+  // explicit stack of pending rays. |sourceRayIndex| is the index of the ray
+  // in the source, used to pick random streams for reflections.
+  void performRayTracing(const TracingContext &context, core::Ray *currentRay,
+                         uint32_t sourceRayIndex, int *currentTracking,
+                         float accumulatedTime) const {
+    const int maxTracking = context.maxTracking;
+    const float frequency = context.frequency;
+
+    context.statistics->emittedEnergy += currentRay->energy();
+    // Ends tracking when current ray tracking reaches maximum number.
+    if (*currentTracking >= maxTracking) {
+      context.statistics->energyAtDepthLimit += currentRay->energy();
+      return;
+    }
+    const float cutoffEnergy = energyCutoff_ * currentRay->energy();
+
+    // Rays waiting to be traced. Buffer is reused by every call in the same
+    // thread, so it allocates memory only when new high-water mark is reached.
+    thread_local std::vector<PendingRay> pendingRays;
+    pendingRays.clear();
+    pendingRays.push_back(
+        {*currentRay, *currentTracking, accumulatedTime, /*pathId=*/0});
+    ++*currentTracking;
+
+    uint32_t frequencyBits;
+    std::memcpy(&frequencyBits, &frequency, sizeof(frequency));
+
+    while (!pendingRays.empty()) {
+      const PendingRay pending = pendingRays.back();
+      pendingRays.pop_back();
+      if (pending.depth >= maxTracking) {
+        context.statistics->energyAtDepthLimit += pending.ray.energy();
+        continue;
+      }
+      const int depth = pending.depth + 1;
+      context.statistics->maxReachedDepth =
+          std::max(context.statistics->maxReachedDepth, depth);
+
+      core::RayHitData hitData;
+      hitData.accumulatedTime = pending.accumulatedTime;
+      RayTracer::TraceResult hitResult =
+          tracer_->rayTrace(pending.ray, frequency, &hitData);
+      if (hitResult == RayTracer::TraceResult::HIT_TRIANGLE) {
+        addNewPosition(hitData);
+        core::Ray reflected = tracer_->getReflected(&hitData);
+        core::CounterRandomStream randomStream(seed_, frequencyBits,
+                                               sourceRayIndex, pending.pathId);
+        ReflectedRays reflection;
+        reflect(reflected, frequency, &randomStream, &reflection);
+
+        // Children are pushed in reversed order, so that they are traced in the
+        // same order as by depth-first recursion.
+        for (size_t child = reflection.size(); child-- > 0;) {
+          core::Ray &childRay = reflection[child];
+          if (childRay.energy() < cutoffEnergy) {
+            // Russian roulette draws from the stream of the reflection, after
+            // all numbers used by the reflection engine.
+            const float survival = (randomStream.nextFloat() + 1) / 2;
+            if (!russianRoulette_ ||
+                survival * cutoffEnergy >= childRay.energy()) {
+              context.statistics->discardedEnergy += childRay.energy();
+              ++context.statistics->discardedRays;
+              continue;
+            }
+            childRay.setEnergy(cutoffEnergy);
+          }
+          pendingRays.push_back(
+              {childRay, depth, hitData.accumulatedTime,
+               core::CounterRandomStream::childPathId(pending.pathId, child)});
+        }
+        context.statistics->maxPendingRays =
+            std::max(context.statistics->maxPendingRays, pendingRays.size());
+
+      } else if (hitResult ==
+                     RayTracer::TraceResult::WENT_OUTSIDE_OF_SIMULATION_SPACE &&
+                 sphereWall_->hitObject(pending.ray, frequency, &hitData)) {
+
+        addNewPosition(hitData);
+        hitData.accumulatedTime += hitData.time / constants::kSoundSpeed;
+        if (context.escapeEvents != nullptr) {
+          context.escapeEvents->push_back(
+              {hitData.collisionPoint(), hitData.direction(),
+               hitData.accumulatedTime, hitData.energy()});
+        } else {
+          collectEnergy(*context.collectors, context.collectorIndex,
+                        &hitData);
+        }
+      }
+    }
+  }
+
+private:
+  template <typename Policy>
+  static constexpr bool isBound() {
+    return !std::is_abstract_v<Policy>;
+  }
+
+  void traceSourceRay(const TracingContext &context, core::Ray *currentRay,
+                      uint32_t sourceRayIndex) const {
+    initializeNewTracking();
+    int currentTracking = 0;
+    performRayTracing(context, currentRay, sourceRayIndex, &currentTracking,
+                      /*accumulatedTime=*/0);
+    endCurrentTracking();
+  }
+
+  bool genRay(core::Ray *ray) const {
+    if constexpr (isBound<Source>()) {
+      return source_->Source::genRay(ray);
+    } else {
+      return source_->genRay(ray);
+    }
+  }
+
+  bool rayAt(int index, core::Ray *ray) const {
+    if constexpr (isBound<Source>()) {
+      return source_->Source::rayAt(index, ray);
+    } else {
+      return source_->rayAt(index, ray);
+    }
+  }
+
+  void initializeNewTracking() const {
+    if constexpr (isBound<Tracker>()) {
+      tracker_->Tracker::initializeNewTracking();
+    } else {
+      tracker_->initializeNewTracking();
+    }
+  }
+
+  void addNewPosition(const core::RayHitData &hitData) const {
+    if constexpr (isBound<Tracker>()) {
+      tracker_->Tracker::addNewPositionToCurrentTracking(hitData);
+    } else {
+      tracker_->addNewPositionToCurrentTracking(hitData);
+    }
+  }
+
+  void endCurrentTracking() const {
+    if constexpr (isBound<Tracker>()) {
+      tracker_->Tracker::endCurrentTracking();
+    } else {
+      tracker_->endCurrentTracking();
+    }
+  }
+
+  // Bound rules are final, so energy is collected the same way as in
+  // CollectEnergyInterface::collectEnergy(), but with hooks of |Rules|.
+  void collectEnergy(const Collectors &collectors,
+                     const collectionRules::CollectorIndex *collectorIndex,
+                     core::RayHitData *hitData) const {
+    if constexpr (isBound<Rules>()) {
+      const Collectors *collectorsPerBand[] = {&collectors};
+      const core::Vec3 reachedPosition = hitData->collisionPoint();
+      collectionRules::collectEnergyWithHooks(
+          collectorsPerBand, &hitData->frequency, /*numOfBands=*/1,
+          collectorIndex != nullptr
+              ? &collectorIndex->candidates(reachedPosition)
+              : nullptr,
+          reachedPosition, *hitData,
+          [this](const core::RayHitData &hitData, const float *frequencies,
+                 int numOfBands, float *rayEnergies) {
+            rules_->Rules::rayEnergiesInBands(hitData, frequencies,
+                                              numOfBands, rayEnergies);
+          },
+          [this](const objects::EnergyCollector &collector,
+                 float distanceToOrigin, const float *rayEnergies,
+                 int numOfBands, float *collected) {
+            rules_->Rules::collectedEnergyInBands(collector, distanceToOrigin,
+                                                  rayEnergies, numOfBands,
+                                                  collected);
+          });
+    } else if (collectorIndex == nullptr) {
+      rules_->collectEnergy(collectors, hitData);
+    } else {
+      rules_->collectEnergy(collectors, *collectorIndex, hitData);
+    }
+  }
+
+  void reflect(const core::Ray &reflected, float frequency,
+               core::CounterRandomStream *randomStream,
+               ReflectedRays *output) const {
+    if constexpr (isBound<Reflection>()) {
+      reflection_->Reflection::modelReflectedSoundWave(reflected, frequency,
+                                                       randomStream, output);
+    } else {
+      reflection_->modelReflectedSoundWave(reflected, frequency, randomStream,
+                                           output);
+    }
+  }
+
+  const RayTracer *tracer_;
+  const objects::SphereWall *sphereWall_;
+  Source *source_;
+  Tracker *tracker_;
+  Rules *rules_;
+  const Reflection *reflection_;
+  uint64_t seed_;
+  float energyCutoff_;
+  bool russianRoulette_;
+};
+
+#endif
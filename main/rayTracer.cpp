@@ -1,16 +1,31 @@
 #include "main/rayTracer.h"
 
 void RayTracer::printItself(std::ostream &os) const noexcept {
-  os << "Ray Tracer class with model: \n\t" << *(model_);
+  os << "Ray Tracer class with model: \n\t" << *(model_) << "\t"
+     << hierarchy_;
 }
 
 RayTracer::TraceResult RayTracer::rayTrace(const core::Ray &ray,
                                            float frequency,
-                                           core::RayHitData *hitData) {
+                                           core::RayHitData *hitData) const {
+  float accumulatedTime = hitData->accumulatedTime;
+  core::RayHitData closestHitData;
+  if (hierarchy_.closestHit(ray, frequency, &closestHitData)) {
+    closestHitData.accumulatedTime =
+        accumulatedTime + closestHitData.time / constants::kSoundSpeed;
+    *hitData = closestHitData;
+    return TraceResult::HIT_TRIANGLE;
+  }
+  return TraceResult::WENT_OUTSIDE_OF_SIMULATION_SPACE;
+}
+
+RayTracer::TraceResult
+RayTracer::rayTraceWithoutAcceleration(const core::Ray &ray, float frequency,
+                                       core::RayHitData *hitData) const {
   bool hit = false;
   float accumulatedTime = hitData->accumulatedTime;
   core::RayHitData closestHitData;
-  for (objects::TriangleObj triangle : model_->triangles()) {
+  for (const objects::TriangleObj &triangle : model_->triangles()) {
     if (triangle.hitObject(ray, frequency, hitData)) {
       hit = true;
       if (closestHitData.time > hitData->time) {
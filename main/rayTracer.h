@@ -4,23 +4,35 @@
 #include "core/classUtlilities.h"
 #include "core/ray.h"
 #include "core/vec3.h"
+#include "main/boundingVolumeHierarchy.h"
 #include "main/model.h"
 #include "obj/objects.h"
 
 class RayTracer : public Printable {
 public:
-  RayTracer(ModelInterface *model) : model_(model){};
+  // Builds bounding volume hierarchy over triangles of the |model|, so model
+  // cannot be modified during lifetime of the RayTracer.
+  RayTracer(ModelInterface *model)
+      : model_(model), hierarchy_(&model->triangles()){};
 
   enum class TraceResult { HIT_TRIANGLE, WENT_OUTSIDE_OF_SIMULATION_SPACE };
   // |hitData| is modified to hold information where ray hit the triangle,
   // or where it went outside the simulation
   [[nodiscard]] TraceResult rayTrace(const core::Ray &ray, float frequency,
-                                     core::RayHitData *hitData);
+                                     core::RayHitData *hitData) const;
+  // Works exactly the same as rayTrace() but checks every triangle of the
+  // model one by one. Used as a reference for the bounding volume hierarchy.
+  [[nodiscard]] TraceResult
+  rayTraceWithoutAcceleration(const core::Ray &ray, float frequency,
+                              core::RayHitData *hitData) const;
   core::Ray getReflected(core::RayHitData *hitdata) const;
   void printItself(std::ostream &os) const noexcept override;
 
+  const BoundingVolumeHierarchy &hierarchy() const { return hierarchy_; }
+
 private:
   ModelInterface *model_;
+  BoundingVolumeHierarchy hierarchy_;
 };
 
 #endif
\ No newline at end of file
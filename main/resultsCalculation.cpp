@@ -77,12 +77,17 @@ std::vector<WaveObject> WaveObjectFactory::createWaveObjectsFromCollectors(
   output.reserve(collectors.size());
 
   for (auto &collector : collectors) {
-    WaveObject wave(sampleRate_);
-    for (auto energyPerTimeIt = collector->getEnergy().cbegin();
-         energyPerTimeIt != collector->getEnergy().cend(); ++energyPerTimeIt) {
-      wave.addEnergyAtTime(energyPerTimeIt->first, energyPerTimeIt->second);
+    const objects::EnergyHistogram &energy = collector->getEnergy();
+    // Samples of the histogram are already the samples of the wave.
+    if (energy.sampleRate() == sampleRate_) {
+      output.emplace_back(sampleRate_, energy.samples());
+      continue;
     }
 
+    WaveObject wave(sampleRate_);
+    for (size_t sample = 0; sample < energy.length(); ++sample) {
+      wave.addEnergyAtTime(energy.timeAt(sample), energy.samples()[sample]);
+    }
     output.push_back(wave);
   }
   return output;
@@ -147,6 +152,38 @@ void DiffusionCoefficient::printItself(std::ostream &os) const noexcept {
   os << getName();
 }
 
+void BatchMeans::addBatch(float result) {
+  ++numOfBatches_;
+  const double difference = result - mean_;
+  mean_ += difference / numOfBatches_;
+  squaredDifferences_ += difference * (result - mean_);
+}
+
+float BatchMeans::mean() const { return mean_; }
+
+float BatchMeans::confidenceHalfWidth() const {
+  if (numOfBatches_ < 2) {
+    return std::numeric_limits<float>::infinity();
+  }
+  // Two-sided 95% (one-sided 97.5%) quantiles of Student's t distribution
+  // with 1 to 30 degrees of freedom. Above that 1.96 + 2.4 / degrees fits the
+  // quantiles up to the third decimal place.
+  static constexpr float kQuantiles[] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  const int degrees = numOfBatches_ - 1;
+  const float quantile = degrees <= 30 ? kQuantiles[degrees - 1]
+                                       : 1.96 + 2.4 / degrees;
+  const double variance = squaredDifferences_ / degrees;
+  return quantile * std::sqrt(variance / numOfBatches_);
+}
+
+void BatchMeans::printItself(std::ostream &os) const noexcept {
+  os << "Batch means of " << numOfBatches_ << " batches: " << mean() << " +- "
+     << confidenceHalfWidth();
+}
+
 std::string_view NormalizedDiffusionCoefficient::getName() const noexcept {
   return "Normalized Acoustic Diffusion Coefficient";
 }
@@ -5,6 +5,7 @@
 #include "obj/objects.h"
 
 #include <cmath>
+#include <limits>
 #include <map>
 #include <numeric>
 #include <sstream>
@@ -22,6 +23,8 @@ float convertPressureToDecibels(float pressure);
 class WaveObject : public Printable {
 public:
   explicit WaveObject(int sampleRate) : sampleRate_(sampleRate){};
+  explicit WaveObject(int sampleRate, const std::vector<float> &data)
+      : sampleRate_(sampleRate), data_(data){};
   const std::vector<float> &getData() const;
   // return pressure defined in [Pa]
   float getTotalPressure() const;
@@ -91,6 +94,10 @@ public:
       : ResultInterface(waveFactory){};
 
   std::string_view getName() const noexcept override;
+  // Calculates diffusion coefficient of |collectors| of a single frequency.
+  float getResult(const Collectors &collectors) const {
+    return calculateParameter(collectors);
+  }
 
   void printItself(std::ostream &os) const noexcept override;
 
@@ -103,6 +110,28 @@ private:
       const std::vector<float> &soundPressureLevels) const;
 };
 
+// Estimates parameter from results of independent batches of rays with the
+// method of batch means: mean of the batch results is the estimate and their
+// spread gives the confidence interval of the estimate.
+class BatchMeans : public Printable {
+public:
+  void addBatch(float result);
+
+  int numOfBatches() const { return numOfBatches_; }
+  float mean() const;
+  // Half width of the 95% confidence interval of the mean from Student's t
+  // distribution. Infinite, until at least two batches are added.
+  float confidenceHalfWidth() const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  int numOfBatches_ = 0;
+  // Welford's running mean and sum of squared differences from the mean.
+  double mean_ = 0;
+  double squaredDifferences_ = 0;
+};
+
 class NormalizedDiffusionCoefficient : public ResultInterface {
 public:
   explicit NormalizedDiffusionCoefficient(
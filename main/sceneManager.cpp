@@ -42,7 +42,19 @@ void BasicSimulationProperties::printItself(std::ostream &os) const noexcept {
   os << "\n"
      << "Source Power: " << sourcePower << "\n"
      << "Number Of Collectors: " << numOfCollectors << "\n"
-     << "Number of Rays Squared: " << numOfRaysSquared << "\n";
+     << "Number of Rays Squared: " << numOfRaysSquared << "\n"
+     << "Number of Threads: " << numOfThreads << "\n"
+     << "Parallel Frequencies: " << parallelFrequencies << "\n"
+     << "Seed: " << seed << "\n"
+     << "Reuse Geometric Paths: " << reuseGeometricPaths << "\n"
+     << "Energy Cutoff: " << energyCutoff << "\n"
+     << "Russian Roulette: " << russianRoulette << "\n"
+     << "Source Sampling: " << sourceSampling << "\n"
+     << "Diffusion Tolerance: " << diffusionTolerance << "\n"
+     << "Rays Per Batch: " << raysPerBatch << "\n"
+     << "Checkpoint Path: " << checkpointPath << "\n"
+     << "Rays Per Checkpoint: " << raysPerCheckpoint << "\n"
+     << "Shard: " << shardIndex << " of " << numOfShards << "\n";
 }
 
 SimulationProperties::SimulationProperties(
@@ -68,6 +80,101 @@ SceneManager::SceneManager(
       collectorsTracker_(collectorTracker),
       reflectionEngine_(reflectionEngineInterface) {
   offseter_ = std::make_unique<generators::FakeOffseter>();
+
+  int numOfThreads =
+      simulationProperties_.basicSimulationProperties().numOfThreads;
+  if (numOfThreads < 1) {
+    std::stringstream ss;
+    ss << "Error detected in: " << simulationProperties_ << "\n"
+       << "Number of threads must be greater then 0! \n";
+    throw std::invalid_argument(ss.str());
+  }
+  if (numOfThreads > 1) {
+    threadPool_ = std::make_unique<core::ThreadPool>(numOfThreads);
+  }
+
+  float energyCutoff =
+      simulationProperties_.basicSimulationProperties().energyCutoff;
+  if (!(energyCutoff >= 0 && energyCutoff < 1)) {
+    std::stringstream ss;
+    ss << "Error detected in: " << simulationProperties_ << "\n"
+       << "Energy cutoff must be in range [0, 1)! \n";
+    throw std::invalid_argument(ss.str());
+  }
+
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  if (!(basicProperties.diffusionTolerance >= 0) ||
+      basicProperties.raysPerBatch < 1) {
+    std::stringstream ss;
+    ss << "Error detected in: " << simulationProperties_ << "\n"
+       << "Diffusion tolerance cannot be less then 0 and number of rays per "
+          "batch must be greater then 0! \n";
+    throw std::invalid_argument(ss.str());
+  }
+  if (basicProperties.diffusionTolerance > 0 &&
+      (!basicProperties.checkpointPath.empty() ||
+       (basicProperties.sourceSampling != generators::SourceSampling::kGrid &&
+        basicProperties.sourceSampling !=
+            generators::SourceSampling::kScrambledSobol))) {
+    std::stringstream ss;
+    ss << "Error detected in: " << simulationProperties_ << "\n"
+       << "Simulation until diffusion tolerance cannot use checkpoint and "
+          "traces batches with scrambled Sobol source! \n";
+    throw std::invalid_argument(ss.str());
+  }
+  if (basicProperties.diffusionTolerance > 0 &&
+      basicProperties.numOfRaysSquared * basicProperties.numOfRaysSquared /
+              basicProperties.raysPerBatch <
+          kMinBatches) {
+    std::stringstream ss;
+    ss << "Error detected in: " << simulationProperties_ << "\n"
+       << "Simulation until diffusion tolerance needs at least " << kMinBatches
+       << " batches of rays within the limit of rays! \n";
+    throw std::invalid_argument(ss.str());
+  }
+  if (basicProperties.raysPerCheckpoint < 1) {
+    std::stringstream ss;
+    ss << "Error detected in: " << simulationProperties_ << "\n"
+       << "Number of rays per checkpoint must be greater then 0! \n";
+    throw std::invalid_argument(ss.str());
+  }
+  if (basicProperties.numOfShards < 1 || basicProperties.shardIndex < 0 ||
+      basicProperties.shardIndex >= basicProperties.numOfShards ||
+      (basicProperties.numOfShards > 1 &&
+       (basicProperties.checkpointPath.empty() ||
+        basicProperties.diffusionTolerance > 0))) {
+    std::stringstream ss;
+    ss << "Error detected in: " << simulationProperties_ << "\n"
+       << "Shard index must be in range [0, number of shards) and sharded "
+          "simulation requires checkpoint path and fixed number of rays! \n";
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+void SceneManager::configureSimulator(Simulator *simulator) const {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  simulator->setSeed(basicProperties.seed);
+  simulator->setEnergyCutoff(basicProperties.energyCutoff,
+                             basicProperties.russianRoulette);
+}
+
+std::unique_ptr<generators::RayFactory> SceneManager::newPointSource() const {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  return generators::NewPointSource(
+      basicProperties.sourceSampling,
+      basicProperties.numOfRaysSquared * basicProperties.numOfRaysSquared,
+      basicProperties.sourcePower, model_, basicProperties.seed);
+}
+
+void SceneManager::runRayTracing(const Simulator &simulator, float frequency,
+                                 Collectors *collectors, int maxTracking) {
+  tracingStatistics_[frequency] =
+      threadPool_ ? simulator.runRayTracingInParallel(
+                        frequency, collectors, maxTracking, threadPool_.get())
+                  : simulator.runRayTracing(frequency, collectors, maxTracking);
 }
 
 void SceneManager::printItself(std::ostream &os) const noexcept {
@@ -92,13 +199,13 @@ SceneManager::run(const CollectorBuilderInterface *collectorBuilder) {
 
     // Initialize frequency in visual reporesentation of the simulation
     positionTracker_->initializeNewFrequency(freq);
-    generators::PointSpeakerRayFactory pointSpeaker(
-        simulationProperties_.basicSimulationProperties().numOfRaysSquared,
-        simulationProperties_.basicSimulationProperties().sourcePower, model_);
+    std::unique_ptr<generators::RayFactory> pointSpeaker = newPointSource();
 
-    Simulator simulator(
-        &raytracer_, model_, &pointSpeaker, offseter_.get(), positionTracker_,
-        simulationProperties_.energyCollectionRules(), reflectionEngine_);
+    Simulator simulator(&raytracer_, model_, pointSpeaker.get(),
+                        offseter_.get(), positionTracker_,
+                        simulationProperties_.energyCollectionRules(),
+                        reflectionEngine_);
+    configureSimulator(&simulator);
 
     Collectors collectors = collectorBuilder->buildCollectors(
         model_,
@@ -122,6 +229,23 @@ SceneManager::run(const CollectorBuilderInterface *collectorBuilder) {
 
 std::unordered_map<float, Collectors>
 SceneManager::newRun(const CollectorBuilderInterface *collectorBuilder) {
+  raysUsed_.clear();
+  if (simulationProperties_.basicSimulationProperties().diffusionTolerance >
+      0) {
+    return runUntilConverged(collectorBuilder);
+  }
+  if (!simulationProperties_.basicSimulationProperties()
+           .checkpointPath.empty()) {
+    return runWithCheckpoints(collectorBuilder);
+  }
+  if (simulationProperties_.basicSimulationProperties().reuseGeometricPaths &&
+      !reflectionEngine_->isFrequencyDependent()) {
+    return runWithGeometricPathCache(collectorBuilder);
+  }
+  if (threadPool_ &&
+      simulationProperties_.basicSimulationProperties().parallelFrequencies) {
+    return runFrequenciesInParallel(collectorBuilder);
+  }
   std::vector<float> frequencies =
       simulationProperties_.basicSimulationProperties().frequencies;
 
@@ -135,13 +259,13 @@ SceneManager::newRun(const CollectorBuilderInterface *collectorBuilder) {
     // Initialize frequency in visual reporesentation of the simulation
     positionTracker_->initializeNewFrequency(freq);
 
-    generators::PointSpeakerRayFactory pointSpeaker(
-        simulationProperties_.basicSimulationProperties().numOfRaysSquared,
-        simulationProperties_.basicSimulationProperties().sourcePower, model_);
+    std::unique_ptr<generators::RayFactory> pointSpeaker = newPointSource();
     // TODO: Simplify this constructor
-    Simulator simulator(
-        &raytracer_, model_, &pointSpeaker, offseter_.get(), positionTracker_,
-        simulationProperties_.energyCollectionRules(), reflectionEngine_);
+    Simulator simulator(&raytracer_, model_, pointSpeaker.get(),
+                        offseter_.get(), positionTracker_,
+                        simulationProperties_.energyCollectionRules(),
+                        reflectionEngine_);
+    configureSimulator(&simulator);
 
     Collectors collectors = collectorBuilder->buildCollectors(
         model_,
@@ -153,7 +277,8 @@ SceneManager::newRun(const CollectorBuilderInterface *collectorBuilder) {
     int maxTracking =
         simulationProperties_.basicSimulationProperties().maxTracking;
 
-    simulator.runRayTracing(freq, &collectors, maxTracking);
+    runRayTracing(simulator, freq, &collectors, maxTracking);
+    std::cout << tracingStatistics_.at(freq) << "\n";
 
     collectorsPerFrequencies.insert(
         std::make_pair(freq, std::move(collectors)));
@@ -163,6 +288,397 @@ SceneManager::newRun(const CollectorBuilderInterface *collectorBuilder) {
   return collectorsPerFrequencies;
 }
 
+std::unordered_map<float, Collectors> SceneManager::runFrequenciesInParallel(
+    const CollectorBuilderInterface *collectorBuilder) {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  const std::vector<float> &frequencies = basicProperties.frequencies;
+
+  std::cout << "Performing simulation for " << frequencies.size()
+            << " frequencies in parallel\n";
+
+  // Collectors are build in advance, so that collectors tracker receives them
+  // in the same order as in the sequential simulation.
+  std::vector<Collectors> collectorsPerTask;
+  collectorsPerTask.reserve(frequencies.size());
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    collectorsPerTask.push_back(collectorBuilder->buildCollectors(
+        model_, basicProperties.numOfCollectors));
+    collectorsTracker_->save(collectorsPerTask.back(), "./server/data");
+  }
+
+  const bool tracksPositions = positionTracker_->tracksPositions();
+  std::vector<trackers::BufferedPositionTracker> buffers(
+      tracksPositions ? frequencies.size() : 0);
+  std::vector<TracingStatistics> statisticsPerTask(frequencies.size());
+
+  threadPool_->parallelFor(frequencies.size(), [&](size_t index) {
+    const float frequency = frequencies[index];
+    trackers::FakePositionTracker fakeTracker;
+    trackers::PositionTrackerInterface *tracker =
+        tracksPositions ? static_cast<trackers::PositionTrackerInterface *>(
+                              &buffers[index])
+                        : &fakeTracker;
+
+    tracker->initializeNewFrequency(frequency);
+    std::unique_ptr<generators::RayFactory> pointSpeaker = newPointSource();
+    Simulator simulator(&raytracer_, model_, pointSpeaker.get(),
+                        offseter_.get(), tracker,
+                        simulationProperties_.energyCollectionRules(),
+                        reflectionEngine_);
+    configureSimulator(&simulator);
+    statisticsPerTask[index] = simulator.runRayTracing(
+        frequency, &collectorsPerTask[index], basicProperties.maxTracking);
+    tracker->endCurrentFrequency();
+  });
+
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    if (tracksPositions) {
+      buffers[index].replay(positionTracker_);
+    }
+    tracingStatistics_[frequencies[index]] = statisticsPerTask[index];
+    std::cout << "Frequency: " << frequencies[index] << " Hz\n"
+              << statisticsPerTask[index] << "\n";
+    collectorsPerFrequencies.insert(
+        std::make_pair(frequencies[index], std::move(collectorsPerTask[index])));
+  }
+  positionTracker_->save();
+  return collectorsPerFrequencies;
+}
+
+std::unordered_map<float, Collectors> SceneManager::runWithGeometricPathCache(
+    const CollectorBuilderInterface *collectorBuilder) {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  const std::vector<float> &frequencies = basicProperties.frequencies;
+
+  std::cout << "Performing simulation of paths shared by "
+            << frequencies.size() << " frequencies\n";
+
+  std::vector<Collectors> collectorsPerFrequency;
+  collectorsPerFrequency.reserve(frequencies.size());
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    collectorsPerFrequency.push_back(collectorBuilder->buildCollectors(
+        model_, basicProperties.numOfCollectors));
+    collectorsTracker_->save(collectorsPerFrequency.back(), "./server/data");
+  }
+
+  const bool tracksPositions = positionTracker_->tracksPositions();
+  trackers::BufferedPositionTracker buffer;
+  trackers::FakePositionTracker fakeTracker;
+  std::unique_ptr<generators::RayFactory> pointSpeaker = newPointSource();
+  Simulator simulator(
+      &raytracer_, model_, pointSpeaker.get(), offseter_.get(),
+      tracksPositions ? static_cast<trackers::PositionTrackerInterface *>(&buffer)
+                      : &fakeTracker,
+      simulationProperties_.energyCollectionRules(), reflectionEngine_);
+  configureSimulator(&simulator);
+
+  EscapeEvents escapeEvents;
+  const TracingStatistics statistics = simulator.recordEscapeEvents(
+      frequencies.front(), basicProperties.maxTracking, &escapeEvents,
+      tracksPositions ? nullptr : threadPool_.get());
+  std::cout << statistics << "\tRecorded escape events: "
+            << escapeEvents.size() << "\n";
+
+  // Energy of every ray is collected in all bands at once. With thread pool
+  // every worker collects energy in its own group of bands.
+  const size_t numOfGroups =
+      threadPool_ ? std::min<size_t>(threadPool_->numOfThreads(),
+                                     frequencies.size())
+                  : 1;
+  auto collect = [&](size_t group) {
+    const size_t first = frequencies.size() * group / numOfGroups;
+    const size_t last = frequencies.size() * (group + 1) / numOfGroups;
+    std::vector<float> groupFrequencies(frequencies.begin() + first,
+                                        frequencies.begin() + last);
+    std::vector<Collectors *> collectorsPerBand;
+    for (size_t index = first; index < last; ++index) {
+      collectorsPerBand.push_back(&collectorsPerFrequency[index]);
+    }
+    simulator.collectEscapedEnergy(escapeEvents, groupFrequencies,
+                                   collectorsPerBand);
+  };
+  if (threadPool_) {
+    threadPool_->parallelFor(numOfGroups, collect);
+  } else {
+    collect(0);
+  }
+
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    if (tracksPositions) {
+      positionTracker_->initializeNewFrequency(frequencies[index]);
+      trackers::BufferedPositionTracker positions = buffer;
+      positions.replay(positionTracker_);
+      positionTracker_->endCurrentFrequency();
+    }
+    tracingStatistics_[frequencies[index]] = statistics;
+    collectorsPerFrequencies.insert(std::make_pair(
+        frequencies[index], std::move(collectorsPerFrequency[index])));
+  }
+  positionTracker_->save();
+  return collectorsPerFrequencies;
+}
+
+std::unordered_map<float, Collectors> SceneManager::runUntilConverged(
+    const CollectorBuilderInterface *collectorBuilder) {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  const std::vector<float> &frequencies = basicProperties.frequencies;
+  const int raysPerBatch = basicProperties.raysPerBatch;
+  const int maxBatches =
+      basicProperties.numOfRaysSquared * basicProperties.numOfRaysSquared /
+      raysPerBatch;
+  const bool sharePaths = basicProperties.reuseGeometricPaths &&
+                          !reflectionEngine_->isFrequencyDependent();
+
+  std::cout << "Performing simulation in batches of " << raysPerBatch
+            << " rays until diffusion coefficient is known within "
+            << basicProperties.diffusionTolerance << "\n";
+
+  std::vector<Collectors> collectorsPerFrequency;
+  collectorsPerFrequency.reserve(frequencies.size());
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    collectorsPerFrequency.push_back(collectorBuilder->buildCollectors(
+        model_, basicProperties.numOfCollectors));
+    collectorsTracker_->save(collectorsPerFrequency.back(), "./server/data");
+  }
+
+  WaveObjectFactory waveFactory(objects::EnergyHistogram::kDefaultSampleRate);
+  DiffusionCoefficient diffusion(&waveFactory);
+  std::vector<BatchMeans> estimates(frequencies.size());
+  std::vector<TracingStatistics> statistics(frequencies.size());
+  // Indices of frequencies that did not reach the tolerance yet.
+  std::vector<size_t> active(frequencies.size());
+  std::iota(active.begin(), active.end(), 0);
+
+  for (int batch = 0; batch < maxBatches && !active.empty(); ++batch) {
+    const uint64_t batchSeed =
+        basicProperties.seed ^
+        (static_cast<uint64_t>(batch + 1) * 0x9e3779b97f4a7c15ull);
+    const generators::QuasiRandomSpeakerRayFactory source(
+        raysPerBatch, basicProperties.sourcePower, model_,
+        generators::QuasiRandomSpeakerRayFactory::Sequence::kSobol,
+        static_cast<uint32_t>(batchSeed ^ (batchSeed >> 32)));
+    trackers::FakePositionTracker fakeTracker;
+    // Source generates its rays only once, so every simulation of the batch
+    // gets its own copy of the |source|.
+    auto simulate = [&](generators::QuasiRandomSpeakerRayFactory *raySource) {
+      Simulator simulator(&raytracer_, model_, raySource, offseter_.get(),
+                          &fakeTracker,
+                          simulationProperties_.energyCollectionRules(),
+                          reflectionEngine_);
+      configureSimulator(&simulator);
+      simulator.setSeed(batchSeed);
+      return simulator;
+    };
+
+    std::vector<Collectors> batchCollectors;
+    batchCollectors.reserve(active.size());
+    for (size_t index : active) {
+      batchCollectors.push_back(
+          cloneEmptyCollectors(collectorsPerFrequency[index]));
+    }
+
+    if (sharePaths) {
+      generators::QuasiRandomSpeakerRayFactory raySource = source;
+      Simulator simulator = simulate(&raySource);
+      EscapeEvents escapeEvents;
+      const TracingStatistics batchStatistics = simulator.recordEscapeEvents(
+          frequencies[active.front()], basicProperties.maxTracking,
+          &escapeEvents, threadPool_.get());
+      std::vector<float> activeFrequencies;
+      std::vector<Collectors *> collectorsPerBand;
+      for (size_t band = 0; band < active.size(); ++band) {
+        activeFrequencies.push_back(frequencies[active[band]]);
+        collectorsPerBand.push_back(&batchCollectors[band]);
+        statistics[active[band]].merge(batchStatistics);
+      }
+      simulator.collectEscapedEnergy(escapeEvents, activeFrequencies,
+                                     collectorsPerBand);
+    } else {
+      for (size_t band = 0; band < active.size(); ++band) {
+        const float frequency = frequencies[active[band]];
+        generators::QuasiRandomSpeakerRayFactory raySource = source;
+        Simulator simulator = simulate(&raySource);
+        statistics[active[band]].merge(
+            threadPool_ ? simulator.runRayTracingInParallel(
+                              frequency, &batchCollectors[band],
+                              basicProperties.maxTracking, threadPool_.get())
+                        : simulator.runRayTracing(frequency,
+                                                  &batchCollectors[band],
+                                                  basicProperties.maxTracking));
+      }
+    }
+
+    std::vector<size_t> stillActive;
+    for (size_t band = 0; band < active.size(); ++band) {
+      const size_t index = active[band];
+      estimates[index].addBatch(diffusion.getResult(batchCollectors[band]));
+      addCollectedEnergy(batchCollectors[band], &collectorsPerFrequency[index]);
+      if (estimates[index].numOfBatches() < kMinBatches ||
+          !(estimates[index].confidenceHalfWidth() <=
+            basicProperties.diffusionTolerance)) {
+        stillActive.push_back(index);
+      }
+    }
+    active = std::move(stillActive);
+  }
+
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    const int numOfBatches = estimates[index].numOfBatches();
+    for (auto &collector : collectorsPerFrequency[index]) {
+      collector->scaleEnergy(1.0f / numOfBatches);
+    }
+    raysUsed_[frequencies[index]] =
+        static_cast<float>(numOfBatches) * raysPerBatch;
+    tracingStatistics_[frequencies[index]] = statistics[index];
+    std::cout << "Frequency: " << frequencies[index] << " Hz\n"
+              << "\tRays used: " << raysUsed_[frequencies[index]] << "\n"
+              << "\tDiffusion coefficient: " << estimates[index] << "\n";
+    // Positions are not tracked, but every frequency is still reported.
+    positionTracker_->initializeNewFrequency(frequencies[index]);
+    positionTracker_->endCurrentFrequency();
+    collectorsPerFrequencies.insert(std::make_pair(
+        frequencies[index], std::move(collectorsPerFrequency[index])));
+  }
+  positionTracker_->save();
+  return collectorsPerFrequencies;
+}
+
+std::string SceneManager::resultsDescription() const {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  std::stringstream description;
+  description << "frequencies: ";
+  for (float frequency : basicProperties.frequencies) {
+    description << frequency << ", ";
+  }
+  description << "\n"
+              << "Source Power: " << basicProperties.sourcePower << "\n"
+              << "Number Of Collectors: " << basicProperties.numOfCollectors
+              << "\n"
+              << "Number of Rays Squared: " << basicProperties.numOfRaysSquared
+              << "\n"
+              << "Max Tracking: " << basicProperties.maxTracking << "\n"
+              << "Seed: " << basicProperties.seed << "\n"
+              << "Energy Cutoff: " << basicProperties.energyCutoff << "\n"
+              << "Russian Roulette: " << basicProperties.russianRoulette
+              << "\n"
+              << "Source Sampling: " << basicProperties.sourceSampling << "\n"
+              << *simulationProperties_.energyCollectionRules()
+              << *reflectionEngine_ << *model_;
+  return description.str();
+}
+
+std::unordered_map<float, Collectors> SceneManager::runWithCheckpoints(
+    const CollectorBuilderInterface *collectorBuilder) {
+  const BasicSimulationProperties basicProperties =
+      simulationProperties_.basicSimulationProperties();
+  const std::vector<float> &frequencies = basicProperties.frequencies;
+
+  // Every shard of the simulation has the same fingerprint.
+  checkpoints::Checkpoint checkpoint;
+  checkpoint.fingerprint = fnv1aHash(resultsDescription());
+
+  const int numOfRays = newPointSource()->numOfRays();
+  const int firstRay = static_cast<int64_t>(numOfRays) *
+                       basicProperties.shardIndex / basicProperties.numOfShards;
+  const int lastRay = static_cast<int64_t>(numOfRays) *
+                      (basicProperties.shardIndex + 1) /
+                      basicProperties.numOfShards;
+  auto isBandOfShard = [&](const auto &band) {
+    return band->firstRay == firstRay && band->lastRay == lastRay;
+  };
+  std::optional<checkpoints::Checkpoint> saved =
+      checkpoints::load(basicProperties.checkpointPath);
+  if (saved) {
+    if (saved->fingerprint != checkpoint.fingerprint ||
+        saved->bands.size() != frequencies.size() ||
+        !std::all_of(saved->bands.begin(), saved->bands.end(),
+                     isBandOfShard)) {
+      std::stringstream ss;
+      ss << "Error detected in: " << simulationProperties_ << "\n"
+         << "Checkpoint at: " << basicProperties.checkpointPath
+         << " belongs to a different simulation! \n";
+      throw std::invalid_argument(ss.str());
+    }
+    checkpoint = std::move(*saved);
+    std::cout << "Resuming simulation from: " << checkpoint;
+  } else {
+    for (float frequency : frequencies) {
+      auto band = std::make_shared<checkpoints::BandProgress>();
+      band->frequency = frequency;
+      band->firstRay = firstRay;
+      band->nextRay = firstRay;
+      band->lastRay = lastRay;
+      band->numOfRays = numOfRays;
+      band->statistics.depthLimit = basicProperties.maxTracking;
+      checkpoint.bands.push_back(std::move(band));
+    }
+  }
+  checkpoints::AsyncCheckpointWriter writer(basicProperties.checkpointPath);
+
+  std::unordered_map<float, Collectors> collectorsPerFrequencies;
+  for (size_t index = 0; index < frequencies.size(); ++index) {
+    const float frequency = frequencies[index];
+    std::cout << "Performing simulation for frequency: " << frequency
+              << " Hz\n";
+    positionTracker_->initializeNewFrequency(frequency);
+
+    std::unique_ptr<generators::RayFactory> pointSpeaker = newPointSource();
+    Simulator simulator(&raytracer_, model_, pointSpeaker.get(),
+                        offseter_.get(), positionTracker_,
+                        simulationProperties_.energyCollectionRules(),
+                        reflectionEngine_);
+    configureSimulator(&simulator);
+
+    Collectors collectors = collectorBuilder->buildCollectors(
+        model_, basicProperties.numOfCollectors);
+    collectorsTracker_->save(collectors, "./server/data");
+    if (checkpoint.collectors.empty()) {
+      for (const auto &collector : collectors) {
+        checkpoint.collectors.push_back(
+            {collector->getOrigin(), collector->getRadius()});
+      }
+    }
+
+    checkpoints::BandProgress band = *checkpoint.bands[index];
+    // Energies are saved only after the first range of rays is traced.
+    for (size_t collector = 0; collector < band.energies.size(); ++collector) {
+      collectors.at(collector)->setEnergy(band.energies[collector]);
+    }
+
+    while (!band.completed()) {
+      const int lastRayOfRange = std::min(
+          band.lastRay, band.nextRay + basicProperties.raysPerCheckpoint);
+      band.statistics.merge(simulator.runRayTracingOnRange(
+          frequency, &collectors, basicProperties.maxTracking, band.nextRay,
+          lastRayOfRange, threadPool_.get()));
+      band.nextRay = lastRayOfRange;
+      band.energies.clear();
+      for (const auto &collector : collectors) {
+        band.energies.push_back(collector->getEnergy());
+      }
+      checkpoint.bands[index] =
+          std::make_shared<const checkpoints::BandProgress>(band);
+      writer.save(checkpoint);
+    }
+
+    tracingStatistics_[frequency] = band.statistics;
+    std::cout << band.statistics << "\n";
+    collectorsPerFrequencies.insert(
+        std::make_pair(frequency, std::move(collectors)));
+    positionTracker_->endCurrentFrequency();
+  }
+  writer.flush();
+  positionTracker_->save();
+  return collectorsPerFrequencies;
+}
+
 std::unordered_map<float, Collectors> SceneManager::runWithCustomSource(
     const CollectorBuilderInterface *collectorBuilder,
     generators::RayFactory *source) {
@@ -180,6 +696,7 @@ std::unordered_map<float, Collectors> SceneManager::runWithCustomSource(
     Simulator simulator(
         &raytracer_, model_, source, offseter_.get(), positionTracker_,
         simulationProperties_.energyCollectionRules(), reflectionEngine_);
+    configureSimulator(&simulator);
 
     Collectors collectors = collectorBuilder->buildCollectors(
         model_,
@@ -191,7 +708,7 @@ std::unordered_map<float, Collectors> SceneManager::runWithCustomSource(
     int maxTracking =
         simulationProperties_.basicSimulationProperties().maxTracking;
 
-    simulator.runRayTracing(freq, &collectors, maxTracking);
+    runRayTracing(simulator, freq, &collectors, maxTracking);
 
     collectorsPerFrequencies.insert(
         std::make_pair(freq, std::move(collectors)));
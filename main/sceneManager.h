@@ -2,16 +2,24 @@
 #define SCENEMANAGER_H
 
 #include "core/classUtlilities.h"
+#include "core/threadPool.h"
 #include "core/vec3.h"
+#include "main/checkpoint.h"
 #include "main/rayTracer.h"
+#include "main/resultsCalculation.h"
 #include "main/simulator.h"
 #include "main/trackers.h"
 #include "obj/generators.h"
 #include "obj/objects.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <exception>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <sstream>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <utility>
@@ -26,10 +34,18 @@
 // |numOfRaysSquared| determine how many rays will be used in the simulation.
 // Note: final number of used rays in simulation will be: |numOfRaysSquared|^2.
 // |maxTracking| how many reflection will simulation track per ray at maximum.
+// |numOfThreads| how many threads trace rays of each frequency. With more
+// than one thread positions of rays are not tracked.
+// |parallelFrequencies| when true and |numOfThreads| is greater then 1,
+// SceneManager::newRun() simulates whole frequencies concurrently instead of
+// splitting rays of each frequency between threads.
+// |seed| of random numbers used by the reflection engine. Simulations with
+// the same |seed| give the same results.
 // REQUIREMENTS: |frequencies| cannot be empty, |sourcePower| must
 // be positive value, |numOfCollectors| must be greater then 4 and
 // |numCollectors| or  |numOfCollectors| - 1 must be divisable by 4,
-// |numOfRaysSquared| greater then 0, |maxTracking| must be greater then 1
+// |numOfRaysSquared| greater then 0, |maxTracking| must be greater then 1,
+// |numOfThreads| must be greater then 0.
 struct BasicSimulationProperties : public Printable {
   explicit BasicSimulationProperties(const std::vector<float> &frequencies,
                                      float sourcePower, int numOfCollectors,
@@ -39,6 +55,43 @@ struct BasicSimulationProperties : public Printable {
   int numOfCollectors;
   int numOfRaysSquared;
   int maxTracking;
+  int numOfThreads = 1;
+  bool parallelFrequencies = false;
+  uint64_t seed = 0;
+  // When reflection engine is not frequency dependent, rays are traced only
+  // once and energy of the same rays is collected for every frequency.
+  bool reuseGeometricPaths = true;
+  // Reflected rays carrying less than |energyCutoff| of the energy of their
+  // source ray take part in Russian roulette, or are discarded when
+  // |russianRoulette| is false. See Simulator::setEnergyCutoff().
+  float energyCutoff = 0;
+  bool russianRoulette = true;
+  // How rays of the source are aimed at the model. Quasi random sequences
+  // emit the same |numOfRaysSquared|^2 rays.
+  generators::SourceSampling sourceSampling = generators::SourceSampling::kGrid;
+  // When greater than 0, SceneManager::newRun() traces rays in batches of
+  // |raysPerBatch| rays and stops each frequency, when its diffusion
+  // coefficient is known within |diffusionTolerance| with 95% confidence.
+  // |numOfRaysSquared|^2 is then the limit of rays traced for each frequency
+  // and must fit at least SceneManager::kMinBatches batches.
+  // Batches must be independent, so they are traced with Owen scrambled Sobol
+  // source and |sourceSampling| must be kGrid or kScrambledSobol. Such
+  // simulation cannot be saved to the checkpoint.
+  float diffusionTolerance = 0;
+  int raysPerBatch = 1024;
+  // When not empty, SceneManager::newRun() saves progress to the checkpoint
+  // at |checkpointPath| after every |raysPerCheckpoint| rays of each
+  // frequency and resumes from the checkpoint saved by the same simulation.
+  // Frequencies are then simulated one after another.
+  std::string checkpointPath;
+  int raysPerCheckpoint = 16384;
+  // Simulation split between |numOfShards| processes traces in shard
+  // |shardIndex| only its part of rays of the source and saves the collected
+  // energy in the checkpoint at |checkpointPath|. See
+  // checkpoints::mergeShards(). Number of rays cannot depend on
+  // |diffusionTolerance| then.
+  int shardIndex = 0;
+  int numOfShards = 1;
 
   void printItself(std::ostream &os) const noexcept override;
 };
@@ -99,9 +152,64 @@ public:
   runWithCustomSource(const CollectorBuilderInterface *collectorBuilder,
                       generators::RayFactory *source);
 
+  // Number of rays traced for every frequency by the last run that stopped
+  // at |diffusionTolerance|. Empty after runs with fixed number of rays.
+  const std::map<float, float> &raysUsed() const { return raysUsed_; }
+
+  // Smallest number of batches, from which the confidence interval is
+  // trusted.
+  static constexpr int kMinBatches = 4;
+
+  // Depth and memory used by the last simulation of every frequency.
+  const std::unordered_map<float, TracingStatistics> &
+  tracingStatistics() const {
+    return tracingStatistics_;
+  }
+
   void printItself(std::ostream &os) const noexcept override;
 
 private:
+  // Passes seed and energy cutoff from simulation properties to |simulator|.
+  void configureSimulator(Simulator *simulator) const;
+  // Creates source with sampling and number of rays of simulation properties.
+  std::unique_ptr<generators::RayFactory> newPointSource() const;
+  // Uses thread pool when simulation properties require more then one thread.
+  void runRayTracing(const Simulator &simulator, float frequency,
+                     Collectors *collectors, int maxTracking);
+  // Simulates every frequency as a separate task of the thread pool. Events
+  // for trackers are buffered and passed to them in order of frequencies
+  // after all tasks are finished.
+  std::unordered_map<float, Collectors>
+  runFrequenciesInParallel(const CollectorBuilderInterface *collectorBuilder);
+  // Traces rays once, records rays that reached the sphere wall and collects
+  // their energy in all frequency bands at once. Positions are tracked once
+  // and passed to the position tracker for every frequency.
+  std::unordered_map<float, Collectors>
+  runWithGeometricPathCache(const CollectorBuilderInterface *collectorBuilder);
+  // Traces batches of rays until diffusion coefficient of every frequency
+  // reaches |diffusionTolerance| or limit of rays. Every batch is an
+  // independent simulation with Owen scrambled Sobol source and seed of its
+  // own. Collected energy is the mean of batches, so it does not depend on
+  // the number of batches. Positions are not tracked, but every frequency is
+  // passed to the position tracker, which is saved at the end.
+  std::unordered_map<float, Collectors>
+  runUntilConverged(const CollectorBuilderInterface *collectorBuilder);
+  // Describes everything that collected energy depends on: properties of the
+  // simulation, energy collection rules, reflection engine and the model.
+  // Number of threads and the way rays are scheduled between them are
+  // omitted, so checkpoints of the same simulation traced by different
+  // machines have the same fingerprint.
+  std::string resultsDescription() const;
+  // Simulates frequencies one after another in ranges of |raysPerCheckpoint|
+  // rays and saves checkpoint after each range. Rays traced before the
+  // checkpoint was saved are not traced again, so their positions are not
+  // tracked. Results are the same, no matter how many times the simulation
+  // was resumed. Only rays of the current shard are traced. Throws
+  // std::invalid_argument when the checkpoint belongs to a different
+  // simulation.
+  std::unordered_map<float, Collectors>
+  runWithCheckpoints(const CollectorBuilderInterface *collectorBuilder);
+
   Model *model_;
   SimulationProperties simulationProperties_;
   RayTracer raytracer_;
@@ -109,6 +217,9 @@ private:
   trackers::CollectorsTrackerInterface *collectorsTracker_;
   ReflectionEngineInterface *reflectionEngine_;
   std::unique_ptr<generators::RandomRayOffseter> offseter_;
+  std::unique_ptr<core::ThreadPool> threadPool_;
+  std::unordered_map<float, TracingStatistics> tracingStatistics_;
+  std::map<float, float> raysUsed_;
 };
 
 #endif
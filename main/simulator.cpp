@@ -1,4 +1,5 @@
 #include "main/simulator.h"
+#include "main/policySimulator.h"
 
 namespace collectionRules {
 
@@ -6,23 +7,82 @@ void CollectEnergyInterface::printItself(std::ostream &os) const noexcept {
   os << "Collect Energy Rules Class Interface";
 }
 
-void LinearEnergyCollection::collectEnergy(
-    const std::vector<std::unique_ptr<objects::EnergyCollector>> &collectors,
-    core::RayHitData *hitData) {
+void CollectEnergyInterface::collectEnergy(const Collectors &collectors,
+                                           core::RayHitData *hitData) {
+  const Collectors *collectorsPerBand[] = {&collectors};
+  collectEnergyInBands(collectorsPerBand, &hitData->frequency, /*numOfBands=*/1,
+                       /*candidates=*/nullptr, hitData->collisionPoint(),
+                       *hitData);
+}
 
+void CollectEnergyInterface::collectEnergy(const Collectors &collectors,
+                                           const CollectorIndex &index,
+                                           core::RayHitData *hitData) {
+  const Collectors *collectorsPerBand[] = {&collectors};
   core::Vec3 reachedPosition = hitData->collisionPoint();
-  for (auto &energyCollector : collectors) {
-    if (energyCollector->isVecInside(reachedPosition)) {
-      float distanceToOrigin =
-          (energyCollector->getOrigin() - reachedPosition).magnitude();
-
-      // The closer ray hits origin of the energy Collector, the more energy
-      // energyCollector collects.
-      float energyRatio = 1 - distanceToOrigin / energyCollector->getRadius();
-      energyCollector->addEnergy(hitData->accumulatedTime,
-                                 energyRatio * hitData->energy() /
-                                     energyCollector->volume());
-    };
+  collectEnergyInBands(collectorsPerBand, &hitData->frequency, /*numOfBands=*/1,
+                       &index.candidates(reachedPosition), reachedPosition,
+                       *hitData);
+}
+
+void CollectEnergyInterface::collectEnergyInBands(
+    const std::vector<Collectors *> &collectorsPerBand,
+    const std::vector<float> &frequencies, const CollectorIndex &index,
+    const core::RayHitData &hitData) {
+  if (collectorsPerBand.size() != frequencies.size()) {
+    std::stringstream ss;
+    ss << "Error in collectEnergyInBands() of: " << *this << "\n"
+       << "Number of collectors per band: " << collectorsPerBand.size()
+       << " is different from number of frequencies: " << frequencies.size()
+       << '\n';
+    throw std::invalid_argument(ss.str());
+  }
+  core::Vec3 reachedPosition = hitData.collisionPoint();
+  const std::vector<uint32_t> &candidates = index.candidates(reachedPosition);
+  for (size_t firstBand = 0; firstBand < frequencies.size();
+       firstBand += kBandWidth) {
+    const int numOfBands =
+        std::min<size_t>(kBandWidth, frequencies.size() - firstBand);
+    collectEnergyInBands(collectorsPerBand.data() + firstBand,
+                         frequencies.data() + firstBand, numOfBands,
+                         &candidates, reachedPosition, hitData);
+  }
+}
+
+void CollectEnergyInterface::collectEnergyInBands(
+    const Collectors *const *collectorsPerBand, const float *frequencies,
+    int numOfBands, const std::vector<uint32_t> *candidates,
+    const core::Vec3 &reachedPosition, const core::RayHitData &hitData) const {
+  collectEnergyWithHooks(
+      collectorsPerBand, frequencies, numOfBands, candidates, reachedPosition,
+      hitData,
+      [this](const core::RayHitData &hitData, const float *frequencies,
+             int numOfBands, float *rayEnergies) {
+        rayEnergiesInBands(hitData, frequencies, numOfBands, rayEnergies);
+      },
+      [this](const objects::EnergyCollector &collector, float distanceToOrigin,
+             const float *rayEnergies, int numOfBands, float *collected) {
+        collectedEnergyInBands(collector, distanceToOrigin, rayEnergies,
+                               numOfBands, collected);
+      });
+}
+
+void CollectEnergyInterface::rayEnergiesInBands(const core::RayHitData &hitData,
+                                                const float *frequencies,
+                                                int numOfBands,
+                                                float *rayEnergies) const {
+  std::fill(rayEnergies, rayEnergies + numOfBands, hitData.energy());
+}
+
+void LinearEnergyCollection::collectedEnergyInBands(
+    const objects::EnergyCollector &collector, float distanceToOrigin,
+    const float *rayEnergies, int numOfBands, float *collected) const {
+  // The closer ray hits origin of the energy Collector, the more energy
+  // energyCollector collects.
+  const float energyRatio = 1 - distanceToOrigin / collector.getRadius();
+  const float volume = collector.volume();
+  for (int band = 0; band < numOfBands; ++band) {
+    collected[band] = energyRatio * rayEnergies[band] / volume;
   }
 }
 
@@ -30,45 +90,41 @@ void LinearEnergyCollection::printItself(std::ostream &os) const noexcept {
   os << "Linear Energy Collection";
 }
 
-void LinearEnergyCollectionWithPhaseImpact::collectEnergy(
-    const std::vector<std::unique_ptr<objects::EnergyCollector>> &collectors,
-    core::RayHitData *hitData) {
+void LinearEnergyCollectionWithPhaseImpact::rayEnergiesInBands(
+    const core::RayHitData &hitData, const float *frequencies, int numOfBands,
+    float *rayEnergies) const {
+  for (int band = 0; band < numOfBands; ++band) {
+    rayEnergies[band] =
+        hitData.energy() *
+        std::cos(core::Ray::phaseAt(frequencies[band], hitData.accumulatedTime));
+  }
+}
 
-  core::Vec3 reachedPosition = hitData->collisionPoint();
-  for (auto &energyCollector : collectors) {
-    if (energyCollector->isVecInside(reachedPosition)) {
-      float distanceToOrigin =
-          (energyCollector->getOrigin() - reachedPosition).magnitude();
-
-      // The closer ray hits origin of the energy Collector, the more energy
-      // energyCollector collects.
-      float energyRatio = 1 - distanceToOrigin / energyCollector->getRadius();
-      energyCollector->addEnergy(hitData->accumulatedTime,
-                                 energyRatio * hitData->energy() *
-                                     std::cos(hitData->phase()) /
-                                     energyCollector->volume());
-    };
+void LinearEnergyCollectionWithPhaseImpact::collectedEnergyInBands(
+    const objects::EnergyCollector &collector, float distanceToOrigin,
+    const float *rayEnergies, int numOfBands, float *collected) const {
+  // The closer ray hits origin of the energy Collector, the more energy
+  // energyCollector collects.
+  const float energyRatio = 1 - distanceToOrigin / collector.getRadius();
+  const float volume = collector.volume();
+  for (int band = 0; band < numOfBands; ++band) {
+    collected[band] = energyRatio * rayEnergies[band] / volume;
   }
 }
+
 void LinearEnergyCollectionWithPhaseImpact::printItself(
     std::ostream &os) const noexcept {
   os << "Linear Energy Collection With Phase Impact";
 }
 
-void NonLinearEnergyCollection::collectEnergy(const Collectors &collectors,
-                                              core::RayHitData *hitData) {
-  core::Vec3 reachedPosition = hitData->collisionPoint();
-  for (const auto &collector : collectors) {
-    if (collector->isVecInside(reachedPosition)) {
-      float distanceToOrigin =
-          (collector->getOrigin() - reachedPosition).magnitude();
-      float distanceFactor = 2 * std::sqrt(std::pow(collector->getRadius(), 2) -
-                                           std::pow(distanceToOrigin, 2));
-      float soundIntensity =
-          hitData->energy() * distanceFactor / collector->volume();
-
-      collector->addEnergy(hitData->accumulatedTime, soundIntensity);
-    }
+void NonLinearEnergyCollection::collectedEnergyInBands(
+    const objects::EnergyCollector &collector, float distanceToOrigin,
+    const float *rayEnergies, int numOfBands, float *collected) const {
+  const float distanceFactor = 2 * std::sqrt(std::pow(collector.getRadius(), 2) -
+                                             std::pow(distanceToOrigin, 2));
+  const float volume = collector.volume();
+  for (int band = 0; band < numOfBands; ++band) {
+    collected[band] = rayEnergies[band] * distanceFactor / volume;
   }
 }
 
@@ -380,6 +436,56 @@ const float getSphereWallRadius(const ModelInterface &model) {
                   4 * std::max(model.height(), model.sideSize()));
 }
 
+void TracingStatistics::merge(const TracingStatistics &other) {
+  depthLimit = std::max(depthLimit, other.depthLimit);
+  maxReachedDepth = std::max(maxReachedDepth, other.maxReachedDepth);
+  maxPendingRays = std::max(maxPendingRays, other.maxPendingRays);
+  emittedEnergy += other.emittedEnergy;
+  discardedEnergy += other.discardedEnergy;
+  discardedRays += other.discardedRays;
+  energyAtDepthLimit += other.energyAtDepthLimit;
+}
+
+size_t TracingStatistics::maxPendingRaysBytes() const {
+  return maxPendingRays * sizeof(PendingRay);
+}
+
+void TracingStatistics::printItself(std::ostream &os) const noexcept {
+  os << "TRACING STATISTICS\n"
+     << "\tDepth limit: " << depthLimit << "\n"
+     << "\tMax reached depth: " << maxReachedDepth << "\n"
+     << "\tMax pending rays: " << maxPendingRays << " ("
+     << maxPendingRaysBytes() << " [B])\n"
+     << "\tEmitted energy: " << emittedEnergy << "\n"
+     << "\tDiscarded below energy cutoff: " << discardedEnergy << " ("
+     << discardedRays << " rays)\n"
+     << "\tLeft at depth limit: " << energyAtDepthLimit << "\n";
+}
+
+Collectors cloneEmptyCollectors(const Collectors &collectors) {
+  Collectors clones;
+  clones.reserve(collectors.size());
+  for (const auto &collector : collectors) {
+    clones.push_back(std::make_unique<objects::EnergyCollector>(
+        collector->getOrigin(), collector->getRadius()));
+  }
+  return clones;
+}
+
+void addCollectedEnergy(const Collectors &source, Collectors *destination) {
+  if (source.size() != destination->size()) {
+    std::stringstream ss;
+    ss << "Error in addCollectedEnergy()\n"
+       << "Number of source collectors: " << source.size()
+       << " is different from number of destination collectors: "
+       << destination->size() << '\n';
+    throw std::invalid_argument(ss.str());
+  }
+  for (size_t index = 0; index < source.size(); ++index) {
+    (*destination)[index]->addEnergy(source[index]->getEnergy());
+  }
+}
+
 void ReflectionEngineInterface::printItself(std::ostream &os) const noexcept {
   os << "Reflection Engine Interface\n";
 }
@@ -393,6 +499,35 @@ void SimpleFourSidedReflectionEngine::printItself(
   os << "Simple Four Sided Reflection Engine\n";
 }
 
+void ReflectedRays::push_back(const core::Ray &ray) {
+  if (size_ == kCapacity) {
+    std::stringstream ss;
+    ss << "Cannot reflect more then " << kCapacity << " rays!\n"
+       << "Ray: " << ray << " does not fit in the buffer";
+    throw std::length_error(ss.str());
+  }
+  rays_[size_++] = ray;
+}
+
+void ReflectionEngineInterface::modelReflectedSoundWave(
+    const core::Ray &reflected, float frequency,
+    core::CounterRandomStream *randomStream, ReflectedRays *output) const {
+  output->clear();
+  for (const core::Ray &ray :
+       modelReflectedSoundWave(reflected, frequency, randomStream)) {
+    output->push_back(ray);
+  }
+}
+
+void ReflectionEngineInterface::modelReflectedSoundWaves(
+    const core::Ray *reflected, size_t numOfReflected, float frequency,
+    core::CounterRandomStream *randomStreams, ReflectedRays *output) const {
+  for (size_t index = 0; index < numOfReflected; ++index) {
+    modelReflectedSoundWave(reflected[index], frequency, &randomStreams[index],
+                            &output[index]);
+  }
+}
+
 std::vector<core::Ray>
 FakeReflectionEngine::modelReflectedSoundWave(const core::Ray &reflected,
                                               float reflection) const {
@@ -401,14 +536,14 @@ FakeReflectionEngine::modelReflectedSoundWave(const core::Ray &reflected,
 
 std::optional<core::Vec3>
 SimpleFourSidedReflectionEngine::getRandomParpendicularVec3ToReflected(
-    const core::Ray &reflected) const {
+    const core::Ray &reflected, core::CounterRandomStream *randomStream) const {
 
   // to get random vector which is parpendicular to reflected Ray direction we
   // need to obtain two random values.
   float A1, A2;
   do {
-    A1 = randomEngine_.getRandomFloat();
-    A2 = randomEngine_.getRandomFloat();
+    A1 = randomStream->nextFloat();
+    A2 = randomStream->nextFloat();
   } while (A1 == 0 && A2 == 0);
 
   // Calculate 3rd dimension to make new Vec3 direction parpendicular to
@@ -440,11 +575,45 @@ SimpleFourSidedReflectionEngine::getParpendicularVec3ToRandomAndReflected(
 
 std::vector<core::Ray> SimpleFourSidedReflectionEngine::modelReflectedSoundWave(
     const core::Ray &reflected, float frequency) const {
+  core::CounterRandomStream randomStream(
+      randomEngine_.getRandomIntInRange(0, std::numeric_limits<int>::max()),
+      0, 0, 0);
+  return modelReflectedSoundWave(reflected, frequency, &randomStream);
+}
+
+std::vector<core::Ray> SimpleFourSidedReflectionEngine::modelReflectedSoundWave(
+    const core::Ray &reflected, float frequency,
+    core::CounterRandomStream *randomStream) const {
+  ReflectedRays output;
+  SimpleFourSidedReflectionEngine::modelReflectedSoundWave(
+      reflected, frequency, randomStream, &output);
+  return std::vector<core::Ray>(output.begin(), output.end());
+}
 
-  float directionOffset = 100 / (frequency * std::log10(frequency));
+void SimpleFourSidedReflectionEngine::modelReflectedSoundWave(
+    const core::Ray &reflected, float frequency,
+    core::CounterRandomStream *randomStream, ReflectedRays *output) const {
+  reflect(reflected, directionOffset(frequency), randomStream, output);
+}
+
+void SimpleFourSidedReflectionEngine::modelReflectedSoundWaves(
+    const core::Ray *reflected, size_t numOfReflected, float frequency,
+    core::CounterRandomStream *randomStreams, ReflectedRays *output) const {
+  const float offset = directionOffset(frequency);
+  for (size_t index = 0; index < numOfReflected; ++index) {
+    reflect(reflected[index], offset, &randomStreams[index], &output[index]);
+  }
+}
 
+float SimpleFourSidedReflectionEngine::directionOffset(float frequency) {
+  return 100 / (frequency * std::log10(frequency));
+}
+
+void SimpleFourSidedReflectionEngine::reflect(
+    const core::Ray &reflected, float directionOffset,
+    core::CounterRandomStream *randomStream, ReflectedRays *output) const {
   std::optional<core::Vec3> parpendicularRandomVec3ToReflected =
-      getRandomParpendicularVec3ToReflected(reflected);
+      getRandomParpendicularVec3ToReflected(reflected, randomStream);
 
   if (!parpendicularRandomVec3ToReflected) {
     std::stringstream ss;
@@ -459,24 +628,67 @@ std::vector<core::Ray> SimpleFourSidedReflectionEngine::modelReflectedSoundWave(
       getParpendicularVec3ToRandomAndReflected(
           *parpendicularRandomVec3ToReflected, reflected);
 
-  std::vector<core::Vec3> offsets = {
+  const std::array<core::Vec3, 4> offsets = {
       directionOffset * *parpendicularRandomVec3ToReflected,
       -directionOffset * *parpendicularRandomVec3ToReflected,
       directionOffset * parpendicularVec3ToRandomAndReflected,
       -directionOffset * parpendicularVec3ToRandomAndReflected};
 
-  std::vector<core::Ray> output;
+  output->clear();
   for (const core::Vec3 &offset : offsets) {
-    output.push_back(core::Ray(reflected.origin(),
-                               reflected.direction() + offset,
-                               reflected.energy() / (offsets.size() + 1),
-                               reflected.accumulatedTime()));
+    output->push_back(core::Ray(reflected.origin(),
+                                reflected.direction() + offset,
+                                reflected.energy() / (offsets.size() + 1),
+                                reflected.accumulatedTime()));
   }
-  output.push_back(core::Ray(reflected.origin(), reflected.direction(),
-                             reflected.energy() / (offsets.size() + 1),
-                             reflected.accumulatedTime()));
+  output->push_back(core::Ray(reflected.origin(), reflected.direction(),
+                              reflected.energy() / (offsets.size() + 1),
+                              reflected.accumulatedTime()));
+}
 
-  return output;
+void StochasticFourSidedReflectionEngine::printItself(
+    std::ostream &os) const noexcept {
+  os << "Stochastic Four Sided Reflection Engine\n";
+}
+
+std::vector<core::Ray>
+StochasticFourSidedReflectionEngine::modelReflectedSoundWave(
+    const core::Ray &reflected, float frequency,
+    core::CounterRandomStream *randomStream) const {
+  ReflectedRays output;
+  StochasticFourSidedReflectionEngine::modelReflectedSoundWave(
+      reflected, frequency, randomStream, &output);
+  return std::vector<core::Ray>(output.begin(), output.end());
+}
+
+void StochasticFourSidedReflectionEngine::modelReflectedSoundWave(
+    const core::Ray &reflected, float frequency,
+    core::CounterRandomStream *randomStream, ReflectedRays *output) const {
+  SimpleFourSidedReflectionEngine::modelReflectedSoundWave(
+      reflected, frequency, randomStream, output);
+  chooseOne(reflected, randomStream, output);
+}
+
+void StochasticFourSidedReflectionEngine::modelReflectedSoundWaves(
+    const core::Ray *reflected, size_t numOfReflected, float frequency,
+    core::CounterRandomStream *randomStreams, ReflectedRays *output) const {
+  SimpleFourSidedReflectionEngine::modelReflectedSoundWaves(
+      reflected, numOfReflected, frequency, randomStreams, output);
+  for (size_t index = 0; index < numOfReflected; ++index) {
+    chooseOne(reflected[index], &randomStreams[index], &output[index]);
+  }
+}
+
+void StochasticFourSidedReflectionEngine::chooseOne(
+    const core::Ray &reflected, core::CounterRandomStream *randomStream,
+    ReflectedRays *reflection) {
+  // Child is drawn after the directions, so the chosen ray is always one of
+  // the rays SimpleFourSidedReflectionEngine returns for the same stream.
+  core::Ray chosen =
+      (*reflection)[randomStream->nextUint() % reflection->size()];
+  chosen.setEnergy(reflected.energy());
+  reflection->clear();
+  reflection->push_back(chosen);
 }
 
 void Simulator::printItself(std::ostream &os) const noexcept {
@@ -528,57 +740,277 @@ void Simulator::printItself(std::ostream &os) const noexcept {
   }
 }
 
-void Simulator::runRayTracing(float frequency, Collectors *collectors,
-                              const int maxTracking) const {
+TracingStatistics Simulator::runRayTracing(float frequency,
+                                           Collectors *collectors,
+                                           const int maxTracking) const {
+  TracingStatistics statistics;
+  statistics.depthLimit = maxTracking;
+  const collectionRules::CollectorIndex collectorIndex(*collectors);
+  reserveEnergy(collectors, maxTracking);
+
+  traceSource({frequency, maxTracking, collectors, &collectorIndex,
+               /*escapeEvents=*/nullptr, positionTracker_, &statistics});
+  return statistics;
+}
 
-  core::Ray currentRay;
-  while (source_->genRay(&currentRay)) {
-    positionTracker_->initializeNewTracking();
-    int currentTracking = 0;
-    performRayTracing(collectors, frequency, &currentRay, maxTracking,
-                      &currentTracking);
-    positionTracker_->endCurrentTracking();
+TracingStatistics
+Simulator::runRayTracingInParallel(float frequency, Collectors *collectors,
+                                   const int maxTracking,
+                                   core::ThreadPool *threadPool) const {
+  if (source_->numOfRays() == 0) {
+    return runRayTracing(frequency, collectors, maxTracking);
   }
+  return runRayTracingOnRange(frequency, collectors, maxTracking,
+                              /*firstRay=*/0, source_->numOfRays(),
+                              threadPool);
 }
 
-void Simulator::performRayTracing(Collectors *collectors, float frequency,
-                                  core::Ray *currentRay, int maxTracking,
-                                  int *currentTracking,
-                                  float accumulatedTime) const {
+TracingStatistics Simulator::runRayTracingOnRange(
+    float frequency, Collectors *collectors, const int maxTracking,
+    int firstRay, int lastRay, core::ThreadPool *threadPool) const {
+  if (threadPool == nullptr) {
+    TracingStatistics statistics;
+    statistics.depthLimit = maxTracking;
+    const collectionRules::CollectorIndex collectorIndex(*collectors);
+    reserveEnergy(collectors, maxTracking);
+    const TracingContext context{frequency,
+                                 maxTracking,
+                                 collectors,
+                                 &collectorIndex,
+                                 /*escapeEvents=*/nullptr,
+                                 positionTracker_,
+                                 &statistics};
+    withPolicies(positionTracker_, [&](const auto &simulator) {
+      simulator.traceRange(context, firstRay, lastRay);
+    });
+    return statistics;
+  }
 
-  // Ends tracking when current ray tracking reaches maximum number.
-  if (*currentTracking >= maxTracking) {
-    return;
+  const int numOfWorkers = threadPool->numOfThreads();
+  std::vector<Collectors> workerCollectors;
+  workerCollectors.reserve(numOfWorkers);
+  for (int worker = 0; worker < numOfWorkers; ++worker) {
+    workerCollectors.push_back(cloneEmptyCollectors(*collectors));
+    reserveEnergy(&workerCollectors.back(), maxTracking);
+  }
+  std::vector<TracingStatistics> workerStatistics(numOfWorkers);
+  // Only read by workers, so it is shared by all of them.
+  const collectionRules::CollectorIndex collectorIndex(*collectors);
+
+  auto contextOfChunk = [&](int chunk, int worker) {
+    return TracingContext{frequency,
+                          maxTracking,
+                          &workerCollectors[worker],
+                          &collectorIndex,
+                          /*escapeEvents=*/nullptr,
+                          /*positionTracker=*/nullptr,
+                          &workerStatistics[worker]};
+  };
+  traceSourceInChunks(threadPool, firstRay, lastRay, contextOfChunk);
+
+  TracingStatistics statistics;
+  statistics.depthLimit = maxTracking;
+  for (int worker = 0; worker < numOfWorkers; ++worker) {
+    addCollectedEnergy(workerCollectors[worker], collectors);
+    statistics.merge(workerStatistics[worker]);
   }
-  ++*currentTracking;
+  return statistics;
+}
+
+TracingStatistics
+Simulator::recordEscapeEvents(float frequency, const int maxTracking,
+                              EscapeEvents *escapeEvents,
+                              core::ThreadPool *threadPool) const {
+  TracingStatistics statistics;
+  statistics.depthLimit = maxTracking;
+  if (threadPool == nullptr || source_->numOfRays() == 0) {
+    traceSource({frequency, maxTracking, /*collectors=*/nullptr,
+                 /*collectorIndex=*/nullptr, escapeEvents, positionTracker_,
+                 &statistics});
+    return statistics;
+  }
+
+  // Every chunk records its own events, so they can be joined in the order
+  // of the rays of the source.
+  std::vector<EscapeEvents> chunkEscapeEvents(numOfChunks());
+  std::vector<TracingStatistics> workerStatistics(threadPool->numOfThreads());
+  auto contextOfChunk = [&](int chunk, int worker) {
+    return TracingContext{frequency,
+                          maxTracking,
+                          /*collectors=*/nullptr,
+                          /*collectorIndex=*/nullptr,
+                          &chunkEscapeEvents[chunk],
+                          /*positionTracker=*/nullptr,
+                          &workerStatistics[worker]};
+  };
+  traceSourceInChunks(threadPool, /*firstRay=*/0, source_->numOfRays(),
+                      contextOfChunk);
+
+  for (const EscapeEvents &events : chunkEscapeEvents) {
+    escapeEvents->insert(escapeEvents->end(), events.cbegin(), events.cend());
+  }
+  for (const TracingStatistics &workerStatistic : workerStatistics) {
+    statistics.merge(workerStatistic);
+  }
+  return statistics;
+}
 
-  RayTracer::TraceResult hitResult =
-      RayTracer::TraceResult::WENT_OUTSIDE_OF_SIMULATION_SPACE;
+void Simulator::collectEscapedEnergy(
+    const EscapeEvents &escapeEvents, const std::vector<float> &frequencies,
+    const std::vector<Collectors *> &collectorsPerBand) const {
+  if (collectorsPerBand.empty()) {
+    return;
+  }
+  const collectionRules::CollectorIndex collectorIndex(*collectorsPerBand[0]);
+  for (const EscapeEvent &event : escapeEvents) {
+    // Ray starts at the hit point, so the collision point is exactly the
+    // same as the one of the traced ray.
+    core::RayHitData hitData(
+        /*t=*/0, core::Vec3::kZ,
+        core::Ray(event.hitPoint, event.direction, event.energy),
+        frequencies.front(), event.accumulatedTime);
+    energyCollectionRules_->collectEnergyInBands(collectorsPerBand, frequencies,
+                                                 collectorIndex, hitData);
+  }
+}
 
-  core::RayHitData hitData;
-  hitData.accumulatedTime = accumulatedTime;
-  hitResult = tracer_->rayTrace(*currentRay, frequency, &hitData);
-  if (hitResult == RayTracer::TraceResult::HIT_TRIANGLE) {
-    positionTracker_->addNewPositionToCurrentTracking(hitData);
-    core::Ray reflected = tracer_->getReflected(&hitData);
-    std::vector<core::Ray> reflection =
-        reflectionEngine_->modelReflectedSoundWave(reflected, frequency);
+int Simulator::numOfChunks() const {
+  return (source_->numOfRays() + kRaysPerChunk - 1) / kRaysPerChunk;
+}
 
-    for (core::Ray &reflected : reflection) {
-      int temporaryTracking = *currentTracking;
-      performRayTracing(collectors, frequency, &reflected, maxTracking,
-                        &temporaryTracking, hitData.accumulatedTime);
+template <typename Function>
+void Simulator::withPolicies(
+    trackers::PositionTrackerInterface *positionTracker,
+    const Function &function) const {
+  using collectionRules::CollectEnergyInterface;
+  using collectionRules::LinearEnergyCollection;
+  using collectionRules::LinearEnergyCollectionWithPhaseImpact;
+  using collectionRules::NonLinearEnergyCollection;
+  auto withRules = [&](auto *source, auto *tracker, const auto *reflection) {
+    using Source = std::remove_pointer_t<decltype(source)>;
+    using Tracker = std::remove_pointer_t<decltype(tracker)>;
+    using Reflection =
+        std::remove_cv_t<std::remove_pointer_t<decltype(reflection)>>;
+    auto call = [&](auto *rules) {
+      using Rules = std::remove_pointer_t<decltype(rules)>;
+      function(PolicySimulator<Source, Tracker, Rules, Reflection>(
+          tracer_, &sphereWall_, source, tracker, rules, reflection, seed_,
+          energyCutoff_, russianRoulette_));
+    };
+    const std::type_info &rulesType = typeid(*energyCollectionRules_);
+    if (rulesType == typeid(LinearEnergyCollection)) {
+      call(static_cast<LinearEnergyCollection *>(energyCollectionRules_));
+    } else if (rulesType == typeid(LinearEnergyCollectionWithPhaseImpact)) {
+      call(static_cast<LinearEnergyCollectionWithPhaseImpact *>(
+          energyCollectionRules_));
+    } else if (rulesType == typeid(NonLinearEnergyCollection)) {
+      call(static_cast<NonLinearEnergyCollection *>(energyCollectionRules_));
+    } else {
+      call(static_cast<CollectEnergyInterface *>(energyCollectionRules_));
+    }
+  };
+  auto withReflection = [&](auto *source, auto *tracker) {
+    const std::type_info &reflectionType = typeid(*reflectionEngine_);
+    if (reflectionType == typeid(SimpleFourSidedReflectionEngine)) {
+      withRules(source, tracker,
+                static_cast<const SimpleFourSidedReflectionEngine *>(
+                    reflectionEngine_));
+    } else if (reflectionType == typeid(StochasticFourSidedReflectionEngine)) {
+      withRules(source, tracker,
+                static_cast<const StochasticFourSidedReflectionEngine *>(
+                    reflectionEngine_));
+    } else {
+      withRules(source, tracker,
+                static_cast<const ReflectionEngineInterface *>(
+                    reflectionEngine_));
     }
+  };
+  auto withTracker = [&](auto *source) {
+    if (typeid(*positionTracker) == typeid(trackers::FakePositionTracker)) {
+      withReflection(source, static_cast<trackers::FakePositionTracker *>(
+                                 positionTracker));
+    } else {
+      withReflection(source, positionTracker);
+    }
+  };
+  if (typeid(*source_) == typeid(generators::PointSpeakerRayFactory)) {
+    withTracker(static_cast<generators::PointSpeakerRayFactory *>(source_));
+  } else {
+    withTracker(source_);
+  }
+}
 
-  } else if (hitResult ==
-                 RayTracer::TraceResult::WENT_OUTSIDE_OF_SIMULATION_SPACE &&
-             sphereWall_.hitObject(*currentRay, frequency, &hitData)) {
+void Simulator::traceSource(const TracingContext &context) const {
+  withPolicies(context.positionTracker, [&](const auto &simulator) {
+    simulator.traceSource(context);
+  });
+}
 
-    positionTracker_->addNewPositionToCurrentTracking(hitData);
-    hitData.accumulatedTime += hitData.time / constants::kSoundSpeed;
-    energyCollectionRules_->collectEnergy(*collectors, &hitData);
+void Simulator::traceSourceInChunks(
+    core::ThreadPool *threadPool, int firstRay, int lastRay,
+    const std::function<TracingContext(int chunk, int worker)> &contextOfChunk)
+    const {
+  const int numOfWorkers = threadPool->numOfThreads();
+  const int chunks = (lastRay - firstRay + kRaysPerChunk - 1) / kRaysPerChunk;
+
+  threadPool->parallelFor(numOfWorkers, [&](size_t worker) {
+    trackers::FakePositionTracker positionTracker;
+    withPolicies(&positionTracker, [&](const auto &simulator) {
+      for (int chunk = worker; chunk < chunks; chunk += numOfWorkers) {
+        TracingContext context = contextOfChunk(chunk, worker);
+        context.positionTracker = &positionTracker;
+        const int firstChunkRay = firstRay + chunk * kRaysPerChunk;
+        const int lastChunkRay =
+            std::min(lastRay, firstChunkRay + kRaysPerChunk);
+        simulator.traceRange(context, firstChunkRay, lastChunkRay);
+      }
+    });
+  });
+}
+
+void Simulator::performRayTracing(Collectors *collectors, float frequency,
+                                  core::Ray *currentRay, int maxTracking,
+                                  int *currentTracking,
+                                  float accumulatedTime) const {
+  TracingStatistics statistics;
+  const TracingContext context{frequency,
+                               maxTracking,
+                               collectors,
+                               /*collectorIndex=*/nullptr,
+                               /*escapeEvents=*/nullptr,
+                               positionTracker_,
+                               &statistics};
+  withPolicies(positionTracker_, [&](const auto &simulator) {
+    simulator.performRayTracing(context, currentRay, /*sourceRayIndex=*/0,
+                                currentTracking, accumulatedTime);
+  });
+}
+
+float Simulator::maxArrivalTime(int maxTracking) const {
+  return (maxTracking + 1) * 2 * sphereWall_.getRadius() /
+         constants::kSoundSpeed;
+}
+
+void Simulator::reserveEnergy(Collectors *collectors, int maxTracking) const {
+  const float maxTime = std::min(maxArrivalTime(maxTracking),
+                                 kMaxPreallocatedTime);
+  for (auto &collector : *collectors) {
+    collector->reserveEnergy(maxTime);
   }
 }
+
+void Simulator::setEnergyCutoff(float energyCutoff, bool russianRoulette) {
+  if (!(energyCutoff >= 0 && energyCutoff < 1)) {
+    std::stringstream ss;
+    ss << "Error in: " << *this << "\n"
+       << "Energy cutoff must be in range [0, 1)! Given energy cutoff: "
+       << energyCutoff;
+    throw std::invalid_argument(ss.str());
+  }
+  energyCutoff_ = energyCutoff;
+  russianRoulette_ = russianRoulette;
+}
+
 void Simulator::setSphereWall(const objects::SphereWall &sphereWall) {
   sphereWall_ = sphereWall;
 }
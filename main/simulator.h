@@ -2,19 +2,30 @@
 #define SIMULATOR_H
 
 #include "core/classUtlilities.h"
+#include "core/counterRandom.h"
+#include "core/threadPool.h"
+#include "main/collectorIndex.h"
 #include "main/rayTracer.h"
 #include "main/trackers.h"
 #include "nlohmann/json.hpp"
 #include "obj/generators.h"
 #include "obj/objects.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string_view>
+#include <type_traits>
+#include <typeinfo>
 #include <unordered_map>
 #include <vector>
 
@@ -25,32 +36,128 @@ using Energies = std::vector<EnergyPerTime>;
 
 namespace collectionRules {
 
-// defines how energy collectors collect energy in the simulation
+// defines how energy collectors collect energy in the simulation. Energy is
+// collected in frequency bands: the same ray carries its energy in up to
+// |kBandWidth| bands at once, so geometry is calculated once for all of them.
 struct CollectEnergyInterface : public Printable {
+  static constexpr int kBandWidth = 16;
+
+  // Puts energy into every collector that contains hit position.
   virtual void collectEnergy(const Collectors &collectors,
-                             core::RayHitData *hitData) = 0;
+                             core::RayHitData *hitData);
+  // Works the same, but checks only candidates returned by |index|, which
+  // must be built from the collectors at the same positions as |collectors|.
+  void collectEnergy(const Collectors &collectors, const CollectorIndex &index,
+                     core::RayHitData *hitData);
+  // Collects energy of the ray described by |hitData| in every band at once.
+  // |collectorsPerBand[band]| collect energy at |frequencies[band]| and must
+  // be placed like the collectors used to build |index|. Frequency of the
+  // |hitData| is ignored.
+  void collectEnergyInBands(const std::vector<Collectors *> &collectorsPerBand,
+                            const std::vector<float> &frequencies,
+                            const CollectorIndex &index,
+                            const core::RayHitData &hitData);
   void printItself(std::ostream &os) const noexcept override;
+
+  // Hooks of the rules are public, so that PolicySimulator calls them
+  // directly on the final rules classes.
+
+  // Fills |rayEnergies| with energy, that the ray described by |hitData|
+  // carries at each of |numOfBands| |frequencies|. By default energy is the
+  // same in every band.
+  virtual void rayEnergiesInBands(const core::RayHitData &hitData,
+                                  const float *frequencies, int numOfBands,
+                                  float *rayEnergies) const;
+  // Fills |collected| with energy put into the |collector| in each of
+  // |numOfBands| bands by the ray, which carries |rayEnergies| and reached
+  // position at |distanceToOrigin| from the origin of the |collector|.
+  virtual void collectedEnergyInBands(const objects::EnergyCollector &collector,
+                                      float distanceToOrigin,
+                                      const float *rayEnergies, int numOfBands,
+                                      float *collected) const = 0;
+
+private:
+  // Collects energy in up to |kBandWidth| bands with collectEnergyWithHooks()
+  // and virtual hooks.
+  void collectEnergyInBands(const Collectors *const *collectorsPerBand,
+                            const float *frequencies, int numOfBands,
+                            const std::vector<uint32_t> *candidates,
+                            const core::Vec3 &reachedPosition,
+                            const core::RayHitData &hitData) const;
 };
 
+// Collects energy of the ray described by |hitData|, which reached
+// |reachedPosition|, in up to CollectEnergyInterface::kBandWidth bands.
+// |collectorsPerBand[band]| collect energy at |frequencies[band]|.
+// |candidates| are indices of collectors that may contain |reachedPosition|,
+// all collectors are checked when it is nullptr. |rayEnergiesInBands| and
+// |collectedEnergyInBands| take arguments of the hooks of
+// CollectEnergyInterface with the same names, so that callers decide how the
+// hooks are bound.
+template <typename RayEnergiesInBands, typename CollectedEnergyInBands>
+void collectEnergyWithHooks(
+    const Collectors *const *collectorsPerBand, const float *frequencies,
+    int numOfBands, const std::vector<uint32_t> *candidates,
+    const core::Vec3 &reachedPosition, const core::RayHitData &hitData,
+    const RayEnergiesInBands &rayEnergiesInBands,
+    const CollectedEnergyInBands &collectedEnergyInBands) {
+  alignas(32) float rayEnergies[CollectEnergyInterface::kBandWidth];
+  alignas(32) float collected[CollectEnergyInterface::kBandWidth];
+  bool rayEnergiesReady = false;
+
+  // Collectors of every band are placed the same way, so geometry is taken
+  // from the first band.
+  const Collectors &collectors = *collectorsPerBand[0];
+  const size_t numOfCandidates =
+      candidates != nullptr ? candidates->size() : collectors.size();
+  for (size_t candidate = 0; candidate < numOfCandidates; ++candidate) {
+    const uint32_t collectorIndex =
+        candidates != nullptr ? (*candidates)[candidate] : candidate;
+    const objects::EnergyCollector &collector = *collectors[collectorIndex];
+    float distanceToOrigin =
+        (collector.getOrigin() - reachedPosition).magnitude();
+    if (!(distanceToOrigin <= collector.getRadius())) {
+      continue;
+    }
+    // Energies are calculated only for rays that reached any collector.
+    if (!rayEnergiesReady) {
+      rayEnergiesInBands(hitData, frequencies, numOfBands, rayEnergies);
+      rayEnergiesReady = true;
+    }
+    collectedEnergyInBands(collector, distanceToOrigin, rayEnergies,
+                           numOfBands, collected);
+    for (int band = 0; band < numOfBands; ++band) {
+      (*collectorsPerBand[band])[collectorIndex]->addEnergy(
+          hitData.accumulatedTime, collected[band]);
+    }
+  }
+}
+
 // The futher away from origin of energy collectors ray hits, the less energy it
 // puts in the energy collector - left energy scales lineary. When distanece
 // betwen hit position and energyCollector origin is equal or bigger then radius
 // of the energyCollector, none energy is put inside the energy Collector. Phase
 // impact of the wave is not considered here.
-struct LinearEnergyCollection : public CollectEnergyInterface {
-  void collectEnergy(const Collectors &collectors,
-                     core::RayHitData *hitData) override;
+struct LinearEnergyCollection final : public CollectEnergyInterface {
   void printItself(std::ostream &os) const noexcept override;
+  void collectedEnergyInBands(const objects::EnergyCollector &collector,
+                              float distanceToOrigin, const float *rayEnergies,
+                              int numOfBands, float *collected) const override;
 };
 
 // Rules of collection are exactly the same as in LinearEnergyCollection, but in
 // addition energy is multiplied by cos(phase), where phase represents wave
 // phase at hit position.
-struct LinearEnergyCollectionWithPhaseImpact : public CollectEnergyInterface {
-  void collectEnergy(const Collectors &collectors,
-                     core::RayHitData *hitData) override;
-
+struct LinearEnergyCollectionWithPhaseImpact final
+    : public CollectEnergyInterface {
   void printItself(std::ostream &os) const noexcept override;
+  // Energy in each band is multiplied by cos(phase) of the wave in the band.
+  void rayEnergiesInBands(const core::RayHitData &hitData,
+                          const float *frequencies, int numOfBands,
+                          float *rayEnergies) const override;
+  void collectedEnergyInBands(const objects::EnergyCollector &collector,
+                              float distanceToOrigin, const float *rayEnergies,
+                              int numOfBands, float *collected) const override;
 };
 
 // Energy collection based on the "Optimizing diffusive surface topology through
@@ -60,10 +167,11 @@ struct LinearEnergyCollectionWithPhaseImpact : public CollectEnergyInterface {
 // soundIntensity = energyPerRay * distanceFactor / EnergyCollectorVolume,
 // where distance factor is:
 // distanceFactor = 2 * sqrt(collectorRadius^2 - distanceToOrigin^2)
-struct NonLinearEnergyCollection : public CollectEnergyInterface {
-  void collectEnergy(const Collectors &collectors,
-                     core::RayHitData *hitData) override;
+struct NonLinearEnergyCollection final : public CollectEnergyInterface {
   void printItself(std::ostream &os) const noexcept override;
+  void collectedEnergyInBands(const objects::EnergyCollector &collector,
+                              float distanceToOrigin, const float *rayEnergies,
+                              int numOfBands, float *collected) const override;
 };
 // TODO: Create Combined Rules of collection
 // TODO: Add time factor to the collected energy
@@ -132,6 +240,14 @@ private:
                      std::vector<core::Vec3> pointList) const;
 };
 
+// Returns collectors placed at the same positions as |collectors|, but
+// without any collected energy.
+Collectors cloneEmptyCollectors(const Collectors &collectors);
+
+// Adds energy collected by every collector from |source| to the collector at
+// the same index in |destination|. Both must have the same size.
+void addCollectedEnergy(const Collectors &source, Collectors *destination);
+
 // Saves positions of the energyCollectors to the Json file at given path.
 void exportCollectorsToJson(const Collectors &energyCollectors,
                             std::string_view path);
@@ -141,11 +257,58 @@ void exportCollectorsToJson(const Collectors &energyCollectors,
 // object.
 const float getSphereWallRadius(const ModelInterface &model);
 
+// Rays created by the reflection of a single ray. Rays are stored in place,
+// so filling the buffer never allocates memory.
+class ReflectedRays {
+public:
+  static constexpr size_t kCapacity = 8;
+
+  // Throws std::length_error when buffer already holds |kCapacity| rays.
+  void push_back(const core::Ray &ray);
+  void clear() { size_ = 0; }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  core::Ray &operator[](size_t index) { return rays_[index]; }
+  const core::Ray &operator[](size_t index) const { return rays_[index]; }
+  const core::Ray *begin() const { return rays_.data(); }
+  const core::Ray *end() const { return rays_.data() + size_; }
+
+private:
+  std::array<core::Ray, kCapacity> rays_;
+  size_t size_ = 0;
+};
+
 // Defines how sound is reflecting from the structure
 struct ReflectionEngineInterface : public Printable {
   virtual std::vector<core::Ray>
   modelReflectedSoundWave(const core::Ray &reflected,
                           float frequency) const = 0;
+  // Engines that need random numbers should draw them from |randomStream|,
+  // which is unique for every reflection in the simulation, so results are
+  // reproducible in any thread. By default |randomStream| is ignored.
+  virtual std::vector<core::Ray>
+  modelReflectedSoundWave(const core::Ray &reflected, float frequency,
+                          core::CounterRandomStream * /*randomStream*/) const {
+    return modelReflectedSoundWave(reflected, frequency);
+  }
+  // Simulator calls this version. Replaces content of |output| with the same
+  // rays as the version above. By default rays of the version above are
+  // copied, engines override it to reflect rays without memory allocation.
+  virtual void modelReflectedSoundWave(const core::Ray &reflected,
+                                       float frequency,
+                                       core::CounterRandomStream *randomStream,
+                                       ReflectedRays *output) const;
+  // Reflects |numOfReflected| rays at once. Ray |reflected|[i] draws random
+  // numbers from |randomStreams|[i] and its rays are saved in |output|[i].
+  virtual void
+  modelReflectedSoundWaves(const core::Ray *reflected, size_t numOfReflected,
+                           float frequency,
+                           core::CounterRandomStream *randomStreams,
+                           ReflectedRays *output) const;
+  // Returns false when reflected rays do not depend on the frequency, so paths
+  // traced for one frequency are the same for all of them.
+  virtual bool isFrequencyDependent() const { return true; }
   void printItself(std::ostream &os) const noexcept override;
 };
 
@@ -153,20 +316,40 @@ struct FakeReflectionEngine : public ReflectionEngineInterface {
   std::vector<core::Ray>
   modelReflectedSoundWave(const core::Ray &reflected,
                           float frequency) const override;
+  bool isFrequencyDependent() const override { return false; }
   void printItself(std::ostream &os) const noexcept override;
 };
 
 // returns 4 offside reflection ot every axis on both parpendicular directions
 // to the reflected Ray
 struct SimpleFourSidedReflectionEngine : public ReflectionEngineInterface {
+  // Draws random numbers from stream seeded with |randomEngine_|.
   std::vector<core::Ray>
   modelReflectedSoundWave(const core::Ray &reflected,
                           float frequency) const override;
+  std::vector<core::Ray>
+  modelReflectedSoundWave(const core::Ray &reflected, float frequency,
+                          core::CounterRandomStream *randomStream) const override;
+  void modelReflectedSoundWave(const core::Ray &reflected, float frequency,
+                               core::CounterRandomStream *randomStream,
+                               ReflectedRays *output) const override;
+  // Offset of directions depends only on the |frequency|, so it is calculated
+  // once for the whole batch.
+  void modelReflectedSoundWaves(const core::Ray *reflected,
+                                size_t numOfReflected, float frequency,
+                                core::CounterRandomStream *randomStreams,
+                                ReflectedRays *output) const override;
   void printItself(std::ostream &os) const noexcept override;
 
 private:
+  static float directionOffset(float frequency);
+  void reflect(const core::Ray &reflected, float directionOffset,
+               core::CounterRandomStream *randomStream,
+               ReflectedRays *output) const;
+
   std::optional<core::Vec3>
-  getRandomParpendicularVec3ToReflected(const core::Ray &reflected) const;
+  getRandomParpendicularVec3ToReflected(
+      const core::Ray &reflected, core::CounterRandomStream *randomStream) const;
   core::Vec3
   getParpendicularVec3ToRandomAndReflected(const core::Vec3 &random,
                                            const core::Ray &reflected) const;
@@ -174,7 +357,93 @@ private:
   RandomEngine randomEngine_;
 };
 
-// Performs ray-tracing simulation on given model.
+// Monte Carlo version of the SimpleFourSidedReflectionEngine. Instead of all
+// five rays, returns one of them chosen at random, carrying the whole energy
+// of the reflected ray. Expected collected energy is the same, but number of
+// traced rays grows linearly with the depth instead of 5^depth, so variance
+// has to be paid for with more source rays.
+struct StochasticFourSidedReflectionEngine
+    : public SimpleFourSidedReflectionEngine {
+  using SimpleFourSidedReflectionEngine::modelReflectedSoundWave;
+  std::vector<core::Ray>
+  modelReflectedSoundWave(const core::Ray &reflected, float frequency,
+                          core::CounterRandomStream *randomStream) const override;
+  void modelReflectedSoundWave(const core::Ray &reflected, float frequency,
+                               core::CounterRandomStream *randomStream,
+                               ReflectedRays *output) const override;
+  void modelReflectedSoundWaves(const core::Ray *reflected,
+                                size_t numOfReflected, float frequency,
+                                core::CounterRandomStream *randomStreams,
+                                ReflectedRays *output) const override;
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  // Keeps one of |reflection| rays chosen with |randomStream|.
+  static void chooseOne(const core::Ray &reflected,
+                        core::CounterRandomStream *randomStream,
+                        ReflectedRays *reflection);
+};
+
+// Ray waiting to be traced by Simulator. |depth| is the number of
+// reflections that occurred before the |ray| was created, |pathId|
+// identifies sequence of reflections that created the |ray|.
+struct PendingRay {
+  core::Ray ray;
+  int depth;
+  float accumulatedTime;
+  uint64_t pathId;
+};
+
+// Ray that reached the sphere wall. Keeps everything that collection rules need
+// to collect its energy at any frequency: |hitPoint| on the sphere wall,
+// |direction| and |energy| of the ray and |accumulatedTime| [s] in which it
+// got there from the source.
+struct EscapeEvent {
+  core::Vec3 hitPoint;
+  core::Vec3 direction;
+  float accumulatedTime;
+  float energy;
+};
+using EscapeEvents = std::vector<EscapeEvent>;
+
+// Describes depth and memory used by the ray tracing of single run.
+// |depthLimit| is the maximum tracking allowed in the run, |maxReachedDepth|
+// the deepest tracking that actually occurred and |maxPendingRays| the
+// high-water mark of the stack of rays waiting to be traced.
+// |emittedEnergy| is the energy of all source rays, |discardedEnergy| the
+// energy of |discardedRays| terminated below the energy cutoff and
+// |energyAtDepthLimit| the energy of rays that were still travelling when
+// |depthLimit| was reached.
+struct TracingStatistics : public Printable {
+  int depthLimit = 0;
+  int maxReachedDepth = 0;
+  size_t maxPendingRays = 0;
+  double emittedEnergy = 0;
+  double discardedEnergy = 0;
+  size_t discardedRays = 0;
+  double energyAtDepthLimit = 0;
+
+  // Keeps maximum of depths and sizes and sums energies.
+  void merge(const TracingStatistics &other);
+  size_t maxPendingRaysBytes() const;
+  void printItself(std::ostream &os) const noexcept override;
+};
+
+// Everything that stays the same while rays of single run are traced.
+struct TracingContext {
+  float frequency;
+  int maxTracking;
+  Collectors *collectors;
+  // When nullptr, every collector is checked for every escaping ray.
+  const collectionRules::CollectorIndex *collectorIndex;
+  // When not nullptr, escaping rays are recorded here instead of collected.
+  EscapeEvents *escapeEvents;
+  trackers::PositionTrackerInterface *positionTracker;
+  TracingStatistics *statistics;
+};
+
+// Performs ray-tracing simulation on given model. Rays are traced by
+// PolicySimulator, see policySimulator.h.
 class Simulator : public Printable {
 public:
   Simulator(RayTracer *tracer, ModelInterface *model,
@@ -192,16 +461,100 @@ public:
   [[deprecated("Replaced by runRayTracing()")]] void
   run(float frequency, Collectors *collectors, const int maxTracking);
 
-  void runRayTracing(float frequency, Collectors *collectors,
-                     const int maxTracking) const;
-
+  // Energy of rays that left the model is collected only by collectors
+  // found in CollectorIndex built once for the whole run.
+  TracingStatistics runRayTracing(float frequency, Collectors *collectors,
+                                  const int maxTracking) const;
+
+  // Traces rays of the source in chunks of |kRaysPerChunk| rays distributed
+  // over threads of the |threadPool|. Chunk with index i is traced by worker
+  // i % threadPool->numOfThreads(), which collects energy into its own empty
+  // copy of the |collectors|. Copies are added to |collectors| in worker
+  // order, so results are exactly the same for the same number of threads.
+  // Positions are not tracked. Falls back to runRayTracing() if rays of the source
+  // cannot be accessed by index.
+  TracingStatistics runRayTracingInParallel(float frequency,
+                                            Collectors *collectors,
+                                            const int maxTracking,
+                                            core::ThreadPool *threadPool) const;
+
+  // Traces only rays of the source with indices in range [|firstRay|,
+  // |lastRay|). Tracing consecutive ranges of the source one after another
+  // gives exactly the same results as runRayTracing(). With |threadPool| rays
+  // are traced like in runRayTracingInParallel(), but chunks are counted from
+  // |firstRay|. Rays of the source must be accessible by index.
+  TracingStatistics runRayTracingOnRange(float frequency,
+                                         Collectors *collectors,
+                                         const int maxTracking, int firstRay,
+                                         int lastRay,
+                                         core::ThreadPool *threadPool =
+                                             nullptr) const;
+
+  // Traces rays of the source like runRayTracing(), but instead of collecting
+  // energy appends every ray that reached the sphere wall to |escapeEvents|,
+  // in the order of the rays of the source. Used when paths of the rays do
+  // not depend on frequency, so they can be traced once for all frequencies.
+  // If |threadPool| is given, rays are traced in chunks like in
+  // runRayTracingInParallel() and positions are not tracked.
+  TracingStatistics recordEscapeEvents(float frequency, const int maxTracking,
+                                       EscapeEvents *escapeEvents,
+                                       core::ThreadPool *threadPool = nullptr) const;
+  // Collects energy of rays recorded by recordEscapeEvents() in many bands at
+  // once. |collectorsPerBand[band]| collect energy, as if the rays were traced
+  // at |frequencies[band]|.
+  void collectEscapedEnergy(const EscapeEvents &escapeEvents,
+                            const std::vector<float> &frequencies,
+                            const std::vector<Collectors *> &collectorsPerBand) const;
+
+  // Traces |currentRay| and all of its reflections in depth-first order with
+  // explicit stack of pending rays, so the call stack does not grow with
+  // |maxTracking|.
   void performRayTracing(Collectors *collectors, float frequency,
                          core::Ray *currentRay, int maxTracking,
                          int *currentTracking, float accumulatedTime = 0) const;
   void printItself(std::ostream &os) const noexcept override;
   void setSphereWall(const objects::SphereWall &sphereWall);
+  // Seed of random numbers given to the reflection engine. The same seed
+  // gives the same results regardless of the number of threads.
+  void setSeed(uint64_t seed) { seed_ = seed; }
+  // Reflected rays carrying less than |energyCutoff| of the energy of their
+  // source ray are terminated. With |russianRoulette| they survive with
+  // probability equal to their energy divided by the cutoff energy and carry
+  // exactly the cutoff energy, so the expected collected energy does not
+  // change. Otherwise all of them are discarded. Cutoff equal to zero
+  // disables termination.
+  void setEnergyCutoff(float energyCutoff, bool russianRoulette = true);
+
+  static constexpr int kRaysPerChunk = 64;
+  // Upper limit of time [s] for which collectors preallocate their energy
+  // histograms. Energy that arrives later is still collected.
+  static constexpr float kMaxPreallocatedTime = 1;
 
 private:
+  // Calls |function| with PolicySimulator, whose policies are the dynamic
+  // types of the source, reflection engine and |positionTracker|, when
+  // PolicySimulator is instantiated for them, or their interfaces otherwise.
+  template <typename Function>
+  void withPolicies(trackers::PositionTrackerInterface *positionTracker,
+                    const Function &function) const;
+
+  // Traces every ray of the source one after another.
+  void traceSource(const TracingContext &context) const;
+  // Traces rays of the source with indices in range [|firstRay|, |lastRay|)
+  // in chunks distributed over threads of the |threadPool|. |contextOfChunk|
+  // returns context in which rays of the chunk with given index are traced by
+  // the worker with given index.
+  void traceSourceInChunks(
+      core::ThreadPool *threadPool, int firstRay, int lastRay,
+      const std::function<TracingContext(int chunk, int worker)>
+          &contextOfChunk) const;
+  int numOfChunks() const;
+
+  // Returns time [s] after which no ray can reach the sphere wall: every ray
+  // travels at most the sphere wall diameter between two reflections.
+  float maxArrivalTime(int maxTracking) const;
+  void reserveEnergy(Collectors *collectors, int maxTracking) const;
+
   RayTracer *tracer_;
   ModelInterface *model_;
   generators::RayFactory *source_;
@@ -212,6 +565,9 @@ private:
 
   ReflectionEngineInterface *reflectionEngine_;
   objects::SphereWall sphereWall_;
+  uint64_t seed_ = 0;
+  float energyCutoff_ = 0;
+  bool russianRoulette_ = true;
 };
 
 #endif
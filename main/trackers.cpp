@@ -16,6 +16,7 @@ void ResultTracker::saveRaport(std::string path) const {
   File resultJS(path);
   resultJS.openFileWithOverwrite();
   resultJS.write(jsVariable);
+  resultJS.flush();
 }
 
 const Json ResultTracker::generateRaport() {
@@ -61,37 +62,170 @@ void FileInterface::printItself(std::ostream &os) const noexcept {
   os << "File Interface class \n";
 }
 
+AsyncFileWriter::AsyncFileWriter(size_t bufferSize)
+    : bufferSize_(bufferSize), thread_(&AsyncFileWriter::writeLoop, this) {}
+
+AsyncFileWriter::~AsyncFileWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  appended_.notify_one();
+  thread_.join();
+  if (error_) {
+    try {
+      std::rethrow_exception(error_);
+    } catch (const std::exception &e) {
+      std::cout << "WARNING! \n" << e.what() << "\n";
+    }
+  }
+}
+
+AsyncFileWriter &AsyncFileWriter::instance() {
+  static AsyncFileWriter writer;
+  return writer;
+}
+
+void AsyncFileWriter::append(std::string_view path, std::string data) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (bufferedBytes_ >= bufferSize_) {
+    const auto start = std::chrono::steady_clock::now();
+    written_.wait(lock, [this] { return bufferedBytes_ < bufferSize_; });
+    ++statistics_.numOfBlockedAppends;
+    statistics_.blockedSeconds += std::chrono::duration<double>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count();
+  }
+  bufferedBytes_ += data.size();
+  buffer_.push_back({std::string(path), std::move(data)});
+  ++statistics_.numOfAppends;
+  statistics_.maxBufferedBytes =
+      std::max(statistics_.maxBufferedBytes, bufferedBytes_);
+  lock.unlock();
+  appended_.notify_one();
+}
+
+void AsyncFileWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  written_.wait(lock, [this] { return buffer_.empty() && !writing_; });
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+AsyncFileWriter::Statistics AsyncFileWriter::statistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+void AsyncFileWriter::printItself(std::ostream &os) const noexcept {
+  const Statistics current = statistics();
+  os << "Async File Writer\n"
+     << "\tappends: " << current.numOfAppends << "\n"
+     << "\twritten bytes: " << current.writtenBytes << "\n"
+     << "\tmax buffered bytes: " << current.maxBufferedBytes << " / "
+     << bufferSize_ << "\n"
+     << "\tblocked appends: " << current.numOfBlockedAppends << ", for "
+     << current.blockedSeconds << " s\n";
+}
+
+void AsyncFileWriter::writeLoop() {
+  std::vector<Append> appends;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      appended_.wait(lock, [this] { return stop_ || !buffer_.empty(); });
+      if (buffer_.empty()) {
+        return;
+      }
+      appends.swap(buffer_);
+      bufferedBytes_ = 0;
+      writing_ = true;
+    }
+    // Appending threads fill the other buffer now.
+    written_.notify_all();
+
+    size_t writtenBytes = 0;
+    std::exception_ptr error;
+    try {
+      // Consecutive appends usually go to the same file.
+      std::ofstream file;
+      std::string_view openedPath;
+      for (const Append &current : appends) {
+        if (current.path != openedPath) {
+          file.close();
+          file.open(current.path, std::ios_base::app);
+          openedPath = current.path;
+        }
+        file.write(current.data.data(), current.data.size());
+        if (!file.good()) {
+          std::stringstream ss;
+          ss << "Data could not be written to file at: " << current.path;
+          throw std::invalid_argument(ss.str());
+        }
+        writtenBytes += current.data.size();
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    appends.clear();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      writing_ = false;
+      statistics_.writtenBytes += writtenBytes;
+      if (error) {
+        error_ = error;
+      }
+    }
+    written_.notify_all();
+  }
+}
+
 void File::openFileWithOverwrite() {
-  std::cout << "File opened with overwrite at: " << path_ << std::endl;
-  fileStream_.open(path_.data());
-  handleErrors();
+  // Data appended before must not be written after the file is truncated.
+  flush();
+  std::ofstream fileStream(path_.data());
+  handleErrors(fileStream);
+  opened_ = true;
 }
 
 void File::open() {
-  std::cout << "File opened at: " << path_ << std::endl;
-  fileStream_.open(path_.data(), std::ios_base::app);
-  handleErrors();
+  std::ofstream fileStream(path_.data(), std::ios_base::app);
+  handleErrors(fileStream);
+  opened_ = true;
 }
 
 void File::write(const FileBuffer &buffer) {
-  if (!fileStream_.is_open()) {
+  if (!opened_) {
     open();
   }
-  fileStream_ << buffer.stream.rdbuf() << std::endl;
+  std::string data(std::istreambuf_iterator<char>(buffer.stream.rdbuf()), {});
+  data += '\n';
+  writer_->append(path_, std::move(data));
 }
 
 void File::writeWithoutFlush(const FileBuffer &buffer) {
-  fileStream_ << buffer.stream.rdbuf();
+  writer_->append(path_, std::string(std::istreambuf_iterator<char>(
+                                         buffer.stream.rdbuf()),
+                                     {}));
 }
 
+void File::flush() { writer_->flush(); }
+
 void File::printItself(std::ostream &os) const noexcept {
   os << "File at given path: " << path_ << "\n";
 }
 
-void File::setPath(std::string_view path) { path_ = path.data(); }
+void File::setPath(std::string_view path) {
+  path_ = path.data();
+  opened_ = false;
+}
 
-void File::handleErrors() {
-  if (!fileStream_.good()) {
+void File::handleErrors(const std::ofstream &fileStream) {
+  if (!fileStream.good()) {
     std::stringstream errorStream;
     errorStream << "Error in: " << *this << "File doesn't exist at given path!";
     throw std::invalid_argument(errorStream.str());
@@ -170,6 +304,8 @@ void endSimulation() {
   File file("./server/data/loading.js");
   file.openFileWithOverwrite();
   file.write(buffer);
+  file.flush();
+  std::cout << AsyncFileWriter::instance() << std::endl;
 }
 
 void DataExporter::saveResultsAsJson(std::string_view path,
@@ -210,6 +346,7 @@ void DataExporter::saveResultsAsJson(std::string_view path,
   fileBuffer.acquireJsonFile(outputArray);
   javascript::endLineInBuffer(fileBuffer);
   file.write(fileBuffer);
+  file.flush();
 }
 
 void DataExporter::saveModelToJson(std::string_view pathToFolder,
@@ -239,6 +376,7 @@ void DataExporter::saveModelToJson(std::string_view pathToFolder,
 
   javascript::endLineInBuffer(buffer);
   file.write(buffer);
+  file.flush();
 }
 
 void DataExporter::printItself(std::ostream &os) const noexcept {
@@ -268,6 +406,57 @@ void FakePositionTracker::printItself(std::ostream &os) const noexcept {
   os << "Fake Position Tracker\n";
 }
 
+void BufferedPositionTracker::initializeNewFrequency(float frequency) {
+  events_.push_back({EventType::kNewFrequency, frequency, 0});
+}
+
+void BufferedPositionTracker::initializeNewTracking() {
+  events_.push_back({EventType::kNewTracking, 0, 0});
+}
+
+void BufferedPositionTracker::addNewPositionToCurrentTracking(
+    const core::RayHitData &hitData) {
+  events_.push_back({EventType::kNewPosition, 0, positions_.size()});
+  positions_.push_back(hitData);
+}
+
+void BufferedPositionTracker::endCurrentFrequency() {
+  events_.push_back({EventType::kEndFrequency, 0, 0});
+}
+
+void BufferedPositionTracker::endCurrentTracking() {
+  events_.push_back({EventType::kEndTracking, 0, 0});
+}
+
+void BufferedPositionTracker::replay(PositionTrackerInterface *tracker) {
+  for (const Event &event : events_) {
+    switch (event.type) {
+    case EventType::kNewFrequency:
+      tracker->initializeNewFrequency(event.frequency);
+      break;
+    case EventType::kNewTracking:
+      tracker->initializeNewTracking();
+      break;
+    case EventType::kNewPosition:
+      tracker->addNewPositionToCurrentTracking(positions_[event.positionIndex]);
+      break;
+    case EventType::kEndFrequency:
+      tracker->endCurrentFrequency();
+      break;
+    case EventType::kEndTracking:
+      tracker->endCurrentTracking();
+      break;
+    }
+  }
+  events_.clear();
+  positions_.clear();
+}
+
+void BufferedPositionTracker::printItself(std::ostream &os) const noexcept {
+  os << "Buffered Position Tracker\n"
+     << "\tNumber of recorded events: " << events_.size() << "\n";
+}
+
 JsonPositionTracker::JsonPositionTracker(std::string_view path) {
   std::string outputPath = path.data();
   outputPath += "/trackingData.js";
@@ -340,6 +529,8 @@ void JsonPositionTracker::save() {
   FileBuffer buffer = javascript::endArray();
   javascript::endLineInBuffer(buffer);
   file_.write(buffer);
+  // Simulation has ended, so the file is complete when save() returns.
+  file_.flush();
 }
 
 void JsonPositionTracker::switchToReferenceModel() {
@@ -425,6 +616,255 @@ bool JsonSampledPositionTracker::isSampling() const {
   return false;
 }
 
+namespace {
+
+constexpr char kTrackingMagic[8] = {'D', 'C', 'R', 'T', 'T', 'R', 'C', 'K'};
+constexpr char kIndexMagic[8] = {'D', 'C', 'R', 'T', 'T', 'I', 'D', 'X'};
+constexpr uint32_t kTrackingVersion = 1;
+constexpr float kDirectionScale = 32767;
+
+template <typename T> void writeValue(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Reads value at the beginning of |contents| and removes it from |contents|.
+template <typename T> T readValue(std::string_view *contents) {
+  if (contents->size() < sizeof(T)) {
+    throw std::invalid_argument("Tracking file ends unexpectedly!");
+  }
+  T value;
+  std::memcpy(&value, contents->data(), sizeof(T));
+  contents->remove_prefix(sizeof(T));
+  return value;
+}
+
+void readMagic(const char (&magic)[8], std::string_view *contents) {
+  if (contents->substr(0, sizeof(magic)) !=
+      std::string_view(magic, sizeof(magic))) {
+    throw std::invalid_argument("File is not a tracking file!");
+  }
+  contents->remove_prefix(sizeof(magic));
+  const uint32_t version = readValue<uint32_t>(contents);
+  if (version != kTrackingVersion) {
+    std::stringstream ss;
+    ss << "Tracking file version: " << version
+       << " is not supported! Supported version: " << kTrackingVersion;
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+int16_t quantize(float value, float scale) {
+  return static_cast<int16_t>(
+      std::clamp(std::round(value * scale), -32767.0f, 32767.0f));
+}
+
+std::string trackingPath(std::string_view path) {
+  return std::string(path) + "/trackingData.bin";
+}
+
+std::string indexPath(std::string_view path) {
+  return std::string(path) + "/trackingData.index";
+}
+
+} // namespace
+
+BinaryPositionTracker::BinaryPositionTracker(std::string_view path,
+                                             float maxDistance)
+    : path_(path), scale_(maxDistance / kDirectionScale) {
+  if (maxDistance <= 0) {
+    std::stringstream ss;
+    ss << "Max distance: " << maxDistance << " must be positive";
+    throw std::invalid_argument(ss.str());
+  }
+  file_.open(trackingPath(path_), std::ios::binary | std::ios::trunc);
+  if (!file_.good()) {
+    std::stringstream ss;
+    ss << "Error in: " << *this << "File doesn't exist at given path!";
+    throw std::invalid_argument(ss.str());
+  }
+  file_.write(kTrackingMagic, sizeof(kTrackingMagic));
+  writeValue<uint32_t>(file_, kTrackingVersion);
+  writeValue<float>(file_, scale_);
+  records_.reserve(kRecordsPerWrite);
+}
+
+void BinaryPositionTracker::initializeNewFrequency(float frequency) {
+  index_.push_back({frequency, referenceModel_, numOfRecords_, 0});
+}
+
+void BinaryPositionTracker::initializeNewTracking() {
+  currentTracking_.clear();
+}
+
+void BinaryPositionTracker::addNewPositionToCurrentTracking(
+    const core::RayHitData &hitData) {
+  TrackingRecord record;
+  const core::Vec3 origin = hitData.origin();
+  const core::Vec3 direction = hitData.direction();
+  const float originCoordinates[3] = {origin.x(), origin.y(), origin.z()};
+  const float directionCoordinates[3] = {direction.x(), direction.y(),
+                                         direction.z()};
+  for (int axis = 0; axis < 3; ++axis) {
+    record.origin[axis] = quantize(originCoordinates[axis], 1 / scale_);
+    record.direction[axis] =
+        quantize(directionCoordinates[axis], kDirectionScale);
+  }
+  const float length = (origin - hitData.collisionPoint()).magnitude();
+  record.length = static_cast<uint16_t>(
+      std::clamp(std::round(length / scale_), 0.0f, 65535.0f));
+  record.indexInTracking = static_cast<uint16_t>(
+      std::min<size_t>(currentTracking_.size(), 65535));
+  record.energy = hitData.energy();
+  currentTracking_.push_back(record);
+}
+
+void BinaryPositionTracker::endCurrentFrequency() {}
+
+void BinaryPositionTracker::endCurrentTracking() {
+  // Like JsonPositionTracker, skips rays that did not hit anything.
+  if (currentTracking_.size() > 1) {
+    if (index_.empty()) {
+      std::stringstream ss;
+      ss << "Error in: " << *this
+         << "Tracking ended before initialization of the frequency!";
+      throw std::invalid_argument(ss.str());
+    }
+    records_.insert(records_.end(), currentTracking_.cbegin(),
+                    currentTracking_.cend());
+    index_.back().numOfRecords += currentTracking_.size();
+    numOfRecords_ += currentTracking_.size();
+    if (records_.size() >= kRecordsPerWrite) {
+      writeRecords();
+    }
+  }
+}
+
+void BinaryPositionTracker::save() {
+  writeRecords();
+  file_.flush();
+  std::ofstream index(indexPath(path_), std::ios::binary | std::ios::trunc);
+  index.write(kIndexMagic, sizeof(kIndexMagic));
+  writeValue<uint32_t>(index, kTrackingVersion);
+  writeValue<uint64_t>(index, index_.size());
+  for (const TrackingIndexEntry &entry : index_) {
+    writeValue<float>(index, entry.frequency);
+    writeValue<uint32_t>(index, entry.referenceModel);
+    writeValue<uint64_t>(index, entry.firstRecord);
+    writeValue<uint64_t>(index, entry.numOfRecords);
+  }
+  if (!file_.good() || !index.good()) {
+    std::stringstream ss;
+    ss << "Error in: " << *this << "Tracking could not be written!";
+    throw std::invalid_argument(ss.str());
+  }
+}
+
+void BinaryPositionTracker::switchToReferenceModel() {
+  referenceModel_ = true;
+}
+
+void BinaryPositionTracker::printItself(std::ostream &os) const noexcept {
+  os << "Binary Position Tracker\n"
+     << "File: " << trackingPath(path_) << "\n"
+     << "Scale: " << scale_ << " m\n"
+     << "Frequencies: " << index_.size() << "\n"
+     << "Records: " << numOfRecords_ << "\n";
+}
+
+void BinaryPositionTracker::writeRecords() {
+  file_.write(reinterpret_cast<const char *>(records_.data()),
+              records_.size() * sizeof(TrackingRecord));
+  records_.clear();
+}
+
+BinaryTrackingReader::BinaryTrackingReader(std::string_view path)
+    : file_(trackingPath(path)) {
+  std::string_view contents = file_.contents();
+  readMagic(kTrackingMagic, &contents);
+  scale_ = readValue<float>(&contents);
+  records_ = contents;
+
+  objLoader::MappedFile indexFile(indexPath(path));
+  std::string_view index = indexFile.contents();
+  readMagic(kIndexMagic, &index);
+  const uint64_t numOfEntries = readValue<uint64_t>(&index);
+  for (uint64_t entryIndex = 0; entryIndex < numOfEntries; ++entryIndex) {
+    TrackingIndexEntry entry;
+    entry.frequency = readValue<float>(&index);
+    entry.referenceModel = readValue<uint32_t>(&index);
+    entry.firstRecord = readValue<uint64_t>(&index);
+    entry.numOfRecords = readValue<uint64_t>(&index);
+    if ((entry.firstRecord + entry.numOfRecords) * sizeof(TrackingRecord) >
+        records_.size()) {
+      std::stringstream ss;
+      ss << "Records of the frequency: " << entry.frequency
+         << " are not written in " << file_;
+      throw std::invalid_argument(ss.str());
+    }
+    index_.push_back(entry);
+  }
+}
+
+TrackingRecord BinaryTrackingReader::record(uint64_t index) const {
+  TrackingRecord record;
+  std::memcpy(&record, records_.data() + index * sizeof(TrackingRecord),
+              sizeof(TrackingRecord));
+  return record;
+}
+
+core::RayHitData
+BinaryTrackingReader::decode(const TrackingRecord &record,
+                             const TrackingIndexEntry &entry) const {
+  const core::Vec3 origin(record.origin[0] * scale_, record.origin[1] * scale_,
+                          record.origin[2] * scale_);
+  const core::Vec3 direction(record.direction[0] / kDirectionScale,
+                             record.direction[1] / kDirectionScale,
+                             record.direction[2] / kDirectionScale);
+  return core::RayHitData(record.length * scale_, core::Vec3::kZ,
+                          core::Ray(origin, direction, record.energy),
+                          entry.frequency);
+}
+
+void BinaryTrackingReader::replay(PositionTrackerInterface *tracker) const {
+  bool referenceModel = false;
+  for (const TrackingIndexEntry &entry : index_) {
+    if (entry.referenceModel && !referenceModel) {
+      tracker->save();
+      tracker->switchToReferenceModel();
+      referenceModel = true;
+    }
+    tracker->initializeNewFrequency(entry.frequency);
+    for (uint64_t index = entry.firstRecord;
+         index < entry.firstRecord + entry.numOfRecords; ++index) {
+      const TrackingRecord current = record(index);
+      if (current.indexInTracking == 0) {
+        if (index != entry.firstRecord) {
+          tracker->endCurrentTracking();
+        }
+        tracker->initializeNewTracking();
+      }
+      tracker->addNewPositionToCurrentTracking(decode(current, entry));
+    }
+    if (entry.numOfRecords > 0) {
+      tracker->endCurrentTracking();
+    }
+    tracker->endCurrentFrequency();
+  }
+  tracker->save();
+}
+
+void BinaryTrackingReader::printItself(std::ostream &os) const noexcept {
+  os << "Binary Tracking Reader\n"
+     << "File: " << file_ << "Scale: " << scale_ << " m\n"
+     << "Frequencies: " << index_.size() << "\n";
+}
+
+void convertBinaryTrackingToJs(std::string_view path) {
+  BinaryTrackingReader reader(path);
+  JsonPositionTracker tracker(path);
+  reader.replay(&tracker);
+}
+
 void SimplePositionTracker::addNewPositionToCurrentTracking(
     const core::RayHitData &hitData) {
   reachedPositions_.push_back(hitData);
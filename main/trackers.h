@@ -4,15 +4,29 @@
 #include "core/classUtlilities.h"
 #include "core/ray.h"
 #include "main/model.h"
+#include "main/objLoader.h"
 #include "main/resultsCalculation.h"
 #include "nlohmann/json.hpp"
 #include "obj/objects.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <iterator>
+#include <mutex>
 #include <optional>
 #include <sstream>
+#include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 // Contains objects and functions that are responsible for exporting calculated
@@ -30,7 +44,7 @@ public:
   void registerResult(std::string_view parameterName,
                       const std::map<float, float> &result);
 
-  // Saves acoustic in json format
+  // Saves acoustic in json format and returns after the file is written.
   void saveRaport(std::string path) const;
   // TODO: create file association with right reference and trained model
   // TODO: put this implementation outside of this class
@@ -67,34 +81,96 @@ private:
   virtual void open() = 0;
 };
 
-// Mediator between std::ofstream and FileBuffer.
-// Manages opening, saving, writing and closing file.
+// Appends data to files in the background thread, so that threads tracing
+// rays never wait for the disk. Data is collected in one buffer while the
+// other one is written. Appending blocks only when |bufferSize| bytes are
+// already waiting for the write, such waits are counted in statistics().
+// Data is written in order of appending, no matter to which file.
+class AsyncFileWriter : public Printable, private boost::noncopyable {
+public:
+  struct Statistics {
+    size_t numOfAppends = 0;
+    size_t writtenBytes = 0;
+    size_t maxBufferedBytes = 0;
+    // Appends that waited until the previous buffer was written.
+    size_t numOfBlockedAppends = 0;
+    double blockedSeconds = 0;
+  };
+
+  explicit AsyncFileWriter(size_t bufferSize = kDefaultBufferSize);
+  // Writes all appended data.
+  ~AsyncFileWriter();
+
+  // Writer shared by all Files.
+  static AsyncFileWriter &instance();
+
+  void append(std::string_view path, std::string data);
+  // Blocks until all appended data is written. Rethrows exception of the
+  // last failed write.
+  void flush();
+  Statistics statistics() const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+  static constexpr size_t kDefaultBufferSize = 1 << 24;
+
+private:
+  struct Append {
+    std::string path;
+    std::string data;
+  };
+
+  void writeLoop();
+
+  size_t bufferSize_;
+  mutable std::mutex mutex_;
+  // Wakes the writing thread when data is appended or the writer stops.
+  std::condition_variable appended_;
+  // Wakes appending threads when the buffer is taken by the writing thread.
+  std::condition_variable written_;
+  std::vector<Append> buffer_;
+  size_t bufferedBytes_ = 0;
+  bool writing_ = false;
+  bool stop_ = false;
+  std::exception_ptr error_;
+  Statistics statistics_;
+  std::thread thread_;
+};
+
+// Mediator between AsyncFileWriter and FileBuffer.
+// Manages opening and writing file. Data is written in the background, see
+// flush().
 class File : public FileInterface {
 public:
-  explicit File(std::string_view path = "") : path_(path.data()){};
+  explicit File(std::string_view path = "",
+                AsyncFileWriter *writer = &AsyncFileWriter::instance())
+      : path_(path.data()), writer_(writer){};
   virtual ~File(){};
-  // Opens file at given |path| overwriting existing one.
-  // Throws std::invalid_argument exception if file is not found
-  // at given path.
+  // Opens file at given |path| overwriting existing one, after everything
+  // appended before is written. Throws std::invalid_argument exception if
+  // file is not found at given path.
   void openFileWithOverwrite();
-  // Opens file at given |path| without overwriting it.
-  // Data is appended after existing one. Throws
-  // std::invalid_argument exception if file is not found
-  // at given path.
-  // Writes given FileBuffer into file and flush content;
+  // Appends given FileBuffer and new line to the file at given |path|.
+  // Before the first write, checks if file can be opened without
+  // overwriting it. Throws std::invalid_argument exception if file is not
+  // found at given path.
   void write(const FileBuffer &buffer);
+  // Appends given FileBuffer to the file at given |path|.
   void writeWithoutFlush(const FileBuffer &buffer);
+  // Blocks until everything appended by the writer of the file is written.
+  void flush();
   void printItself(std::ostream &os) const noexcept override;
 
   void setPath(std::string_view path);
 
 private:
   void open();
-  void handleErrors();
+  void handleErrors(const std::ofstream &fileStream);
 
 protected:
-  std::ofstream fileStream_;
   std::string path_;
+  AsyncFileWriter *writer_;
+  bool opened_ = false;
 };
 
 // contains utilities for rendering javascript syntax in FileBuffer
@@ -136,13 +212,15 @@ using EnergyPerFrequency = std::unordered_map<float, Energies>;
 struct DataExporter : Printable {
   // Save results of the simulation at given |path| as results.js file, with
   // json structure. if |referenceModel| is false, file will be overwritten.
+  // Returns after the file is written.
   void saveResultsAsJson(std::string_view path,
                          const EnergyPerFrequency &results,
                          bool referenceModel = false);
 
   // Overwrites |model| to the given .js file as Json file in javascript syntax
   // as const model variable or if the reference model is given true, data is
-  // appended as a const referenceModel variable.
+  // appended as a const referenceModel variable. Returns after the file is
+  // written.
   void saveModelToJson(std::string_view pathToFolder, ModelInterface *model,
                        bool referenceModel = false);
 
@@ -165,6 +243,9 @@ public:
   virtual void endCurrentTracking() = 0;
   virtual void save() = 0;
   virtual void switchToReferenceModel() = 0;
+  // Returns false when tracker ignores all positions, so there is no need to
+  // generate them.
+  virtual bool tracksPositions() const { return true; }
   void printItself(std::ostream &os) const noexcept override;
 };
 
@@ -179,9 +260,50 @@ public:
   void endCurrentTracking() override{};
   void save() override{};
   void switchToReferenceModel() override{};
+  bool tracksPositions() const override { return false; }
   void printItself(std::ostream &os) const noexcept override;
 };
 
+// Stores all events in memory, so that simulation of one frequency can be
+// performed in separate thread and then passed to the real tracker with
+// replay() in the same order as in the sequential simulation.
+// save() and switchToReferenceModel() are not recorded, they should be called
+// directly on the real tracker.
+class BufferedPositionTracker : public PositionTrackerInterface {
+public:
+  void initializeNewFrequency(float frequency) override;
+  void initializeNewTracking() override;
+  void
+  addNewPositionToCurrentTracking(const core::RayHitData &hitData) override;
+  void endCurrentFrequency() override;
+  void endCurrentTracking() override;
+  void save() override{};
+  void switchToReferenceModel() override{};
+  void printItself(std::ostream &os) const noexcept override;
+
+  // Passes all recorded events to the |tracker| and clears the buffer.
+  void replay(PositionTrackerInterface *tracker);
+  size_t numOfEvents() const { return events_.size(); }
+
+private:
+  enum class EventType {
+    kNewFrequency,
+    kNewTracking,
+    kNewPosition,
+    kEndFrequency,
+    kEndTracking
+  };
+  struct Event {
+    EventType type;
+    float frequency;
+    // Index of the position in |positions_| for kNewPosition events.
+    size_t positionIndex;
+  };
+
+  std::vector<Event> events_;
+  std::vector<core::RayHitData> positions_;
+};
+
 // Tracks all reached rays position and saves them to js file as json data at
 // given path. REQUIREMENTS: file must exist at given path.
 class JsonPositionTracker : public PositionTrackerInterface {
@@ -239,6 +361,97 @@ private:
   int currentNumberOfTracking_;
 };
 
+// Position reached by the ray, stored by BinaryPositionTracker. |origin| and
+// |length| are multiples of the scale of the file, |direction| is a multiple
+// of 1 / 32767.
+struct TrackingRecord {
+  int16_t origin[3];
+  int16_t direction[3];
+  uint16_t length;
+  // Position of the record in its tracking, 0 starts new tracking.
+  uint16_t indexInTracking;
+  float energy;
+};
+
+// Records of the single frequency, saved by BinaryPositionTracker.
+struct TrackingIndexEntry {
+  float frequency;
+  uint32_t referenceModel;
+  uint64_t firstRecord;
+  uint64_t numOfRecords;
+};
+
+// Tracks all reached rays positions like JsonPositionTracker, but appends
+// them to "trackingData.bin" file at given path as fixed size records.
+// Records are written in blocks and "trackingData.index" file lists records
+// of every frequency, so that file is written only by save(). Files are
+// converted to the .js file by convertBinaryTrackingToJs(). Coordinates up
+// to |maxDistance| are stored with precision of |maxDistance| / 32767, larger
+// coordinates are clamped. REQUIREMENTS: directory must exist at given path,
+// |maxDistance| must be positive.
+class BinaryPositionTracker : public PositionTrackerInterface {
+public:
+  explicit BinaryPositionTracker(
+      std::string_view path,
+      float maxDistance = 2 * constants::kSimulationHeight);
+
+  void initializeNewFrequency(float frequency) override;
+  void initializeNewTracking() override;
+  void
+  addNewPositionToCurrentTracking(const core::RayHitData &hitData) override;
+  void endCurrentFrequency() override;
+  void endCurrentTracking() override;
+
+  // Writes all records and the index.
+  void save() override;
+  void switchToReferenceModel() override;
+  void printItself(std::ostream &os) const noexcept override;
+
+  // Records are written to the file in blocks of this size.
+  static constexpr size_t kRecordsPerWrite = 1 << 14;
+
+private:
+  void writeRecords();
+
+  std::string path_;
+  float scale_;
+  std::ofstream file_;
+  std::vector<TrackingRecord> currentTracking_;
+  std::vector<TrackingRecord> records_;
+  std::vector<TrackingIndexEntry> index_;
+  uint64_t numOfRecords_ = 0;
+  bool referenceModel_ = false;
+};
+
+// Reads trackings saved by BinaryPositionTracker at given path. Records are
+// read directly from the mapped file. Throws std::invalid_argument when files
+// at |path| are not valid tracking files.
+class BinaryTrackingReader : public Printable, private boost::noncopyable {
+public:
+  explicit BinaryTrackingReader(std::string_view path);
+
+  const std::vector<TrackingIndexEntry> &index() const { return index_; }
+  TrackingRecord record(uint64_t index) const;
+  // Returns position stored in the |record| of the frequency of |entry|.
+  core::RayHitData decode(const TrackingRecord &record,
+                          const TrackingIndexEntry &entry) const;
+  // Passes all trackings to the |tracker| in the order of the simulation.
+  void replay(PositionTrackerInterface *tracker) const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  objLoader::MappedFile file_;
+  float scale_;
+  std::string_view records_;
+  std::vector<TrackingIndexEntry> index_;
+};
+
+// Replays trackings saved by BinaryPositionTracker at given path to the
+// JsonPositionTracker, which writes "trackingData.js" file for the GUI at the
+// same path.
+void convertBinaryTrackingToJs(std::string_view path);
+
 class SimplePositionTracker : public PositionTrackerInterface {
 public:
   void
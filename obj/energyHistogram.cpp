@@ -0,0 +1,93 @@
+#include "obj/energyHistogram.h"
+
+namespace objects {
+
+EnergyHistogram::EnergyHistogram(int sampleRate) : sampleRate_(sampleRate) {
+  if (sampleRate_ <= 0) {
+    std::stringstream errorStream;
+    errorStream << "Sample rate of the EnergyHistogram must be greater than "
+                   "zero! Given sample rate: "
+                << sampleRate_;
+    throw std::invalid_argument(errorStream.str());
+  }
+}
+
+EnergyHistogram::EnergyHistogram(int sampleRate, std::vector<float> samples)
+    : EnergyHistogram(sampleRate) {
+  samples_ = std::move(samples);
+}
+
+bool EnergyHistogram::operator==(const EnergyHistogram &other) const {
+  return sampleRate_ == other.sampleRate_ && samples_ == other.samples_;
+}
+
+bool EnergyHistogram::operator!=(const EnergyHistogram &other) const {
+  return !(*this == other);
+}
+
+uint64_t EnergyHistogram::sampleIndex(float time) const {
+  return std::floor(time * sampleRate_);
+}
+
+void EnergyHistogram::reserve(float maxTime) {
+  if (maxTime > 0) {
+    samples_.reserve(sampleIndex(maxTime) + 1);
+  }
+}
+
+void EnergyHistogram::addEnergy(float time, float energy) {
+  if (time < 0) {
+    std::stringstream errorStream;
+    errorStream << "given time at addEnergy() in: \n"
+                << *this << "cannot be less then 0! Given Time: " << time
+                << "s.";
+    throw std::invalid_argument(errorStream.str());
+  }
+  const uint64_t index = sampleIndex(time);
+  if (index >= samples_.size()) {
+    samples_.resize(index + 1, 0);
+  }
+  samples_[index] += energy;
+}
+
+void EnergyHistogram::addEnergy(const EnergyHistogram &other) {
+  if (other.sampleRate_ != sampleRate_) {
+    std::stringstream errorStream;
+    errorStream << "Cannot add energy of: \n"
+                << other << "\nto: \n"
+                << *this << "\nSample rates are different!";
+    throw std::invalid_argument(errorStream.str());
+  }
+  if (other.samples_.size() > samples_.size()) {
+    samples_.resize(other.samples_.size(), 0);
+  }
+  for (size_t index = 0; index < other.samples_.size(); ++index) {
+    samples_[index] += other.samples_[index];
+  }
+}
+
+void EnergyHistogram::scale(float factor) {
+  for (float &energy : samples_) {
+    energy *= factor;
+  }
+}
+
+float EnergyHistogram::timeAt(size_t sampleIndex) const {
+  return static_cast<float>(sampleIndex) / sampleRate_;
+}
+
+float EnergyHistogram::totalEnergy() const {
+  float total = 0;
+  for (float energy : samples_) {
+    total += energy;
+  }
+  return total;
+}
+
+void EnergyHistogram::printItself(std::ostream &os) const noexcept {
+  os << "Energy Histogram\n"
+     << "Sample rate: " << sampleRate_ << " Hz\n"
+     << "Number of samples: " << samples_.size() << "\n";
+}
+
+} // namespace objects
@@ -0,0 +1,60 @@
+#ifndef ENERGY_HISTOGRAM_H
+#define ENERGY_HISTOGRAM_H
+
+#include "core/classUtlilities.h"
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace objects {
+
+// Energy collected in time, stored as dense array of samples. Energy that
+// arrived at |time| is added to the sample with index floor(time *
+// sampleRate), the same way as WaveObject does it, so histogram with the same
+// sample rate can be converted to the WaveObject by copying its samples.
+class EnergyHistogram : public Printable {
+public:
+  static constexpr int kDefaultSampleRate = 96000; // [Hz]
+
+  explicit EnergyHistogram(int sampleRate = kDefaultSampleRate);
+  // Histogram with given energy of every sample.
+  EnergyHistogram(int sampleRate, std::vector<float> samples);
+
+  bool operator==(const EnergyHistogram &other) const;
+  bool operator!=(const EnergyHistogram &other) const;
+
+  // Preallocates samples up to |maxTime| [s], so adding energy that arrives
+  // before |maxTime| never allocates memory.
+  void reserve(float maxTime);
+  void addEnergy(float time, float energy);
+  // Adds |other| sample by sample. Both histograms must have the same sample
+  // rate.
+  void addEnergy(const EnergyHistogram &other);
+  // Multiplies energy of every sample by |factor|.
+  void scale(float factor);
+
+  int sampleRate() const { return sampleRate_; }
+  // Number of samples up to the last sample that received any energy.
+  size_t length() const { return samples_.size(); }
+  bool empty() const { return samples_.empty(); }
+  const std::vector<float> &samples() const { return samples_; }
+  // Returns time [s] at which sample with given |sampleIndex| starts.
+  float timeAt(size_t sampleIndex) const;
+  float totalEnergy() const;
+
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  uint64_t sampleIndex(float time) const;
+
+  int sampleRate_;
+  std::vector<float> samples_;
+};
+
+} // namespace objects
+
+#endif
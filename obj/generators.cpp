@@ -2,6 +2,86 @@
 
 namespace generators {
 
+namespace {
+
+// Comes from the requirements of the ISO 17497-2:2012, which says that point
+// source must be placed at least twice as high as the microphone radius
+// array. Because microphone radius array is equal to:
+// |kSimulationHeight| / 2 * model.height(), we can assume:
+core::Vec3 pointSourceOrigin(const ModelInterface &model) {
+  return core::Vec3(0, 0,
+                    std::max(static_cast<float>(constants::kSimulationHeight),
+                             constants::kSimulationHeight * model.height()));
+}
+
+// Direction from |origin| to the corner of the model with the lowest x and y.
+core::Vec3 cornerDirection(const ModelInterface &model,
+                           const core::Vec3 &origin) {
+  float sizeFactor = -model.sideSize();
+  return core::Vec3(sizeFactor, sizeFactor, model.height()) - origin;
+}
+
+// Converts 32 fixed point bits to the float in range [0, 1).
+float toUnitInterval(uint32_t bits) {
+  return std::min(bits * 0x1p-32f, 0x1.fffffep-1f);
+}
+
+uint32_t reverseBits(uint32_t bits) {
+  bits = (bits << 16) | (bits >> 16);
+  bits = ((bits & 0x00ff00ff) << 8) | ((bits & 0xff00ff00) >> 8);
+  bits = ((bits & 0x0f0f0f0f) << 4) | ((bits & 0xf0f0f0f0) >> 4);
+  bits = ((bits & 0x33333333) << 2) | ((bits & 0xcccccccc) >> 2);
+  bits = ((bits & 0x55555555) << 1) | ((bits & 0xaaaaaaaa) >> 1);
+  return bits;
+}
+
+// Second dimension of the Sobol sequence, whose direction numbers come from
+// the primitive polynomial x + 1. First dimension is reverseBits(index).
+uint32_t sobolSecondDimension(uint32_t index) {
+  uint32_t result = 0;
+  for (uint32_t direction = 1u << 31; index != 0;
+       index >>= 1, direction ^= direction >> 1) {
+    if (index & 1) {
+      result ^= direction;
+    }
+  }
+  return result;
+}
+
+// Hash based Owen scrambling from "Practical Hash-based Owen Scrambling" by
+// Burley. Every bit is flipped depending only on the more significant bits,
+// so points stay stratified in every elementary interval.
+uint32_t owenScramble(uint32_t bits, uint32_t seed) {
+  bits = reverseBits(bits);
+  bits += seed;
+  bits ^= bits * 0x6c50b47cu;
+  bits ^= bits * 0xb82f1e52u;
+  bits ^= bits * 0xc7afe638u;
+  bits ^= bits * 0x8d22f6e6u;
+  return reverseBits(bits);
+}
+
+// Each dimension is scrambled with a different seed.
+uint32_t dimensionSeed(uint32_t seed, uint32_t dimension) {
+  uint64_t hash = (static_cast<uint64_t>(seed) << 32 | dimension) *
+                  0x9e3779b97f4a7c15ull;
+  return static_cast<uint32_t>(hash >> 32);
+}
+
+float radicalInverse(uint32_t index, uint32_t base) {
+  uint64_t reversed = 0;
+  uint64_t denominator = 1;
+  for (; index != 0; index /= base) {
+    reversed = reversed * base + index % base;
+    denominator *= base;
+  }
+  return std::min(static_cast<float>(static_cast<double>(reversed) /
+                                     denominator),
+                  0x1.fffffep-1f);
+}
+
+} // namespace
+
 void RandomRayOffseter::printItself(std::ostream &os) const noexcept {
   os << "Random Ray Offseter Interface Class";
 }
@@ -41,18 +121,8 @@ PointSpeakerRayFactory::PointSpeakerRayFactory(int numOfRaysAlongEachAxis,
     throw std::invalid_argument("Model cannot be Empty!");
   }
 
-  // Comes from the requirements of the ISO 17497-2:2012, which says that point
-  // source must be placed at least twice as high as the microphone radius
-  // array. Because microphone radius array is equal to:
-  // |kSimulationHeight| / 2 * model.height(), we can assume:
-  origin_ =
-      core::Vec3(0, 0,
-                 std::max(static_cast<float>(constants::kSimulationHeight),
-                          constants::kSimulationHeight * model_->height()));
-
-  float sizeFactor = -model_->sideSize();
-  targetReferenceDirection_ =
-      core::Vec3(sizeFactor, sizeFactor, model->height()) - origin_;
+  origin_ = pointSourceOrigin(*model_);
+  targetReferenceDirection_ = cornerDirection(*model_, origin_);
 };
 
 bool PointSpeakerRayFactory::genRay(core::Ray *ray) {
@@ -63,6 +133,18 @@ bool PointSpeakerRayFactory::genRay(core::Ray *ray) {
   ++currentRayIndex_;
   return true;
 }
+
+int PointSpeakerRayFactory::numOfRays() const {
+  return numOfRaysAlongEachAxis_ * numOfRaysAlongEachAxis_;
+}
+
+bool PointSpeakerRayFactory::rayAt(int index, core::Ray *ray) const {
+  if (index < 0 || index >= numOfRays()) {
+    return false;
+  }
+  *ray = core::Ray(origin_, getDirection(index), energyPerRay_);
+  return true;
+}
 core::Vec3 PointSpeakerRayFactory::getDirection(int currentRayIndex) const {
   if (numOfRaysAlongEachAxis_ == 1) {
     return -core::Vec3::kZ;
@@ -80,7 +162,7 @@ core::Vec3 PointSpeakerRayFactory::getDirection(int currentRayIndex) const {
 }
 
 bool PointSpeakerRayFactory::isRayAvailable() const {
-  return (currentRayIndex_ < numOfRaysAlongEachAxis_ * numOfRaysAlongEachAxis_);
+  return currentRayIndex_ < numOfRays();
 }
 
 void PointSpeakerRayFactory::printItself(std::ostream &os) const noexcept {
@@ -92,6 +174,136 @@ void PointSpeakerRayFactory::printItself(std::ostream &os) const noexcept {
      << "\tTarget Reference Direction: " << targetReferenceDirection_;
 }
 
+QuasiRandomSpeakerRayFactory::QuasiRandomSpeakerRayFactory(
+    int numOfRays, float sourcePower, ModelInterface *model, Sequence sequence,
+    std::optional<uint32_t> scramblingSeed)
+    : model_(model), numOfRays_(numOfRays), sequence_(sequence),
+      scramblingSeed_(scramblingSeed), currentRayIndex_(0),
+      energyPerRay_(sourcePower / numOfRays) {
+  if (numOfRays_ <= 0) {
+    std::stringstream ss;
+    ss << "|numOfRays| given to: \n"
+       << *this << "cannot be equal or less than zero! \n|numOfRays|: "
+       << numOfRays_;
+    throw std::invalid_argument(ss.str());
+  }
+  if (sourcePower < 0) {
+    std::stringstream ss;
+    ss << "|sourcePower| power cannot be less than zero! \n|sourcePower|: "
+       << sourcePower;
+    throw std::invalid_argument(ss.str());
+  }
+  if (sequence_ == Sequence::kHalton && scramblingSeed_) {
+    std::stringstream ss;
+    ss << "Halton sequence cannot be scrambled! \n|scramblingSeed|: "
+       << *scramblingSeed_;
+    throw std::invalid_argument(ss.str());
+  }
+  if (model_->empty()) {
+    throw std::invalid_argument("Model cannot be Empty!");
+  }
+
+  origin_ = pointSourceOrigin(*model_);
+  targetReferenceDirection_ = cornerDirection(*model_, origin_);
+}
+
+bool QuasiRandomSpeakerRayFactory::genRay(core::Ray *ray) {
+  if (!rayAt(currentRayIndex_, ray)) {
+    return false;
+  }
+  ++currentRayIndex_;
+  return true;
+}
+
+bool QuasiRandomSpeakerRayFactory::rayAt(int index, core::Ray *ray) const {
+  if (index < 0 || index >= numOfRays_) {
+    return false;
+  }
+  *ray = core::Ray(origin_, getDirection(index), energyPerRay_);
+  return true;
+}
+
+std::pair<float, float>
+QuasiRandomSpeakerRayFactory::unitSquarePoint(int index) const {
+  if (sequence_ == Sequence::kHalton) {
+    return {radicalInverse(index, 2), radicalInverse(index, 3)};
+  }
+  uint32_t u = reverseBits(index);
+  uint32_t v = sobolSecondDimension(index);
+  if (scramblingSeed_) {
+    u = owenScramble(u, dimensionSeed(*scramblingSeed_, 0));
+    v = owenScramble(v, dimensionSeed(*scramblingSeed_, 1));
+  }
+  return {toUnitInterval(u), toUnitInterval(v)};
+}
+
+core::Vec3 QuasiRandomSpeakerRayFactory::getDirection(int index) const {
+  if (numOfRays_ == 1) {
+    return -core::Vec3::kZ;
+  }
+  auto [u, v] = unitSquarePoint(index);
+  return targetReferenceDirection_ + core::Vec3(2 * u * model_->sideSize(),
+                                                2 * v * model_->sideSize(), 0);
+}
+
+void QuasiRandomSpeakerRayFactory::printItself(
+    std::ostream &os) const noexcept {
+  os << "QUASI RANDOM SPEAKER RAY FACTORY\n"
+     << "\tOrigin: " << origin_ << "\n"
+     << "\tSequence: "
+     << (sequence_ == Sequence::kHalton ? "Halton" : "Sobol") << "\n"
+     << "\tScrambling Seed: "
+     << (scramblingSeed_ ? std::to_string(*scramblingSeed_) : "none") << "\n"
+     << "\tNum Of Rays: " << numOfRays_ << "\n"
+     << "\tCurrent Ray Index: " << currentRayIndex_ << "\n"
+     << "\tEnergy Per Ray: " << energyPerRay_ << "\n"
+     << "\tTarget Reference Direction: " << targetReferenceDirection_;
+}
+
+std::unique_ptr<RayFactory> NewPointSource(SourceSampling sampling,
+                                           int numOfRays, float sourcePower,
+                                           ModelInterface *model,
+                                           uint64_t seed) {
+  using Sequence = QuasiRandomSpeakerRayFactory::Sequence;
+  switch (sampling) {
+  case SourceSampling::kHalton:
+    return std::make_unique<QuasiRandomSpeakerRayFactory>(
+        numOfRays, sourcePower, model, Sequence::kHalton);
+  case SourceSampling::kSobol:
+    return std::make_unique<QuasiRandomSpeakerRayFactory>(
+        numOfRays, sourcePower, model, Sequence::kSobol);
+  case SourceSampling::kScrambledSobol:
+    return std::make_unique<QuasiRandomSpeakerRayFactory>(
+        numOfRays, sourcePower, model, Sequence::kSobol,
+        static_cast<uint32_t>(seed ^ (seed >> 32)));
+  case SourceSampling::kGrid:
+    break;
+  }
+  const int numOfRaysAlongEachAxis = std::lround(std::sqrt(numOfRays));
+  if (numOfRaysAlongEachAxis * numOfRaysAlongEachAxis != numOfRays) {
+    std::stringstream ss;
+    ss << "Grid source needs square number of rays! \n|numOfRays|: "
+       << numOfRays;
+    throw std::invalid_argument(ss.str());
+  }
+  return std::make_unique<PointSpeakerRayFactory>(numOfRaysAlongEachAxis,
+                                                  sourcePower, model);
+}
+
+std::ostream &operator<<(std::ostream &os, SourceSampling sampling) {
+  switch (sampling) {
+  case SourceSampling::kGrid:
+    return os << "Grid";
+  case SourceSampling::kHalton:
+    return os << "Halton";
+  case SourceSampling::kSobol:
+    return os << "Sobol";
+  case SourceSampling::kScrambledSobol:
+    return os << "Scrambled Sobol";
+  }
+  return os;
+}
+
 bool CustomPointRayFactory::genRay(core::Ray *ray) {
   if (!wasUsed_) {
     *ray = core::Ray(origin_, direction_, energy_);
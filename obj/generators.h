@@ -7,9 +7,16 @@
 #include "core/vec3.h"
 #include "main/model.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace generators {
@@ -39,6 +46,15 @@ class RayFactory : public Printable {
 public:
   virtual bool genRay(core::Ray *ray) = 0;
   virtual core::Vec3 origin() const = 0;
+  // Number of rays that can be accessed with rayAt(). Factories, that can
+  // only generate rays one by one, return 0.
+  virtual int numOfRays() const { return 0; }
+  // Writes ray with given |index| to the |ray| without changing state of the
+  // factory. Returns false when |index| is out of range [0, numOfRays()).
+  [[nodiscard]] virtual bool rayAt(int /*index*/,
+                                   core::Ray * /*ray*/) const {
+    return false;
+  }
   void printItself(std::ostream &os) const noexcept override;
 };
 
@@ -55,6 +71,8 @@ public:
                          ModelInterface *model);
 
   [[nodiscard]] bool genRay(core::Ray *ray) override;
+  int numOfRays() const override;
+  [[nodiscard]] bool rayAt(int index, core::Ray *ray) const override;
 
   core::Vec3 origin() const override { return origin_; }
   void printItself(std::ostream &os) const noexcept override;
@@ -73,6 +91,75 @@ private:
   core::Vec3 targetReferenceDirection_;
 };
 
+// Generates |numOfRays| rays from the same origin and with the same energy per
+// ray as PointSpeakerRayFactory, but aimed at points of the low discrepancy
+// sequence over the model instead of the regular grid. Points of the sequence
+// do not alias with periodic wells of the diffusors and fill the model evenly
+// for any number of rays, so results converge with much less rays.
+class QuasiRandomSpeakerRayFactory : public RayFactory {
+public:
+  enum class Sequence {
+    // Radical inverses in bases 2 and 3.
+    kHalton,
+    // First two dimensions of the Sobol sequence.
+    kSobol,
+  };
+
+  // |numOfRays| must be greater than 0,
+  // |sourcePower| cannot be less then 0,
+  // |model| must not be empty.
+  // When |scramblingSeed| is given, Sobol points are Owen scrambled with it,
+  // which keeps their stratification but removes the structure of the
+  // sequence. Halton sequence cannot be scrambled.
+  QuasiRandomSpeakerRayFactory(int numOfRays, float sourcePower,
+                               ModelInterface *model,
+                               Sequence sequence = Sequence::kSobol,
+                               std::optional<uint32_t> scramblingSeed = {});
+
+  [[nodiscard]] bool genRay(core::Ray *ray) override;
+  int numOfRays() const override { return numOfRays_; }
+  [[nodiscard]] bool rayAt(int index, core::Ray *ray) const override;
+
+  // Returns point of the sequence with given |index| in the unit square
+  // [0, 1)^2, that is mapped onto the model.
+  std::pair<float, float> unitSquarePoint(int index) const;
+
+  core::Vec3 origin() const override { return origin_; }
+  void printItself(std::ostream &os) const noexcept override;
+
+private:
+  core::Vec3 getDirection(int index) const;
+
+  ModelInterface *model_;
+  core::Vec3 origin_;
+  int numOfRays_;
+  Sequence sequence_;
+  std::optional<uint32_t> scramblingSeed_;
+  int currentRayIndex_;
+  float energyPerRay_;
+  core::Vec3 targetReferenceDirection_;
+};
+
+// How SceneManager aims rays of the point source at the model.
+enum class SourceSampling {
+  // Regular grid of PointSpeakerRayFactory.
+  kGrid,
+  kHalton,
+  kSobol,
+  // Owen scrambled Sobol sequence, scrambled with the simulation seed.
+  kScrambledSobol,
+};
+
+// Returns point source, that emits |numOfRays| rays with total power of
+// |sourcePower| towards the |model|. With kGrid sampling, |numOfRays| must be
+// a square of an integer.
+std::unique_ptr<RayFactory> NewPointSource(SourceSampling sampling,
+                                           int numOfRays, float sourcePower,
+                                           ModelInterface *model,
+                                           uint64_t seed = 0);
+
+std::ostream &operator<<(std::ostream &os, SourceSampling sampling);
+
 class CustomPointRayFactory : public generators::RayFactory {
 public:
   explicit CustomPointRayFactory(const core::Vec3 &origin,
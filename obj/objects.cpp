@@ -112,25 +112,27 @@ void EnergyCollector::collectEnergy(const core::RayHitData &hitdata) {
   addEnergy(time, energy);
 }
 
-void EnergyCollector::setEnergy(const EnergyPerTime &energyPerTime) {
-  collectedEnergy_ = energyPerTime;
+void EnergyCollector::setEnergy(const EnergyHistogram &energy) {
+  collectedEnergy_ = energy;
 }
-const EnergyPerTime &EnergyCollector::getEnergy() const {
+const EnergyHistogram &EnergyCollector::getEnergy() const {
   return collectedEnergy_;
 }
 // TODO: WHATS THE POINT OF THIS IF I HAVE COLLECT ENERGY????
 void EnergyCollector::addEnergy(float acquisitionTime, float energy) {
-  std::unordered_map<float, float>::iterator it =
-      collectedEnergy_.find(acquisitionTime);
+  collectedEnergy_.addEnergy(acquisitionTime, energy);
+}
 
-  if (it == collectedEnergy_.end()) {
-    auto energyPerTimeSample = std::make_pair<float, float>(
-        std::move(acquisitionTime), std::move(energy));
-    collectedEnergy_.insert(energyPerTimeSample);
+void EnergyCollector::addEnergy(const EnergyHistogram &energy) {
+  collectedEnergy_.addEnergy(energy);
+}
 
-  } else {
-    it->second += energy;
-  }
+void EnergyCollector::scaleEnergy(float factor) {
+  collectedEnergy_.scale(factor);
+}
+
+void EnergyCollector::reserveEnergy(float maxTime) {
+  collectedEnergy_.reserve(maxTime);
 }
 
 TriangleObj::TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
@@ -140,6 +142,15 @@ TriangleObj::TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
   refreshAttributes();
 }
 
+TriangleObj::TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
+                         const core::Vec3 &point3,
+                         const Attributes &attributes)
+    : normal_(attributes.normal), point1_(point1), point2_(point2),
+      point3_(point3), edge1_(attributes.edge1), edge2_(attributes.edge2),
+      area_(attributes.area), parallelThreshold_(attributes.parallelThreshold) {
+  setOrigin(attributes.origin);
+}
+
 TriangleObj::TriangleObj(const TriangleObj &other) { *this = other; }
 
 TriangleObj &TriangleObj::operator=(const TriangleObj &other) {
@@ -182,6 +193,64 @@ core::Vec3 TriangleObj::normal(const core::Vec3 &surfacePoint) const {
 
 bool TriangleObj::hitObject(const core::Ray &ray, float freq,
                             core::RayHitData *hitData) const {
+  float time, u, v;
+  if (intersect(ray, &time, &u, &v)) {
+    *hitData = core::RayHitData(time, normal_, ray, freq);
+    return true;
+  }
+  return false;
+}
+
+bool TriangleObj::intersect(const core::Ray &ray, float *time, float *u,
+                            float *v) const {
+#ifdef AREA_SUM_TRIANGLE_INTERSECTION
+  return intersectAreaSum(ray, time, u, v);
+#else
+  return intersectMollerTrumbore(ray, time, u, v);
+#endif
+}
+
+// https://www.graphics.cornell.edu/pubs/1997/MT97.pdf
+bool TriangleObj::intersectMollerTrumbore(const core::Ray &ray, float *time,
+                                          float *u, float *v) const {
+  const core::Vec3 direction = ray.direction();
+  const core::Vec3 pVec = direction.crossProduct(edge2_);
+  // Determinant is equal to -|edge1_ x edge2_| * cos(direction, normal), so
+  // rays parallel to the triangle surface have it close to zero.
+  const float determinant = edge1_.scalarProduct(pVec);
+  if (std::abs(determinant) <= parallelThreshold_) {
+    return false;
+  }
+  const float inverseDeterminant = 1.0f / determinant;
+
+  const core::Vec3 tVec = ray.origin() - point1_;
+  const float hitU = tVec.scalarProduct(pVec) * inverseDeterminant;
+  if (hitU < -constants::kBarycentricAccuracy ||
+      hitU > 1 + constants::kBarycentricAccuracy) {
+    return false;
+  }
+
+  const core::Vec3 qVec = tVec.crossProduct(edge1_);
+  const float hitV = direction.scalarProduct(qVec) * inverseDeterminant;
+  if (hitV < -constants::kBarycentricAccuracy ||
+      hitU + hitV > 1 + constants::kBarycentricAccuracy) {
+    return false;
+  }
+
+  // Following code is making sure that ray doesn't hit the same object.
+  const float hitTime = edge2_.scalarProduct(qVec) * inverseDeterminant;
+  if (hitTime < constants::kAccuracy) {
+    return false;
+  }
+
+  *time = hitTime;
+  *u = hitU;
+  *v = hitV;
+  return true;
+}
+
+bool TriangleObj::intersectAreaSum(const core::Ray &ray, float *time,
+                                   float *u, float *v) const {
   // if ray direction is parpedicular to normal, there is no hit. It can be
   // translated into checking if scalarProduct of the ray.direction and normal
   // is close or equal to zero.
@@ -192,34 +261,46 @@ bool TriangleObj::hitObject(const core::Ray &ray, float freq,
 
   // Following code calculates time at which ray
   // is hitting surface where triangle is positioned
-  float time =
+  float hitTime =
       (-1 * (ray.origin() - point3_)).scalarProduct(normal_) / normalDot;
 
   // Following code is making sure that ray doesn't hit the same object.
-  if (time < constants::kAccuracy) {
+  if (hitTime < constants::kAccuracy) {
     return false;
   }
 
-  core::Vec3 surfaceHit = ray.at(time);
-
-  if (doesHit(surfaceHit)) {
-    *hitData = core::RayHitData(time, normal_, ray, freq);
-    return true;
-  }
-  return false;
-}
-
-bool TriangleObj::doesHit(const core::Vec3 &point) const {
-  core::Vec3 vecA = point1_ - point;
-  core::Vec3 vecB = point2_ - point;
-  core::Vec3 vecC = point3_ - point;
+  core::Vec3 surfaceHit = ray.at(hitTime);
+  core::Vec3 vecA = point1_ - surfaceHit;
+  core::Vec3 vecB = point2_ - surfaceHit;
+  core::Vec3 vecC = point3_ - surfaceHit;
 
   // Area of the triangle made with point and w triangle points.
   float alpha = vecB.crossProduct(vecC).magnitude() / 2;
   float beta = vecC.crossProduct(vecA).magnitude() / 2;
   float gamma = vecA.crossProduct(vecB).magnitude() / 2;
 
-  return std::abs(alpha + beta + gamma - area_) <= constants::kAreaAccuracy;
+  if (std::abs(alpha + beta + gamma - area_) > constants::kAreaAccuracy) {
+    return false;
+  }
+  *time = hitTime;
+  *u = beta / area_;
+  *v = gamma / area_;
+  return true;
+}
+
+float TriangleObj::hitMargin() const {
+#ifdef AREA_SUM_TRIANGLE_INTERSECTION
+  // Point at distance d outside of the edge e increases area sum by d * e.
+  float shortestEdge =
+      std::min({edge1_.magnitude(), edge2_.magnitude(),
+                (point3_ - point2_).magnitude()});
+  return constants::kAccuracy + constants::kAreaAccuracy / shortestEdge;
+#else
+  float longestEdge =
+      std::max({edge1_.magnitude(), edge2_.magnitude(),
+                (point3_ - point2_).magnitude()});
+  return constants::kAccuracy + constants::kBarycentricAccuracy * longestEdge;
+#endif
 }
 
 float TriangleObj::area() const { return area_; }
@@ -227,9 +308,14 @@ float TriangleObj::area() const { return area_; }
 void TriangleObj::refreshAttributes() {
   this->recalculateArea();
   this->recalculateNormal();
+  this->recalculateEdges();
   this->setOrigin((point1_ + point2_ + point3_) / 3);
 }
 
+TriangleObj::Attributes TriangleObj::attributes() const {
+  return {normal_, edge1_, edge2_, getOrigin(), area_, parallelThreshold_};
+}
+
 void TriangleObj::recalculateArea() {
   core::Vec3 vecA = point1_ - point2_;
   core::Vec3 vecB = point1_ - point3_;
@@ -243,6 +329,13 @@ void TriangleObj::recalculateNormal() {
   normal_ = perpendicular.normalize();
 }
 
+void TriangleObj::recalculateEdges() {
+  edge1_ = point2_ - point1_;
+  edge2_ = point3_ - point1_;
+  // |edge1_ x edge2_| is equal to doubled area of the triangle.
+  parallelThreshold_ = constants::kAccuracy * 2 * area_;
+}
+
 bool TriangleObj::arePointsValid() {
   recalculateArea();
   if (area() < constants::kAccuracy) {
@@ -5,6 +5,7 @@
 #include "core/constants.h"
 #include "core/ray.h"
 #include "core/vec3.h"
+#include "obj/energyHistogram.h"
 
 #include <algorithm>
 #include <cmath>
@@ -16,9 +17,6 @@
 
 namespace objects {
 
-// TODO: What it represents?
-using EnergyPerTime = std::unordered_map<float, float>;
-
 class Object : public Printable {
 public:
   virtual ~Object(){};
@@ -81,20 +79,35 @@ public:
   float distanceAt(const core::Vec3 &positionHit) const;
   void collectEnergy(const core::RayHitData &hitdata);
 
-  void setEnergy(const EnergyPerTime &en);
-  const EnergyPerTime &getEnergy() const;
+  void setEnergy(const EnergyHistogram &en);
+  const EnergyHistogram &getEnergy() const;
   void addEnergy(float acquisitionTime, float energy);
+  void addEnergy(const EnergyHistogram &energy);
+  void scaleEnergy(float factor);
+  // Preallocates memory for energy that arrives before |maxTime| [s].
+  void reserveEnergy(float maxTime);
   void printItself(std::ostream &os) const noexcept override;
 
 private:
-  EnergyPerTime collectedEnergy_;
+  EnergyHistogram collectedEnergy_;
 };
 
 class TriangleObj : public Object {
 public:
+  // Attributes computed from points by refreshAttributes().
+  struct Attributes {
+    core::Vec3 normal, edge1, edge2, origin;
+    float area, parallelThreshold;
+  };
+
   TriangleObj(const core::Vec3 &point1 = core::Vec3::kX,
               const core::Vec3 &point2 = core::Vec3::kY,
               const core::Vec3 &point3 = core::Vec3::kZ);
+  // Creates triangle with |attributes| of the triangle with the same points,
+  // saved earlier e.g. in the model cache. Points are not validated and
+  // attributes are not recomputed.
+  TriangleObj(const core::Vec3 &point1, const core::Vec3 &point2,
+              const core::Vec3 &point3, const Attributes &attributes);
   TriangleObj(const TriangleObj &other);
 
   TriangleObj &operator=(const TriangleObj &other);
@@ -106,8 +119,33 @@ public:
   [[nodiscard]] bool hitObject(const core::Ray &ray, float freq,
                                core::RayHitData *hitData) const override;
 
+  // Calculates |time| at which |ray| hits the triangle and barycentric
+  // coordinates |u|, |v| of the hit point, such that hit point is equal to:
+  // (1 - u - v) * point1 + u * point2 + v * point3. Output arguments are
+  // modified only when hit occurred. Uses Moller-Trumbore algorithm, unless
+  // AREA_SUM_TRIANGLE_INTERSECTION is defined at compile time.
+  [[nodiscard]] bool intersect(const core::Ray &ray, float *time, float *u,
+                               float *v) const;
+  // Moller-Trumbore ray-triangle intersection working on edges precomputed in
+  // refreshAttributes(), without any square roots.
+  [[nodiscard]] bool intersectMollerTrumbore(const core::Ray &ray, float *time,
+                                             float *u, float *v) const;
+  // Finds hit with the plane of the triangle and checks if the hit point is
+  // inside by comparing sum of areas of sub-triangles with the area of the
+  // triangle.
+  [[nodiscard]] bool intersectAreaSum(const core::Ray &ray, float *time,
+                                      float *u, float *v) const;
+  // Maximum distance from the triangle at which intersect() can still
+  // report hit.
+  float hitMargin() const;
+  // Data precomputed for Moller-Trumbore algorithm, used by TrianglePack.
+  const core::Vec3 &edge1() const { return edge1_; }
+  const core::Vec3 &edge2() const { return edge2_; }
+  float parallelThreshold() const { return parallelThreshold_; }
+
   float area() const;
   void refreshAttributes();
+  Attributes attributes() const;
 
   core::Vec3 point1() const;
   void setPoint1(const core::Vec3 &point);
@@ -122,13 +160,17 @@ public:
   void printItself(std::ostream &os) const noexcept override;
 
 private:
-  bool doesHit(const core::Vec3 &point) const;
-
   void recalculateNormal();
   void recalculateArea();
+  void recalculateEdges();
   bool arePointsValid();
   core::Vec3 normal_, point1_, point2_, point3_;
+  // |edge1_| = |point2_| - |point1_|, |edge2_| = |point3_| - |point1_|
+  core::Vec3 edge1_, edge2_;
   float area_;
+  // Minimal absolute value of determinant in Moller-Trumbore algorithm.
+  // Equivalent of rejecting rays for which cos(ray, normal) <= kAccuracy.
+  float parallelThreshold_;
 };
 
 } // namespace objects
@@ -0,0 +1,351 @@
+#include "obj/trianglePack.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace objects {
+
+TrianglePack::TrianglePack() : size(0) {
+  for (int lane = 0; lane < kWidth; ++lane) {
+    point1X[lane] = point1Y[lane] = point1Z[lane] = 0;
+    edge1X[lane] = edge1Y[lane] = edge1Z[lane] = 0;
+    edge2X[lane] = edge2Y[lane] = edge2Z[lane] = 0;
+    parallelThreshold[lane] = std::numeric_limits<float>::infinity();
+    triangleIndex[lane] = kEmptyLane;
+  }
+}
+
+bool TrianglePack::add(const TriangleObj &triangle, uint32_t index) {
+  if (size >= kWidth) {
+    return false;
+  }
+  const core::Vec3 point1 = triangle.point1();
+  point1X[size] = point1.x();
+  point1Y[size] = point1.y();
+  point1Z[size] = point1.z();
+  edge1X[size] = triangle.edge1().x();
+  edge1Y[size] = triangle.edge1().y();
+  edge1Z[size] = triangle.edge1().z();
+  edge2X[size] = triangle.edge2().x();
+  edge2Y[size] = triangle.edge2().y();
+  edge2Z[size] = triangle.edge2().z();
+  parallelThreshold[size] = triangle.parallelThreshold();
+  triangleIndex[size] = index;
+  ++size;
+  return true;
+}
+
+PackedRay::PackedRay(const core::Ray &ray) {
+  const core::Vec3 origin = ray.origin();
+  const core::Vec3 direction = ray.direction();
+  originX = origin.x();
+  originY = origin.y();
+  originZ = origin.z();
+  directionX = direction.x();
+  directionY = direction.y();
+  directionZ = direction.z();
+}
+
+namespace {
+
+// Keeps the closest hit, ties are resolved towards lower triangle index, so
+// that result does not depend on the order of triangles in packs.
+inline bool updateClosest(float time, uint32_t triangle, float *closestTime,
+                          uint32_t *closestTriangle) {
+  if (time < *closestTime ||
+      (time == *closestTime && triangle < *closestTriangle)) {
+    *closestTime = time;
+    *closestTriangle = triangle;
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+// NOTE: All kernels perform exactly the same operations in the same order as
+// TriangleObj::intersectMollerTrumbore(), so that they return bit-identical
+// hit times.
+bool intersectTrianglePackScalar(const TrianglePack &pack, const PackedRay &ray,
+                                 float *closestTime,
+                                 uint32_t *closestTriangle) {
+  const float kLow = -constants::kBarycentricAccuracy;
+  const float kHigh = 1 + constants::kBarycentricAccuracy;
+  bool updated = false;
+  for (int lane = 0; lane < pack.size; ++lane) {
+    const float pX = ray.directionY * pack.edge2Z[lane] -
+                     ray.directionZ * pack.edge2Y[lane];
+    const float pY = ray.directionZ * pack.edge2X[lane] -
+                     ray.directionX * pack.edge2Z[lane];
+    const float pZ = ray.directionX * pack.edge2Y[lane] -
+                     ray.directionY * pack.edge2X[lane];
+    const float determinant = pack.edge1X[lane] * pX +
+                              pack.edge1Y[lane] * pY +
+                              pack.edge1Z[lane] * pZ;
+    if (std::abs(determinant) <= pack.parallelThreshold[lane]) {
+      continue;
+    }
+    const float inverseDeterminant = 1.0f / determinant;
+
+    const float tX = ray.originX - pack.point1X[lane];
+    const float tY = ray.originY - pack.point1Y[lane];
+    const float tZ = ray.originZ - pack.point1Z[lane];
+    const float u = (tX * pX + tY * pY + tZ * pZ) * inverseDeterminant;
+    if (u < kLow || u > kHigh) {
+      continue;
+    }
+
+    const float qX = tY * pack.edge1Z[lane] - tZ * pack.edge1Y[lane];
+    const float qY = tZ * pack.edge1X[lane] - tX * pack.edge1Z[lane];
+    const float qZ = tX * pack.edge1Y[lane] - tY * pack.edge1X[lane];
+    const float v = (ray.directionX * qX + ray.directionY * qY +
+                     ray.directionZ * qZ) *
+                    inverseDeterminant;
+    if (v < kLow || u + v > kHigh) {
+      continue;
+    }
+
+    const float time = (pack.edge2X[lane] * qX + pack.edge2Y[lane] * qY +
+                        pack.edge2Z[lane] * qZ) *
+                       inverseDeterminant;
+    if (time < constants::kAccuracy) {
+      continue;
+    }
+    updated |= updateClosest(time, pack.triangleIndex[lane], closestTime,
+                             closestTriangle);
+  }
+  return updated;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+bool intersectTrianglePackSse(const TrianglePack &pack, const PackedRay &ray,
+                              float *closestTime, uint32_t *closestTriangle) {
+  const __m128 kLow = _mm_set1_ps(-constants::kBarycentricAccuracy);
+  const __m128 kHigh = _mm_set1_ps(1 + constants::kBarycentricAccuracy);
+  const __m128 kMinTime = _mm_set1_ps(constants::kAccuracy);
+  const __m128 kSignMask = _mm_set1_ps(-0.0f);
+  const __m128 directionX = _mm_set1_ps(ray.directionX);
+  const __m128 directionY = _mm_set1_ps(ray.directionY);
+  const __m128 directionZ = _mm_set1_ps(ray.directionZ);
+  const __m128 originX = _mm_set1_ps(ray.originX);
+  const __m128 originY = _mm_set1_ps(ray.originY);
+  const __m128 originZ = _mm_set1_ps(ray.originZ);
+
+  bool updated = false;
+  for (int offset = 0; offset < pack.size; offset += 4) {
+    const __m128 edge1X = _mm_load_ps(pack.edge1X + offset);
+    const __m128 edge1Y = _mm_load_ps(pack.edge1Y + offset);
+    const __m128 edge1Z = _mm_load_ps(pack.edge1Z + offset);
+    const __m128 edge2X = _mm_load_ps(pack.edge2X + offset);
+    const __m128 edge2Y = _mm_load_ps(pack.edge2Y + offset);
+    const __m128 edge2Z = _mm_load_ps(pack.edge2Z + offset);
+
+    const __m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z),
+                                 _mm_mul_ps(directionZ, edge2Y));
+    const __m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X),
+                                 _mm_mul_ps(directionX, edge2Z));
+    const __m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y),
+                                 _mm_mul_ps(directionY, edge2X));
+    const __m128 determinant =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)),
+                   _mm_mul_ps(edge1Z, pZ));
+    __m128 mask =
+        _mm_cmpgt_ps(_mm_andnot_ps(kSignMask, determinant),
+                     _mm_load_ps(pack.parallelThreshold + offset));
+    if (_mm_movemask_ps(mask) == 0) {
+      continue;
+    }
+    const __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+    const __m128 tX = _mm_sub_ps(originX, _mm_load_ps(pack.point1X + offset));
+    const __m128 tY = _mm_sub_ps(originY, _mm_load_ps(pack.point1Y + offset));
+    const __m128 tZ = _mm_sub_ps(originZ, _mm_load_ps(pack.point1Z + offset));
+    const __m128 u = _mm_mul_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(tX, pX), _mm_mul_ps(tY, pY)),
+                   _mm_mul_ps(tZ, pZ)),
+        inverseDeterminant);
+    mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, kLow),
+                                       _mm_cmple_ps(u, kHigh)));
+
+    const __m128 qX =
+        _mm_sub_ps(_mm_mul_ps(tY, edge1Z), _mm_mul_ps(tZ, edge1Y));
+    const __m128 qY =
+        _mm_sub_ps(_mm_mul_ps(tZ, edge1X), _mm_mul_ps(tX, edge1Z));
+    const __m128 qZ =
+        _mm_sub_ps(_mm_mul_ps(tX, edge1Y), _mm_mul_ps(tY, edge1X));
+    const __m128 v = _mm_mul_ps(
+        _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)),
+            _mm_mul_ps(directionZ, qZ)),
+        inverseDeterminant);
+    mask = _mm_and_ps(mask,
+                      _mm_and_ps(_mm_cmpge_ps(v, kLow),
+                                 _mm_cmple_ps(_mm_add_ps(u, v), kHigh)));
+
+    const __m128 time = _mm_mul_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)),
+                   _mm_mul_ps(edge2Z, qZ)),
+        inverseDeterminant);
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(time, kMinTime));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(time, _mm_set1_ps(*closestTime)));
+
+    int hits = _mm_movemask_ps(mask);
+    if (hits == 0) {
+      continue;
+    }
+    alignas(16) float times[4];
+    _mm_store_ps(times, time);
+    for (int lane = 0; lane < 4; ++lane) {
+      if (hits & (1 << lane)) {
+        updated |= updateClosest(times[lane],
+                                 pack.triangleIndex[offset + lane],
+                                 closestTime, closestTriangle);
+      }
+    }
+  }
+  return updated;
+}
+
+__attribute__((target("avx2"))) bool
+intersectTrianglePackAvx2(const TrianglePack &pack, const PackedRay &ray,
+                          float *closestTime, uint32_t *closestTriangle) {
+  const __m256 kLow = _mm256_set1_ps(-constants::kBarycentricAccuracy);
+  const __m256 kHigh = _mm256_set1_ps(1 + constants::kBarycentricAccuracy);
+  const __m256 kMinTime = _mm256_set1_ps(constants::kAccuracy);
+  const __m256 kSignMask = _mm256_set1_ps(-0.0f);
+  const __m256 directionX = _mm256_set1_ps(ray.directionX);
+  const __m256 directionY = _mm256_set1_ps(ray.directionY);
+  const __m256 directionZ = _mm256_set1_ps(ray.directionZ);
+
+  const __m256 edge1X = _mm256_load_ps(pack.edge1X);
+  const __m256 edge1Y = _mm256_load_ps(pack.edge1Y);
+  const __m256 edge1Z = _mm256_load_ps(pack.edge1Z);
+  const __m256 edge2X = _mm256_load_ps(pack.edge2X);
+  const __m256 edge2Y = _mm256_load_ps(pack.edge2Y);
+  const __m256 edge2Z = _mm256_load_ps(pack.edge2Z);
+
+  const __m256 pX = _mm256_sub_ps(_mm256_mul_ps(directionY, edge2Z),
+                                  _mm256_mul_ps(directionZ, edge2Y));
+  const __m256 pY = _mm256_sub_ps(_mm256_mul_ps(directionZ, edge2X),
+                                  _mm256_mul_ps(directionX, edge2Z));
+  const __m256 pZ = _mm256_sub_ps(_mm256_mul_ps(directionX, edge2Y),
+                                  _mm256_mul_ps(directionY, edge2X));
+  const __m256 determinant = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(edge1X, pX), _mm256_mul_ps(edge1Y, pY)),
+      _mm256_mul_ps(edge1Z, pZ));
+  __m256 mask = _mm256_cmp_ps(_mm256_andnot_ps(kSignMask, determinant),
+                              _mm256_load_ps(pack.parallelThreshold),
+                              _CMP_GT_OQ);
+  if (_mm256_movemask_ps(mask) == 0) {
+    return false;
+  }
+  const __m256 inverseDeterminant =
+      _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+  const __m256 tX =
+      _mm256_sub_ps(_mm256_set1_ps(ray.originX), _mm256_load_ps(pack.point1X));
+  const __m256 tY =
+      _mm256_sub_ps(_mm256_set1_ps(ray.originY), _mm256_load_ps(pack.point1Y));
+  const __m256 tZ =
+      _mm256_sub_ps(_mm256_set1_ps(ray.originZ), _mm256_load_ps(pack.point1Z));
+  const __m256 u = _mm256_mul_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tX, pX), _mm256_mul_ps(tY, pY)),
+                    _mm256_mul_ps(tZ, pZ)),
+      inverseDeterminant);
+  mask = _mm256_and_ps(mask,
+                       _mm256_and_ps(_mm256_cmp_ps(u, kLow, _CMP_GE_OQ),
+                                     _mm256_cmp_ps(u, kHigh, _CMP_LE_OQ)));
+
+  const __m256 qX =
+      _mm256_sub_ps(_mm256_mul_ps(tY, edge1Z), _mm256_mul_ps(tZ, edge1Y));
+  const __m256 qY =
+      _mm256_sub_ps(_mm256_mul_ps(tZ, edge1X), _mm256_mul_ps(tX, edge1Z));
+  const __m256 qZ =
+      _mm256_sub_ps(_mm256_mul_ps(tX, edge1Y), _mm256_mul_ps(tY, edge1X));
+  const __m256 v = _mm256_mul_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(directionX, qX),
+                                  _mm256_mul_ps(directionY, qY)),
+                    _mm256_mul_ps(directionZ, qZ)),
+      inverseDeterminant);
+  mask = _mm256_and_ps(
+      mask, _mm256_and_ps(
+                _mm256_cmp_ps(v, kLow, _CMP_GE_OQ),
+                _mm256_cmp_ps(_mm256_add_ps(u, v), kHigh, _CMP_LE_OQ)));
+
+  const __m256 time = _mm256_mul_ps(
+      _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(edge2X, qX), _mm256_mul_ps(edge2Y, qY)),
+          _mm256_mul_ps(edge2Z, qZ)),
+      inverseDeterminant);
+  mask = _mm256_and_ps(mask, _mm256_cmp_ps(time, kMinTime, _CMP_GE_OQ));
+  mask = _mm256_and_ps(mask, _mm256_cmp_ps(time, _mm256_set1_ps(*closestTime),
+                                           _CMP_LE_OQ));
+
+  int hits = _mm256_movemask_ps(mask);
+  if (hits == 0) {
+    return false;
+  }
+  alignas(32) float times[TrianglePack::kWidth];
+  _mm256_store_ps(times, time);
+  bool updated = false;
+  for (int lane = 0; lane < TrianglePack::kWidth; ++lane) {
+    if (hits & (1 << lane)) {
+      updated |= updateClosest(times[lane], pack.triangleIndex[lane],
+                               closestTime, closestTriangle);
+    }
+  }
+  return updated;
+}
+
+#endif
+
+SimdLevel detectSimdLevel() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::kAvx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SimdLevel::kSse;
+  }
+#endif
+  return SimdLevel::kScalar;
+}
+
+bool isSimdLevelSupported(SimdLevel level) {
+  return static_cast<int>(level) <= static_cast<int>(detectSimdLevel());
+}
+
+TrianglePackKernel getTrianglePackKernel(SimdLevel level) {
+  switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+  case SimdLevel::kAvx2:
+    return &intersectTrianglePackAvx2;
+  case SimdLevel::kSse:
+    return &intersectTrianglePackSse;
+#endif
+  default:
+    return &intersectTrianglePackScalar;
+  }
+}
+
+TrianglePackKernel getTrianglePackKernel() {
+  static const TrianglePackKernel kernel =
+      getTrianglePackKernel(detectSimdLevel());
+  return kernel;
+}
+
+std::string_view simdLevelName(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::kAvx2:
+    return "AVX2";
+  case SimdLevel::kSse:
+    return "SSE";
+  default:
+    return "Scalar";
+  }
+}
+
+} // namespace objects
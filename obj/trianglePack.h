@@ -0,0 +1,76 @@
+#ifndef TRIANGLE_PACK_H
+#define TRIANGLE_PACK_H
+
+#include "core/constants.h"
+#include "core/ray.h"
+#include "obj/objects.h"
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace objects {
+
+// Holds up to |kWidth| triangles as structure of arrays, so that one ray can
+// be tested against all of them with a single SIMD instruction stream. Only
+// data needed by Moller-Trumbore algorithm is stored. Unused lanes have
+// infinite |parallelThreshold|, so they are never hit.
+struct alignas(32) TrianglePack {
+  static constexpr int kWidth = 8;
+  static constexpr uint32_t kEmptyLane = std::numeric_limits<uint32_t>::max();
+
+  TrianglePack();
+  // Puts |triangle| into the first free lane. |triangleIndex| is the index of
+  // the triangle in the model. Returns false when pack is already full.
+  bool add(const TriangleObj &triangle, uint32_t triangleIndex);
+
+  float point1X[kWidth], point1Y[kWidth], point1Z[kWidth];
+  float edge1X[kWidth], edge1Y[kWidth], edge1Z[kWidth];
+  float edge2X[kWidth], edge2Y[kWidth], edge2Z[kWidth];
+  float parallelThreshold[kWidth];
+  uint32_t triangleIndex[kWidth];
+  int size;
+};
+
+// Ray converted into plain floats once per trace.
+struct PackedRay {
+  explicit PackedRay(const core::Ray &ray);
+  float originX, originY, originZ;
+  float directionX, directionY, directionZ;
+};
+
+// Tests |ray| against every triangle in the |pack|. When triangle is hit
+// earlier than |closestTime|, or at the same time but with lower triangle
+// index than |closestTriangle|, both values are updated. Returns true if
+// they were updated. Gives exactly the same hit times as
+// TriangleObj::intersectMollerTrumbore().
+using TrianglePackKernel = bool (*)(const TrianglePack &pack,
+                                    const PackedRay &ray, float *closestTime,
+                                    uint32_t *closestTriangle);
+
+enum class SimdLevel { kScalar, kSse, kAvx2 };
+
+bool intersectTrianglePackScalar(const TrianglePack &pack, const PackedRay &ray,
+                                 float *closestTime, uint32_t *closestTriangle);
+#if defined(__x86_64__) || defined(__i386__)
+// Processes pack as two halves of 4 triangles.
+bool intersectTrianglePackSse(const TrianglePack &pack, const PackedRay &ray,
+                              float *closestTime, uint32_t *closestTriangle);
+// Processes whole pack at once, requires CPU with AVX2 support.
+bool intersectTrianglePackAvx2(const TrianglePack &pack, const PackedRay &ray,
+                               float *closestTime, uint32_t *closestTriangle);
+#endif
+
+// Returns the best SIMD level supported by the CPU running the program.
+SimdLevel detectSimdLevel();
+// Returns true if kernel of given |level| can be run on this CPU.
+bool isSimdLevelSupported(SimdLevel level);
+TrianglePackKernel getTrianglePackKernel(SimdLevel level);
+// Kernel chosen once at runtime for the current CPU.
+TrianglePackKernel getTrianglePackKernel();
+std::string_view simdLevelName(SimdLevel level);
+
+} // namespace objects
+
+#endif
@@ -0,0 +1,206 @@
+#include "main/checkpoint.h"
+#include "main/model.h"
+#include "main/sceneManager.h"
+#include "main/trackers.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using checkpoints::BandProgress;
+using checkpoints::Checkpoint;
+
+Checkpoint makeCheckpoint(int nextRay, int firstRay = 0, int lastRay = 400) {
+  auto band = std::make_shared<BandProgress>();
+  band->frequency = 500;
+  band->firstRay = firstRay;
+  band->nextRay = nextRay;
+  band->lastRay = lastRay;
+  band->numOfRays = 400;
+  band->statistics.depthLimit = 5;
+  band->statistics.maxReachedDepth = 3;
+  band->statistics.maxPendingRays = 12;
+  band->statistics.emittedEnergy = 100;
+  band->statistics.discardedRays = 2;
+  band->statistics.discardedEnergy = 0.5;
+  band->statistics.energyAtDepthLimit = 1.25;
+
+  objects::EnergyHistogram sparse;
+  sparse.addEnergy(0.001, 1.5);
+  sparse.addEnergy(0.25, 2.5);
+  band->energies = {sparse, objects::EnergyHistogram(44100)};
+
+  Checkpoint checkpoint;
+  checkpoint.fingerprint = fnv1aHash("simulation");
+  checkpoint.collectors = {{core::Vec3(0, 0, 1), 0.5},
+                           {core::Vec3(1, 0, 0), 0.5}};
+  checkpoint.bands = {band};
+  return checkpoint;
+}
+
+void expectEqual(const Checkpoint &expected, const Checkpoint &actual) {
+  ASSERT_EQ(expected.fingerprint, actual.fingerprint);
+  ASSERT_EQ(expected.collectors.size(), actual.collectors.size());
+  for (size_t index = 0; index < expected.collectors.size(); ++index) {
+    ASSERT_EQ(expected.collectors[index].origin,
+              actual.collectors[index].origin);
+    ASSERT_EQ(expected.collectors[index].radius,
+              actual.collectors[index].radius);
+  }
+  ASSERT_EQ(expected.bands.size(), actual.bands.size());
+  for (size_t index = 0; index < expected.bands.size(); ++index) {
+    const BandProgress &expectedBand = *expected.bands[index];
+    const BandProgress &actualBand = *actual.bands[index];
+    ASSERT_EQ(expectedBand.frequency, actualBand.frequency);
+    ASSERT_EQ(expectedBand.firstRay, actualBand.firstRay);
+    ASSERT_EQ(expectedBand.nextRay, actualBand.nextRay);
+    ASSERT_EQ(expectedBand.lastRay, actualBand.lastRay);
+    ASSERT_EQ(expectedBand.numOfRays, actualBand.numOfRays);
+    ASSERT_EQ(expectedBand.energies, actualBand.energies);
+    ASSERT_EQ(expectedBand.statistics.maxPendingRays,
+              actualBand.statistics.maxPendingRays);
+    ASSERT_EQ(expectedBand.statistics.discardedEnergy,
+              actualBand.statistics.discardedEnergy);
+    ASSERT_EQ(expectedBand.statistics.energyAtDepthLimit,
+              actualBand.statistics.energyAtDepthLimit);
+  }
+}
+
+TEST(CheckpointTest, WrittenCheckpointIsReadTheSame) {
+  Checkpoint checkpoint = makeCheckpoint(/*nextRay=*/100);
+  std::stringstream stream;
+  checkpoints::write(checkpoint, stream);
+  expectEqual(checkpoint, checkpoints::read(stream));
+  ASSERT_FALSE(checkpoint.bands[0]->completed());
+}
+
+TEST(CheckpointTest, InvalidCheckpointThrows) {
+  std::stringstream stream;
+  checkpoints::write(makeCheckpoint(/*nextRay=*/100), stream);
+  const std::string data = stream.str();
+
+  std::stringstream truncated(data.substr(0, data.size() - 1));
+  ASSERT_THROW(checkpoints::read(truncated), std::invalid_argument);
+  std::stringstream notCheckpoint("{\"name\": \"Diffusion Coefficient\"}");
+  ASSERT_THROW(checkpoints::read(notCheckpoint), std::invalid_argument);
+  ASSERT_EQ(checkpoints::load("./doesNotExist.checkpoint"), std::nullopt);
+}
+
+TEST(CheckpointTest, WriterSavesTheNewestCheckpoint) {
+  const std::string path = ::testing::TempDir() + "writer.checkpoint";
+  std::remove(path.c_str());
+  {
+    checkpoints::AsyncCheckpointWriter writer(path);
+    for (int nextRay = 0; nextRay <= 400; nextRay += 100) {
+      writer.save(makeCheckpoint(nextRay));
+    }
+    writer.flush();
+    ASSERT_GE(writer.numOfWrites(), 1);
+    ASSERT_LE(writer.numOfWrites(), 5);
+  }
+  std::optional<Checkpoint> loaded = checkpoints::load(path);
+  ASSERT_TRUE(loaded);
+  expectEqual(makeCheckpoint(/*nextRay=*/400), *loaded);
+  ASSERT_TRUE(loaded->bands[0]->completed());
+
+  checkpoints::AsyncCheckpointWriter invalidPath("./doesNotExist/checkpoint");
+  invalidPath.save(makeCheckpoint(/*nextRay=*/0));
+  ASSERT_THROW(invalidPath.flush(), std::invalid_argument);
+}
+
+TEST(CheckpointTest, MergesShardsInOrderOfRays) {
+  Checkpoint merged = checkpoints::mergeShards(
+      {makeCheckpoint(/*nextRay=*/400, /*firstRay=*/300, /*lastRay=*/400),
+       makeCheckpoint(/*nextRay=*/300, /*firstRay=*/0, /*lastRay=*/300)});
+  ASSERT_EQ(merged.bands.size(), 1);
+  const BandProgress &band = *merged.bands[0];
+  ASSERT_TRUE(band.completed());
+  ASSERT_EQ(band.firstRay, 0);
+  ASSERT_EQ(band.lastRay, 400);
+  ASSERT_EQ(band.statistics.emittedEnergy, 200);
+  ASSERT_EQ(band.statistics.discardedRays, 4);
+  ASSERT_FLOAT_EQ(band.energies[0].totalEnergy(), 8);
+
+  std::unordered_map<float, Collectors> collectors =
+      checkpoints::toCollectors(merged);
+  ASSERT_EQ(collectors.at(500).size(), 2);
+  ASSERT_EQ(collectors.at(500)[1]->getOrigin(), core::Vec3(1, 0, 0));
+  ASSERT_EQ(collectors.at(500)[0]->getEnergy(), band.energies[0]);
+
+  // Not completed shard.
+  ASSERT_THROW(checkpoints::mergeShards(
+                   {makeCheckpoint(/*nextRay=*/200, /*firstRay=*/0, 300),
+                    makeCheckpoint(/*nextRay=*/400, /*firstRay=*/300, 400)}),
+               std::invalid_argument);
+  // Missing and overlapping rays.
+  ASSERT_THROW(checkpoints::mergeShards(
+                   {makeCheckpoint(/*nextRay=*/300, /*firstRay=*/0, 300)}),
+               std::invalid_argument);
+  ASSERT_THROW(checkpoints::mergeShards(
+                   {makeCheckpoint(/*nextRay=*/300, /*firstRay=*/0, 300),
+                    makeCheckpoint(/*nextRay=*/400, /*firstRay=*/200, 400)}),
+               std::invalid_argument);
+  // Shard of a different simulation.
+  Checkpoint other = makeCheckpoint(/*nextRay=*/400, /*firstRay=*/300, 400);
+  other.fingerprint = fnv1aHash("other simulation");
+  ASSERT_THROW(checkpoints::mergeShards(
+                   {makeCheckpoint(/*nextRay=*/300, /*firstRay=*/0, 300),
+                    other}),
+               std::invalid_argument);
+}
+
+TEST(CheckpointTest, MergesShardsTracedWithDifferentNumberOfThreads) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(/*modelSize=*/1);
+  collectionRules::LinearEnergyCollection energyCollectionRules;
+  SimpleFourSidedReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+  trackers::FakePositionTracker positionTracker;
+  trackers::FakeCollectorsTracker collectorsTracker;
+  BasicSimulationProperties basicProperties({250, 1000}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/20,
+                                            /*maxTracking=*/3);
+
+  SceneManager wholeManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> whole =
+      wholeManager.newRun(&collectorBuilder);
+
+  // Every shard is traced by a machine with a different number of threads.
+  basicProperties.numOfShards = 3;
+  std::vector<Checkpoint> shards;
+  for (int shard = 0; shard < basicProperties.numOfShards; ++shard) {
+    basicProperties.shardIndex = shard;
+    basicProperties.numOfThreads = shard + 1;
+    basicProperties.raysPerCheckpoint = 50 * (shard + 1);
+    basicProperties.checkpointPath =
+        ::testing::TempDir() + "checkpoint.shard." + std::to_string(shard);
+    std::remove(basicProperties.checkpointPath.c_str());
+    SceneManager shardManager(
+        model.get(),
+        SimulationProperties(&energyCollectionRules, basicProperties),
+        &positionTracker, &collectorsTracker, &reflectionEngine);
+    shardManager.newRun(&collectorBuilder);
+    shards.push_back(*checkpoints::load(basicProperties.checkpointPath));
+    std::remove(basicProperties.checkpointPath.c_str());
+  }
+
+  std::unordered_map<float, Collectors> merged =
+      checkpoints::toCollectors(checkpoints::mergeShards(shards));
+  for (float frequency : basicProperties.frequencies) {
+    ASSERT_EQ(merged.at(frequency).size(), whole.at(frequency).size());
+    for (size_t index = 0; index < whole.at(frequency).size(); ++index) {
+      const float wholeEnergy =
+          whole.at(frequency)[index]->getEnergy().totalEnergy();
+      ASSERT_NEAR(wholeEnergy,
+                  merged.at(frequency)[index]->getEnergy().totalEnergy(),
+                  1e-4 * wholeEnergy)
+          << "frequency: " << frequency << ", collector: " << index;
+    }
+  }
+}
@@ -0,0 +1,62 @@
+#include "core/counterRandom.h"
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+using core::CounterRandomStream;
+
+// Known answer tests from the Random123 library.
+TEST(CounterRandomTest, PhiloxKnownAnswers) {
+  using Block = std::array<uint32_t, 4>;
+  ASSERT_EQ((Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}),
+            core::philox4x32({0, 0, 0, 0}, {0, 0}));
+  ASSERT_EQ((Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}),
+            core::philox4x32(
+                {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                {0xffffffff, 0xffffffff}));
+  ASSERT_EQ((Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}),
+            core::philox4x32(
+                {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                {0xa4093822, 0x299f31d0}));
+}
+
+TEST(CounterRandomTest, StreamsAreReproducible) {
+  CounterRandomStream first(/*seed=*/42, 1, 2, 3);
+  CounterRandomStream second(/*seed=*/42, 1, 2, 3);
+  CounterRandomStream otherSeed(/*seed=*/43, 1, 2, 3);
+  CounterRandomStream otherStream(/*seed=*/42, 1, 2, 4);
+  CounterRandomStream otherHighWord(/*seed=*/42, 1, 2, 3 + (1ull << 32));
+  int numOfDifferentValues = 0;
+  for (int index = 0; index < 100; ++index) {
+    float value = first.nextFloat();
+    ASSERT_EQ(value, second.nextFloat());
+    ASSERT_GE(value, -1);
+    ASSERT_LT(value, 1);
+    if (value != otherSeed.nextFloat() && value != otherStream.nextFloat() &&
+        value != otherHighWord.nextFloat()) {
+      ++numOfDifferentValues;
+    }
+  }
+  ASSERT_GT(numOfDifferentValues, 95);
+}
+
+TEST(CounterRandomTest, ChildPathIdsAreUnique) {
+  std::unordered_set<uint64_t> pathIds = {0};
+  std::vector<uint64_t> currentLevel = {0};
+  // Five children per reflection, as in SimpleFourSidedReflectionEngine.
+  for (int depth = 0; depth < 8; ++depth) {
+    std::vector<uint64_t> nextLevel;
+    for (uint64_t pathId : currentLevel) {
+      for (uint32_t child = 0; child < 5; ++child) {
+        uint64_t childId = CounterRandomStream::childPathId(pathId, child);
+        ASSERT_TRUE(pathIds.insert(childId).second)
+            << "depth: " << depth << ", child: " << child;
+        nextLevel.push_back(childId);
+      }
+    }
+    currentLevel = std::move(nextLevel);
+  }
+}
@@ -3,11 +3,16 @@
 #include "obj/objects.h"
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <vector>
+
 using constants::kSimulationHeight;
 using core::Ray;
 using core::RayHitData;
 using core::Vec3;
 using generators::PointSpeakerRayFactory;
+using generators::QuasiRandomSpeakerRayFactory;
+using Sequence = generators::QuasiRandomSpeakerRayFactory::Sequence;
 using objects::TriangleObj;
 
 const float kSkipPower = 0;
@@ -93,4 +98,112 @@ TEST(PointSpeakerRayFactoryTest, RayDistributionAtModelTest) {
   ASSERT_EQ(referenceRightUpperCorner, current);
 
   ASSERT_FALSE(rayFactory.genRay(&current));
-}
\ No newline at end of file
+}
+
+// Checks that each of |numOfCellsX| x |numOfCellsY| cells of the unit square
+// contains exactly one of the first points of the |factory| sequence.
+void expectOnePointInEveryCell(const QuasiRandomSpeakerRayFactory &factory,
+                               int numOfCellsX, int numOfCellsY) {
+  std::vector<int> pointsInCell(numOfCellsX * numOfCellsY, 0);
+  for (int index = 0; index < numOfCellsX * numOfCellsY; ++index) {
+    auto [u, v] = factory.unitSquarePoint(index);
+    ASSERT_GE(u, 0);
+    ASSERT_LT(u, 1);
+    ASSERT_GE(v, 0);
+    ASSERT_LT(v, 1);
+    int cellX = std::floor(u * numOfCellsX);
+    int cellY = std::floor(v * numOfCellsY);
+    ++pointsInCell[cellY * numOfCellsX + cellX];
+  }
+  for (int points : pointsInCell) {
+    ASSERT_EQ(points, 1);
+  }
+}
+
+TEST(QuasiRandomSpeakerRayFactoryTest, EnergyPerRayIsTheSameAsInGrid) {
+  FakeModel model;
+  const int kNumOfRays = 100;
+  const float kPower = 900;
+  QuasiRandomSpeakerRayFactory rayFactory(kNumOfRays, kPower, &model);
+  PointSpeakerRayFactory gridFactory(10, kPower, &model);
+  ASSERT_EQ(rayFactory.origin(), gridFactory.origin());
+
+  Ray ray, gridRay, indexedRay;
+  ASSERT_TRUE(gridFactory.genRay(&gridRay));
+  for (int index = 0; index < kNumOfRays; ++index) {
+    ASSERT_TRUE(rayFactory.genRay(&ray));
+    ASSERT_TRUE(rayFactory.rayAt(index, &indexedRay));
+    ASSERT_EQ(ray, indexedRay);
+    ASSERT_EQ(ray.energy(), gridRay.energy());
+  }
+  ASSERT_FALSE(rayFactory.genRay(&ray));
+  ASSERT_FALSE(rayFactory.rayAt(kNumOfRays, &ray));
+}
+
+TEST(QuasiRandomSpeakerRayFactoryTest, RaysHitModelAtSequencePoints) {
+  FakeModel model;
+  QuasiRandomSpeakerRayFactory rayFactory(16, kSkipPower, &model);
+  for (int index = 0; index < rayFactory.numOfRays(); ++index) {
+    Ray ray;
+    ASSERT_TRUE(rayFactory.rayAt(index, &ray));
+    float distance = (model.height() - ray.origin().z()) / ray.direction().z();
+    Vec3 hitPoint = ray.origin() + distance * ray.direction();
+    auto [u, v] = rayFactory.unitSquarePoint(index);
+    ASSERT_NEAR(hitPoint.x(), (2 * u - 1) * model.sideSize(), 1e-4);
+    ASSERT_NEAR(hitPoint.y(), (2 * v - 1) * model.sideSize(), 1e-4);
+  }
+}
+
+TEST(QuasiRandomSpeakerRayFactoryTest, SobolPointsAreStratified) {
+  FakeModel model;
+  QuasiRandomSpeakerRayFactory sobol(256, kSkipPower, &model, Sequence::kSobol);
+  QuasiRandomSpeakerRayFactory scrambled(256, kSkipPower, &model,
+                                         Sequence::kSobol,
+                                         /*scramblingSeed=*/7);
+  for (const QuasiRandomSpeakerRayFactory *factory : {&sobol, &scrambled}) {
+    expectOnePointInEveryCell(*factory, 16, 16);
+    expectOnePointInEveryCell(*factory, 256, 1);
+    expectOnePointInEveryCell(*factory, 1, 256);
+    expectOnePointInEveryCell(*factory, 32, 8);
+  }
+}
+
+TEST(QuasiRandomSpeakerRayFactoryTest, HaltonPointsAreStratified) {
+  FakeModel model;
+  QuasiRandomSpeakerRayFactory halton(432, kSkipPower, &model,
+                                      Sequence::kHalton);
+  expectOnePointInEveryCell(halton, 16, 27);
+}
+
+TEST(QuasiRandomSpeakerRayFactoryTest, ScramblingDependsOnSeed) {
+  FakeModel model;
+  QuasiRandomSpeakerRayFactory sobol(64, kSkipPower, &model, Sequence::kSobol);
+  QuasiRandomSpeakerRayFactory first(64, kSkipPower, &model, Sequence::kSobol,
+                                     /*scramblingSeed=*/1);
+  QuasiRandomSpeakerRayFactory second(64, kSkipPower, &model, Sequence::kSobol,
+                                      /*scramblingSeed=*/2);
+  int differentPoints = 0;
+  for (int index = 0; index < 64; ++index) {
+    ASSERT_NE(first.unitSquarePoint(index), sobol.unitSquarePoint(index));
+    differentPoints +=
+        first.unitSquarePoint(index) != second.unitSquarePoint(index);
+  }
+  ASSERT_EQ(differentPoints, 64);
+}
+
+TEST(QuasiRandomSpeakerRayFactoryTest, InvalidArguments) {
+  FakeModel model;
+  ASSERT_THROW(QuasiRandomSpeakerRayFactory(0, kSkipPower, &model),
+               std::invalid_argument);
+  ASSERT_THROW(QuasiRandomSpeakerRayFactory(16, -1, &model),
+               std::invalid_argument);
+  ASSERT_THROW(QuasiRandomSpeakerRayFactory(16, kSkipPower, &model,
+                                            Sequence::kHalton,
+                                            /*scramblingSeed=*/1),
+               std::invalid_argument);
+  ASSERT_THROW(generators::NewPointSource(generators::SourceSampling::kGrid,
+                                          15, kSkipPower, &model),
+               std::invalid_argument);
+  ASSERT_NO_THROW(generators::NewPointSource(
+      generators::SourceSampling::kGrid, 16, kSkipPower, &model));
+}
@@ -0,0 +1,175 @@
+#include "main/meshLoader.h"
+#include "main/objLoader.h"
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using objects::TriangleObj;
+
+// Square made of two triangles and a triangle above it, in coordinates of
+// the file.
+const std::vector<std::vector<float>> kPoints = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0.5, 0.25, 2}};
+const std::vector<std::vector<uint32_t>> kFaces = {{0, 1, 2, 3},
+                                                   {0, 1, 4}};
+
+std::vector<TriangleObj> expectedTriangles() {
+  return objLoader::parseTriangles("v 0 0 0\n"
+                                   "v 1 0 0\n"
+                                   "v 1 1 0\n"
+                                   "v 0 1 0\n"
+                                   "v 0.5 0.25 2\n"
+                                   "f 1 2 3 4\n"
+                                   "f 1 2 5\n");
+}
+
+template <typename T> void append(T value, std::string *data) {
+  data->append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void appendBigEndian(T value, std::string *data) {
+  std::string bytes;
+  append(value, &bytes);
+  data->append(bytes.rbegin(), bytes.rend());
+}
+
+std::string binaryStl() {
+  std::string data(80, ' ');
+  data.replace(0, 5, "solid");
+  append<uint32_t>(3, &data);
+  const std::vector<std::vector<uint32_t>> triangles = {
+      {0, 1, 2}, {0, 2, 3}, {0, 1, 4}};
+  for (const std::vector<uint32_t> &triangle : triangles) {
+    for (int coordinate = 0; coordinate < 3; ++coordinate) {
+      append<float>(0, &data);
+    }
+    for (uint32_t point : triangle) {
+      for (float coordinate : kPoints[point]) {
+        append(coordinate, &data);
+      }
+    }
+    append<uint16_t>(0, &data);
+  }
+  return data;
+}
+
+TEST(MeshLoaderTest, BinaryStlGivesTheSameTrianglesAsObj) {
+  EXPECT_EQ(meshLoader::parseStl(binaryStl()), expectedTriangles());
+}
+
+TEST(MeshLoaderTest, AsciiStlGivesTheSameTrianglesAsObj) {
+  const std::string contents = "solid square\n"
+                               "facet normal 0 0 1\n"
+                               "  outer loop\n"
+                               "    vertex 0 0 0\n"
+                               "    vertex 1 0 0\n"
+                               "    vertex 1 1 0\n"
+                               "    vertex 0 1 0\n"
+                               "  endloop\n"
+                               "endfacet\n"
+                               "facet normal 0 1 0\r\n"
+                               "  outer loop\r\n"
+                               "    vertex 0 0 0\r\n"
+                               "    vertex 1 0 0\r\n"
+                               "    vertex 0.5 0.25 2e0\r\n"
+                               "  endloop\r\n"
+                               "endfacet\r\n"
+                               "endsolid square\n";
+
+  EXPECT_EQ(meshLoader::parseStl(contents), expectedTriangles());
+}
+
+TEST(MeshLoaderTest, AsciiPlyGivesTheSameTrianglesAsObj) {
+  const std::string contents = "ply\n"
+                               "format ascii 1.0\n"
+                               "comment exported by CAD\n"
+                               "element vertex 5\n"
+                               "property float x\n"
+                               "property float y\n"
+                               "property float z\n"
+                               "property uchar red\n"
+                               "element face 2\n"
+                               "property list uchar int vertex_indices\n"
+                               "end_header\n"
+                               "0 0 0 255\n"
+                               "1 0 0 255\n"
+                               "1 1 0 255\n"
+                               "0 1 0 255\n"
+                               "0.5 0.25 2 255\n"
+                               "4 0 1 2 3\n"
+                               "3 0 1 4\n";
+
+  EXPECT_EQ(meshLoader::parsePly(contents), expectedTriangles());
+}
+
+TEST(MeshLoaderTest, BinaryPlyGivesTheSameTrianglesAsObj) {
+  const std::string header = "element vertex 5\n"
+                             "property float x\n"
+                             "property float y\n"
+                             "property float z\n"
+                             "property double confidence\n"
+                             "element face 2\n"
+                             "property list uchar uint vertex_indices\n"
+                             "property list uchar float texcoord\n"
+                             "end_header\n";
+  std::string littleEndian = "ply\nformat binary_little_endian 1.0\n" + header;
+  std::string bigEndian = "ply\nformat binary_big_endian 1.0\n" + header;
+  for (const std::vector<float> &point : kPoints) {
+    for (float coordinate : point) {
+      append(coordinate, &littleEndian);
+      appendBigEndian(coordinate, &bigEndian);
+    }
+    append<double>(0.5, &littleEndian);
+    appendBigEndian<double>(0.5, &bigEndian);
+  }
+  for (const std::vector<uint32_t> &face : kFaces) {
+    append<uint8_t>(face.size(), &littleEndian);
+    appendBigEndian<uint8_t>(face.size(), &bigEndian);
+    for (uint32_t point : face) {
+      append(point, &littleEndian);
+      appendBigEndian(point, &bigEndian);
+    }
+    append<uint8_t>(1, &littleEndian);
+    appendBigEndian<uint8_t>(1, &bigEndian);
+    append<float>(0.5, &littleEndian);
+    appendBigEndian<float>(0.5, &bigEndian);
+  }
+
+  EXPECT_EQ(meshLoader::parsePly(littleEndian), expectedTriangles());
+  EXPECT_EQ(meshLoader::parsePly(bigEndian), expectedTriangles());
+}
+
+TEST(MeshLoaderTest, ThrowsAtInvalidFiles) {
+  std::string truncatedStl = binaryStl();
+  truncatedStl.replace(0, 5, "model");
+  truncatedStl.pop_back();
+  EXPECT_THROW(meshLoader::parseStl(truncatedStl), std::invalid_argument);
+  EXPECT_THROW(meshLoader::parsePly("solid square\n"), std::invalid_argument);
+  EXPECT_THROW(meshLoader::parsePly("ply\n"
+                                    "format ascii 1.0\n"
+                                    "element vertex 3\n"
+                                    "property float x\n"
+                                    "property float y\n"
+                                    "property float z\n"
+                                    "element face 1\n"
+                                    "property list uchar int vertex_indices\n"
+                                    "end_header\n"
+                                    "0 0 0\n"
+                                    "1 0 0\n"
+                                    "0 1 0\n"
+                                    "3 0 1 3\n"),
+               std::invalid_argument);
+  EXPECT_THROW(meshLoader::parsePly("ply\n"
+                                    "format binary_little_endian 1.0\n"
+                                    "element vertex 3\n"
+                                    "property float x\n"
+                                    "end_header\n"
+                                    "abc"),
+               std::invalid_argument);
+  EXPECT_THROW(meshLoader::loadStlTriangles("no/such/model.stl"),
+               std::invalid_argument);
+}
@@ -0,0 +1,82 @@
+#include "main/modelCache.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using objects::TriangleObj;
+
+std::vector<TriangleObj> makeTriangles() {
+  return {TriangleObj(core::Vec3(0, 0, 0), core::Vec3(1.5, 0, 0),
+                      core::Vec3(1.5, 0.25, 2)),
+          TriangleObj(core::Vec3(0.1, 0.2, 0.3), core::Vec3(-1, 3, 0.5),
+                      core::Vec3(2, -0.7, 1.1))};
+}
+
+void writeObj(const std::string &path, float height) {
+  std::ofstream file(path, std::ios::trunc);
+  file << "v 0 0 0\n"
+       << "v 1 0 0\n"
+       << "v 1 " << height << " 1\n"
+       << "f 1 2 3\n";
+}
+
+TEST(ModelCacheTest, ReadsTrianglesWithTheSameAttributes) {
+  std::vector<TriangleObj> triangles = makeTriangles();
+  std::stringstream stream;
+  modelCache::write(triangles, 42, stream);
+
+  std::optional<std::vector<TriangleObj>> cached =
+      modelCache::read(stream.str(), 42);
+
+  ASSERT_TRUE(cached.has_value());
+  ASSERT_EQ(*cached, triangles);
+  for (size_t index = 0; index < triangles.size(); ++index) {
+    const TriangleObj::Attributes expected = triangles[index].attributes();
+    const TriangleObj::Attributes actual = (*cached)[index].attributes();
+    EXPECT_EQ(actual.normal, expected.normal);
+    EXPECT_EQ(actual.edge1, expected.edge1);
+    EXPECT_EQ(actual.edge2, expected.edge2);
+    EXPECT_EQ(actual.origin, expected.origin);
+    EXPECT_EQ(actual.area, expected.area);
+    EXPECT_EQ(actual.parallelThreshold, expected.parallelThreshold);
+  }
+}
+
+TEST(ModelCacheTest, RejectsCacheOfDifferentSource) {
+  std::stringstream stream;
+  modelCache::write(makeTriangles(), 42, stream);
+  const std::string data = stream.str();
+
+  EXPECT_EQ(modelCache::read(data, 43), std::nullopt);
+  EXPECT_EQ(modelCache::read(data.substr(0, data.size() - 1), 42),
+            std::nullopt);
+  EXPECT_EQ(modelCache::read("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", 42),
+            std::nullopt);
+}
+
+TEST(ModelCacheTest, CreatesCacheNextToObjFile) {
+  const std::string objPath = ::testing::TempDir() + "modelCache.obj";
+  const std::string cachePath = modelCache::cachePath(objPath);
+  std::remove(cachePath.c_str());
+  writeObj(objPath, 1);
+
+  std::vector<TriangleObj> parsed = modelCache::loadTriangles(objPath);
+  ASSERT_TRUE(std::ifstream(cachePath).is_open());
+  std::vector<TriangleObj> cached = modelCache::loadTriangles(objPath);
+  EXPECT_EQ(cached, parsed);
+
+  // Cache of the previous contents is replaced.
+  writeObj(objPath, 2);
+  std::vector<TriangleObj> changed = modelCache::loadTriangles(objPath);
+  ASSERT_EQ(changed.size(), 1u);
+  EXPECT_EQ(changed[0].point3(), core::Vec3(1, 1, 2));
+  EXPECT_EQ(modelCache::loadTriangles(objPath), changed);
+
+  std::remove(objPath.c_str());
+  std::remove(cachePath.c_str());
+}
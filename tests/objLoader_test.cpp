@@ -0,0 +1,108 @@
+#include "core/threadPool.h"
+#include "main/objLoader.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using objects::TriangleObj;
+
+TEST(ObjLoaderTest, ParsesVerticesAndFaces) {
+  const std::string contents = "# comment\r\n"
+                               "o square\r\n"
+                               "v 0 0 0\r\n"
+                               "v 1.5 0 0\n"
+                               "v  1.5 +2 0.25\n"
+                               "v 0 2e0 0.25\n"
+                               "vn 0 0 1\n"
+                               "vt 0 0\n"
+                               "f 1 2 3\n"
+                               "f 1/1/1 3/1/1 4/1/1\n";
+
+  std::vector<TriangleObj> triangles = objLoader::parseTriangles(contents);
+
+  // y and z axes are swapped, so model lies on XY surface.
+  std::vector<TriangleObj> expected = {
+      TriangleObj(core::Vec3(0, 0, 0), core::Vec3(1.5, 0, 0),
+                  core::Vec3(1.5, 0.25, 2)),
+      TriangleObj(core::Vec3(0, 0, 0), core::Vec3(1.5, 0.25, 2),
+                  core::Vec3(0, 0.25, 2))};
+  EXPECT_EQ(triangles, expected);
+}
+
+TEST(ObjLoaderTest, SplitsPolygonsIntoTriangles) {
+  const std::string contents = "v 0 0 0\n"
+                               "v 1 0 0\n"
+                               "v 1 1 0\n"
+                               "v 0 1 0\n"
+                               "f 1 2 3 4";
+
+  std::vector<TriangleObj> triangles = objLoader::parseTriangles(contents);
+
+  std::vector<TriangleObj> expected = {
+      TriangleObj(core::Vec3(0, 0, 0), core::Vec3(1, 0, 0),
+                  core::Vec3(1, 0, 1)),
+      TriangleObj(core::Vec3(0, 0, 0), core::Vec3(1, 0, 1),
+                  core::Vec3(0, 0, 1))};
+  EXPECT_EQ(triangles, expected);
+}
+
+TEST(ObjLoaderTest, ChunksGiveTheSameTrianglesAsSingleThread) {
+  // Faces refer to points declared in previous chunks.
+  std::stringstream contents;
+  int numOfPoints = 0;
+  while (static_cast<size_t>(contents.tellp()) <
+         3 * objLoader::kBytesPerChunk) {
+    contents << "v " << numOfPoints << " " << numOfPoints % 7 << " 0.5\n"
+             << "v " << numOfPoints << " 0 " << numOfPoints % 5 + 1 << "\n";
+    numOfPoints += 2;
+    contents << "f 1 " << numOfPoints - 1 << " " << numOfPoints << "\n";
+  }
+
+  core::ThreadPool threadPool(4);
+  std::vector<TriangleObj> parallel =
+      objLoader::parseTriangles(contents.str(), &threadPool);
+  std::vector<TriangleObj> serial = objLoader::parseTriangles(contents.str());
+
+  ASSERT_EQ(parallel.size(), static_cast<size_t>(numOfPoints / 2 - 1));
+  EXPECT_EQ(parallel, serial);
+}
+
+TEST(ObjLoaderTest, ThrowsAtInvalidDeclarations) {
+  EXPECT_THROW(objLoader::parseTriangles("v 0 0\n"), std::invalid_argument);
+  EXPECT_THROW(objLoader::parseTriangles("v 0 zero 0\n"),
+               std::invalid_argument);
+  EXPECT_THROW(objLoader::parseTriangles("v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+                                         "f 1 2 4\n"),
+               std::invalid_argument);
+  EXPECT_THROW(objLoader::parseTriangles("v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+                                         "f 0 1 2\n"),
+               std::invalid_argument);
+}
+
+TEST(ObjLoaderTest, ParsesLinesLongerThanChunk) {
+  const std::string comment(objLoader::kBytesPerChunk + 100, 'x');
+  const std::string contents = "v 0 0 0\n"
+                               "v 1 0 0\n"
+                               "v 1 1 0\n"
+                               "f 1 2 3\n"
+                               "# " +
+                               comment;
+
+  core::ThreadPool threadPool(2);
+  std::vector<TriangleObj> triangles =
+      objLoader::parseTriangles(contents, &threadPool);
+
+  std::vector<TriangleObj> expected = {TriangleObj(
+      core::Vec3(0, 0, 0), core::Vec3(1, 0, 0), core::Vec3(1, 0, 1))};
+  EXPECT_EQ(triangles, expected);
+  EXPECT_EQ(objLoader::parseTriangles(contents + "\nf 1 2 3"),
+            std::vector<TriangleObj>(2, expected[0]));
+}
+
+TEST(ObjLoaderTest, ThrowsAtMissingFile) {
+  EXPECT_THROW(objLoader::loadTriangles("no/such/model.obj"),
+               std::invalid_argument);
+}
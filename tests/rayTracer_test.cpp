@@ -3,10 +3,15 @@
 #include "main/model.h"
 #include "main/rayTracer.h"
 #include "obj/objects.h"
+#include "obj/trianglePack.h"
 #include "gtest/gtest.h"
 
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <random>
 #include <string_view>
+#include <vector>
 
 using core::Ray;
 using core::RayHitData;
@@ -63,4 +68,215 @@ TEST_F(RayTracerTest, RayReflection) {
             rayTracer.rayTrace(alongX, kSkipFrequency, &hitData));
   Ray reflectedRay(inFrontOfModel + 5 * Vec3::kY, -Vec3::kY);
   ASSERT_EQ(reflectedRay, rayTracer.getReflected(&hitData));
-}
\ No newline at end of file
+}
+// Builds Quadratic Residue Diffuser like model made of |numOfWells|^2 wells
+// with different depths, so that rays hit both horizontal and vertical faces.
+std::unique_ptr<Model> getWellsModel(int numOfWells, float size) {
+  std::vector<TriangleObj> triangles;
+  const float wellWidth = 2 * size / numOfWells;
+  auto addQuad = [&](const Vec3 &a, const Vec3 &b, const Vec3 &c,
+                     const Vec3 &d) {
+    triangles.push_back(TriangleObj(a, b, c));
+    triangles.push_back(TriangleObj(c, d, a));
+  };
+  for (int xIndex = 0; xIndex < numOfWells; ++xIndex) {
+    for (int yIndex = 0; yIndex < numOfWells; ++yIndex) {
+      float depth = 0.05f * ((xIndex * xIndex + yIndex * yIndex) % 7 + 1);
+      float x0 = -size + xIndex * wellWidth;
+      float y0 = -size + yIndex * wellWidth;
+      float x1 = x0 + wellWidth;
+      float y1 = y0 + wellWidth;
+      addQuad(Vec3(x0, y0, depth), Vec3(x1, y0, depth), Vec3(x1, y1, depth),
+              Vec3(x0, y1, depth));
+      addQuad(Vec3(x0, y0, 0), Vec3(x1, y0, 0), Vec3(x1, y0, depth),
+              Vec3(x0, y0, depth));
+      addQuad(Vec3(x0, y0, 0), Vec3(x0, y1, 0), Vec3(x0, y1, depth),
+              Vec3(x0, y0, depth));
+    }
+  }
+  return std::make_unique<Model>(triangles);
+}
+
+TEST_F(RayTracerTest, HierarchyGivesTheSameResultsAsLinearSearch) {
+  std::unique_ptr<Model> model = getWellsModel(/*numOfWells=*/12, /*size=*/1);
+  RayTracer rayTracer(model.get());
+  ASSERT_FALSE(rayTracer.hierarchy().empty());
+  ASSERT_EQ(model->triangles().size(),
+            rayTracer.hierarchy().triangleIndices().size());
+
+  std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  int numOfHits = 0;
+  for (int rayIndex = 0; rayIndex < 2000; ++rayIndex) {
+    Vec3 origin(2 * distribution(generator), 2 * distribution(generator),
+                1 + distribution(generator));
+    Vec3 target(distribution(generator), distribution(generator), 0);
+    Ray ray(origin, target - origin);
+
+    RayHitData accelerated, reference;
+    RayTracer::TraceResult acceleratedResult =
+        rayTracer.rayTrace(ray, kSkipFrequency, &accelerated);
+    RayTracer::TraceResult referenceResult =
+        rayTracer.rayTraceWithoutAcceleration(ray, kSkipFrequency, &reference);
+
+    ASSERT_EQ(referenceResult, acceleratedResult) << ray;
+    if (referenceResult == RayTracer::TraceResult::HIT_TRIANGLE) {
+      ++numOfHits;
+      ASSERT_FLOAT_EQ(reference.time, accelerated.time) << ray;
+      ASSERT_EQ(reference.normal(), accelerated.normal()) << ray;
+      ASSERT_FLOAT_EQ(reference.accumulatedTime, accelerated.accumulatedTime);
+    }
+  }
+  ASSERT_GT(numOfHits, 0);
+}
+
+TEST_F(RayTracerTest, EmptyModelIsNeverHit) {
+  std::vector<TriangleObj> noTriangles;
+  Model model(noTriangles);
+  RayTracer rayTracer(&model);
+  ASSERT_TRUE(rayTracer.hierarchy().empty());
+
+  RayHitData hitData;
+  ASSERT_EQ(RayTracer::TraceResult::WENT_OUTSIDE_OF_SIMULATION_SPACE,
+            rayTracer.rayTrace(Ray(Vec3::kZ, -Vec3::kZ), kSkipFrequency,
+                               &hitData));
+}
+
+TEST(TriangleIntersectionTest, MollerTrumboreAgreesWithAreaSum) {
+  std::mt19937 generator(4321);
+  std::uniform_real_distribution<float> coordinate(-2, 2);
+  std::uniform_real_distribution<float> barycentric(-0.5, 1.5);
+  // Area sum method accepts points slightly outside of the triangle, so rays
+  // aimed close to the edges are skipped.
+  const float kEdgeMargin = 0.01;
+
+  int numOfComparedRays = 0;
+  for (int triangleIndex = 0; triangleIndex < 200; ++triangleIndex) {
+    Vec3 point1(coordinate(generator), coordinate(generator),
+                coordinate(generator));
+    Vec3 point2(coordinate(generator), coordinate(generator),
+                coordinate(generator));
+    Vec3 point3(coordinate(generator), coordinate(generator),
+                coordinate(generator));
+    if ((point2 - point1).crossProduct(point3 - point1).magnitude() < 0.5) {
+      continue;
+    }
+    TriangleObj triangle(point1, point2, point3);
+
+    for (int rayIndex = 0; rayIndex < 20; ++rayIndex) {
+      float u = barycentric(generator);
+      float v = barycentric(generator);
+      float w = 1 - u - v;
+      if (std::min({std::abs(u), std::abs(v), std::abs(w)}) < kEdgeMargin) {
+        continue;
+      }
+      Vec3 target = w * point1 + u * point2 + v * point3;
+      Vec3 origin(3 * coordinate(generator), 3 * coordinate(generator),
+                  3 * coordinate(generator));
+      if ((target - origin).magnitude() < 0.1) {
+        continue;
+      }
+      Ray ray(origin, target - origin);
+
+      float areaTime = 0, areaU = 0, areaV = 0;
+      float fastTime = 0, fastU = 0, fastV = 0;
+      bool areaHit = triangle.intersectAreaSum(ray, &areaTime, &areaU, &areaV);
+      bool fastHit =
+          triangle.intersectMollerTrumbore(ray, &fastTime, &fastU, &fastV);
+      ASSERT_EQ(areaHit, fastHit) << triangle << "\n" << ray;
+      if (fastHit) {
+        ASSERT_NEAR(areaTime, fastTime, 1e-3);
+        ASSERT_NEAR(u, fastU, 1e-3);
+        ASSERT_NEAR(v, fastV, 1e-3);
+        ASSERT_NEAR(areaU, fastU, 1e-3);
+        ASSERT_NEAR(areaV, fastV, 1e-3);
+      }
+      ++numOfComparedRays;
+    }
+  }
+  ASSERT_GT(numOfComparedRays, 1000);
+}
+
+TEST(TriangleIntersectionTest, RayAlongSharedEdgeHitsModel) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  RayTracer rayTracer(model.get());
+  // Both triangles of the reference model share diagonal going through the
+  // middle of the model.
+  for (float position = -0.9; position < 1; position += 0.1) {
+    RayHitData hitData;
+    Ray alongDiagonal(Vec3(position, -position, 1), -Vec3::kZ);
+    ASSERT_EQ(RayTracer::TraceResult::HIT_TRIANGLE,
+              rayTracer.rayTrace(alongDiagonal, kSkipFrequency, &hitData))
+        << alongDiagonal;
+    ASSERT_FLOAT_EQ(1, hitData.time);
+  }
+}
+
+TEST(TriangleIntersectionTest, TrianglePackKernelsAgreeWithMollerTrumbore) {
+  std::mt19937 generator(1234);
+  std::uniform_real_distribution<float> coordinate(-2, 2);
+
+  std::vector<TriangleObj> triangles;
+  while (triangles.size() < 8 * objects::TrianglePack::kWidth) {
+    Vec3 point1(coordinate(generator), coordinate(generator),
+                coordinate(generator));
+    Vec3 point2(coordinate(generator), coordinate(generator),
+                coordinate(generator));
+    Vec3 point3(coordinate(generator), coordinate(generator),
+                coordinate(generator));
+    if ((point2 - point1).crossProduct(point3 - point1).magnitude() < 0.1) {
+      continue;
+    }
+    triangles.push_back(TriangleObj(point1, point2, point3));
+  }
+  // Last pack is left partially empty on purpose.
+  std::vector<objects::TrianglePack> packs;
+  for (uint32_t index = 0; index + 3 < triangles.size(); ++index) {
+    if (packs.empty() || !packs.back().add(triangles[index], index)) {
+      packs.push_back(objects::TrianglePack());
+      ASSERT_TRUE(packs.back().add(triangles[index], index));
+    }
+  }
+
+  for (objects::SimdLevel level :
+       {objects::SimdLevel::kScalar, objects::SimdLevel::kSse,
+        objects::SimdLevel::kAvx2}) {
+    if (!objects::isSimdLevelSupported(level)) {
+      continue;
+    }
+    objects::TrianglePackKernel kernel = objects::getTrianglePackKernel(level);
+    std::mt19937 rayGenerator(4321);
+    for (int rayIndex = 0; rayIndex < 2000; ++rayIndex) {
+      Vec3 origin(3 * coordinate(rayGenerator), 3 * coordinate(rayGenerator),
+                  3 * coordinate(rayGenerator));
+      Vec3 target(coordinate(rayGenerator), coordinate(rayGenerator),
+                  coordinate(rayGenerator));
+      Ray ray(origin, target - origin);
+
+      float expectedTime = std::numeric_limits<float>::max();
+      uint32_t expectedTriangle = std::numeric_limits<uint32_t>::max();
+      for (const objects::TrianglePack &pack : packs) {
+        for (int lane = 0; lane < pack.size; ++lane) {
+          float time, u, v;
+          uint32_t index = pack.triangleIndex[lane];
+          if (triangles[index].intersectMollerTrumbore(ray, &time, &u, &v) &&
+              time < expectedTime) {
+            expectedTime = time;
+            expectedTriangle = index;
+          }
+        }
+      }
+
+      float closestTime = std::numeric_limits<float>::max();
+      uint32_t closestTriangle = std::numeric_limits<uint32_t>::max();
+      objects::PackedRay packedRay(ray);
+      for (const objects::TrianglePack &pack : packs) {
+        kernel(pack, packedRay, &closestTime, &closestTriangle);
+      }
+      ASSERT_EQ(expectedTriangle, closestTriangle)
+          << objects::simdLevelName(level) << " " << ray;
+      ASSERT_EQ(expectedTime, closestTime)
+          << objects::simdLevelName(level) << " " << ray;
+    }
+  }
+}
@@ -146,3 +146,68 @@ TEST_F(WaveObjectPressureTest, GetTotalPressureTest) {
   ASSERT_NEAR(wave.getTotalPressure(),
               convertPressureToDecibels(referencePressureFromCustom), 0.6f);
 }
+
+TEST(WaveObjectFactory, HistogramIsConvertedToTheSameWaveAsEnergyPerTime) {
+  const std::vector<std::pair<float, float>> energyPerTime = {
+      {0.0f, 1.0f}, {0.01f, 2.0f}, {0.010001f, 3.0f}, {0.5f, 4.0f},
+      {0.25f, 5.0f}};
+  for (int sampleRate : {kSampleRate, 44100}) {
+    WaveObject expected(sampleRate);
+    for (const auto &[time, energy] : energyPerTime) {
+      expected.addEnergyAtTime(time, energy);
+    }
+
+    Collectors collectors;
+    collectors.push_back(std::make_unique<objects::EnergyCollector>(
+        core::Vec3::kZero, /*radius=*/1));
+    collectors.back()->reserveEnergy(/*maxTime=*/0.1);
+    for (const auto &[time, energy] : energyPerTime) {
+      collectors.back()->addEnergy(time, energy);
+    }
+
+    WaveObjectFactory factory(sampleRate);
+    std::vector<WaveObject> waves =
+        factory.createWaveObjectsFromCollectors(collectors);
+    ASSERT_EQ(1, waves.size());
+    ASSERT_EQ(expected.length(), waves[0].length())
+        << "sample rate: " << sampleRate;
+    ASSERT_ELEMENTS_NEAR(waves[0].getData(), expected.getData(), 1e-6f);
+  }
+}
+
+TEST(EnergyHistogram, AddingHistograms) {
+  objects::EnergyHistogram first;
+  first.addEnergy(/*time=*/0.5, /*energy=*/1);
+  objects::EnergyHistogram second;
+  second.addEnergy(/*time=*/0.5, /*energy=*/2);
+  second.addEnergy(/*time=*/1, /*energy=*/3);
+
+  first.addEnergy(second);
+  ASSERT_EQ(second.length(), first.length());
+  ASSERT_FLOAT_EQ(6, first.totalEnergy());
+  ASSERT_FLOAT_EQ(3, first.samples()[std::floor(0.5f * kSampleRate)]);
+  ASSERT_NE(first, second);
+
+  objects::EnergyHistogram otherSampleRate(44100);
+  ASSERT_THROW(first.addEnergy(otherSampleRate), std::invalid_argument);
+  ASSERT_THROW(first.addEnergy(/*time=*/-1, /*energy=*/1),
+               std::invalid_argument);
+  ASSERT_THROW(objects::EnergyHistogram(0), std::invalid_argument);
+}
+
+TEST(BatchMeans, ConfidenceIntervalOfTheMean) {
+  BatchMeans batchMeans;
+  batchMeans.addBatch(1);
+  ASSERT_EQ(batchMeans.mean(), 1);
+  ASSERT_TRUE(std::isinf(batchMeans.confidenceHalfWidth()));
+
+  for (float result : {2, 3, 4}) {
+    batchMeans.addBatch(result);
+  }
+  ASSERT_EQ(batchMeans.numOfBatches(), 4);
+  ASSERT_FLOAT_EQ(batchMeans.mean(), 2.5);
+  // Standard deviation of the mean: sqrt(5 / 3 / 4), t quantile for 3 degrees
+  // of freedom: 3.182.
+  ASSERT_NEAR(batchMeans.confidenceHalfWidth(), 3.182 * std::sqrt(5.0 / 12),
+              1e-4);
+}
@@ -4,7 +4,12 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -58,3 +63,516 @@ protected:
   FakeCollectorsTracker collectorsTracker;
   LinearEnergyCollection energyCollectionRules;
 };
+
+namespace {
+float totalEnergy(const objects::EnergyCollector &collector) {
+  return collector.getEnergy().totalEnergy();
+}
+} // namespace
+
+TEST_F(SceneManagerSimpleTest, ParallelRunIsRepeatable) {
+  BasicSimulationProperties basicProperties({kSkipFreq}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/30,
+                                            /*maxTracking=*/4);
+  basicProperties.numOfThreads = 4;
+  SimulationProperties properties(&energyCollectionRules, basicProperties);
+  SimpleFourSidedReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  SceneManager firstManager(model.get(), properties, &positionTracker,
+                            &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> first =
+      firstManager.newRun(&collectorBuilder);
+  SceneManager secondManager(model.get(), properties, &positionTracker,
+                             &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> second =
+      secondManager.newRun(&collectorBuilder);
+
+  const Collectors &firstCollectors = first.at(kSkipFreq);
+  const Collectors &secondCollectors = second.at(kSkipFreq);
+  ASSERT_EQ(firstCollectors.size(), secondCollectors.size());
+  for (size_t index = 0; index < firstCollectors.size(); ++index) {
+    ASSERT_EQ(firstCollectors[index]->getEnergy(),
+              secondCollectors[index]->getEnergy())
+        << "collector: " << index;
+  }
+}
+
+TEST_F(SceneManagerSimpleTest, ParallelRunCollectsTheSameEnergyAsSerialRun) {
+  BasicSimulationProperties basicProperties({kSkipFreq}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/30,
+                                            /*maxTracking=*/4);
+  basicProperties.reuseGeometricPaths = false;
+  FakeReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  SceneManager serialManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> serial =
+      serialManager.newRun(&collectorBuilder);
+
+  basicProperties.numOfThreads = 3;
+  SceneManager parallelManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> parallel =
+      parallelManager.newRun(&collectorBuilder);
+
+  const Collectors &serialCollectors = serial.at(kSkipFreq);
+  const Collectors &parallelCollectors = parallel.at(kSkipFreq);
+  ASSERT_EQ(serialCollectors.size(), parallelCollectors.size());
+  float collectedEnergy = 0;
+  for (size_t index = 0; index < serialCollectors.size(); ++index) {
+    ASSERT_EQ(serialCollectors[index]->getEnergy().length(),
+              parallelCollectors[index]->getEnergy().length());
+    float expected = totalEnergy(*serialCollectors[index]);
+    ASSERT_NEAR(expected, totalEnergy(*parallelCollectors[index]),
+                1e-4 * expected)
+        << "collector: " << index;
+    collectedEnergy += expected;
+  }
+  ASSERT_GT(collectedEnergy, 0);
+}
+
+TEST_F(SceneManagerSimpleTest, InvalidNumberOfThreads) {
+  BasicSimulationProperties basicProperties({kSkipFreq}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/30,
+                                            /*maxTracking=*/4);
+  basicProperties.numOfThreads = 0;
+  FakeReflectionEngine reflectionEngine;
+  ASSERT_THROW(SceneManager(model.get(),
+                            SimulationProperties(&energyCollectionRules,
+                                                 basicProperties),
+                            &positionTracker, &collectorsTracker,
+                            &reflectionEngine),
+               std::invalid_argument);
+}
+
+// Records order of frequencies and number of positions tracked in each one.
+class RecordingPositionTracker : public PositionTrackerInterface {
+public:
+  void initializeNewFrequency(float frequency) override {
+    frequencies.push_back(frequency);
+    positionsPerFrequency.push_back(0);
+  };
+  void initializeNewTracking() override { ++numOfTrackings; };
+  void
+  addNewPositionToCurrentTracking(const core::RayHitData &hitData) override {
+    ++positionsPerFrequency.back();
+  };
+  void endCurrentFrequency() override{};
+  void endCurrentTracking() override{};
+  void save() override { ++numOfSaves; };
+  void switchToReferenceModel() override{};
+
+  std::vector<float> frequencies;
+  std::vector<int> positionsPerFrequency;
+  int numOfTrackings = 0;
+  int numOfSaves = 0;
+
+private:
+  void printItself(std::ostream &os) const noexcept override {
+    os << "Recording Position Tracker";
+  }
+};
+
+TEST_F(SceneManagerSimpleTest, FrequenciesInParallelGiveTheSameResults) {
+  BasicSimulationProperties basicProperties({100, 250, 500, 1000, 2000},
+                                            /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/20,
+                                            /*maxTracking=*/4);
+  basicProperties.reuseGeometricPaths = false;
+  FakeReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  RecordingPositionTracker serialTracker;
+  SceneManager serialManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &serialTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> serial =
+      serialManager.newRun(&collectorBuilder);
+
+  basicProperties.numOfThreads = 3;
+  basicProperties.parallelFrequencies = true;
+  RecordingPositionTracker parallelTracker;
+  SceneManager parallelManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &parallelTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> parallel =
+      parallelManager.newRun(&collectorBuilder);
+
+  ASSERT_EQ(basicProperties.frequencies, parallelTracker.frequencies);
+  ASSERT_EQ(serialTracker.positionsPerFrequency,
+            parallelTracker.positionsPerFrequency);
+  ASSERT_EQ(serialTracker.numOfTrackings, parallelTracker.numOfTrackings);
+  ASSERT_EQ(1, parallelTracker.numOfSaves);
+
+  for (float frequency : basicProperties.frequencies) {
+    const Collectors &serialCollectors = serial.at(frequency);
+    const Collectors &parallelCollectors = parallel.at(frequency);
+    ASSERT_EQ(serialCollectors.size(), parallelCollectors.size());
+    for (size_t index = 0; index < serialCollectors.size(); ++index) {
+      ASSERT_EQ(serialCollectors[index]->getEnergy(),
+                parallelCollectors[index]->getEnergy())
+          << "frequency: " << frequency << ", collector: " << index;
+    }
+  }
+}
+
+TEST_F(SceneManagerSimpleTest, GeometricPathCacheGivesTheSameResults) {
+  BasicSimulationProperties basicProperties({100, 250, 500, 1000, 2000},
+                                            /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/20,
+                                            /*maxTracking=*/4);
+  basicProperties.reuseGeometricPaths = false;
+  // Collected energy depends on the frequency only through the phase.
+  collectionRules::LinearEnergyCollectionWithPhaseImpact energyCollectionRules;
+  FakeReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  RecordingPositionTracker tracedTracker;
+  SceneManager tracedManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &tracedTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> traced =
+      tracedManager.newRun(&collectorBuilder);
+
+  basicProperties.reuseGeometricPaths = true;
+  RecordingPositionTracker cachedTracker;
+  SceneManager cachedManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &cachedTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> cached =
+      cachedManager.newRun(&collectorBuilder);
+
+  // Without tracking positions, paths are recorded by many threads.
+  basicProperties.numOfThreads = 3;
+  SceneManager parallelManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> parallel =
+      parallelManager.newRun(&collectorBuilder);
+
+  ASSERT_EQ(basicProperties.frequencies, cachedTracker.frequencies);
+  ASSERT_EQ(tracedTracker.positionsPerFrequency,
+            cachedTracker.positionsPerFrequency);
+  ASSERT_EQ(1, cachedTracker.numOfSaves);
+
+  for (float frequency : basicProperties.frequencies) {
+    const Collectors &tracedCollectors = traced.at(frequency);
+    ASSERT_EQ(tracedCollectors.size(), cached.at(frequency).size());
+    ASSERT_EQ(tracedCollectors.size(), parallel.at(frequency).size());
+    for (size_t index = 0; index < tracedCollectors.size(); ++index) {
+      ASSERT_EQ(tracedCollectors[index]->getEnergy(),
+                cached.at(frequency)[index]->getEnergy())
+          << "frequency: " << frequency << ", collector: " << index;
+      ASSERT_EQ(tracedCollectors[index]->getEnergy(),
+                parallel.at(frequency)[index]->getEnergy())
+          << "frequency: " << frequency << ", collector: " << index;
+    }
+  }
+  ASSERT_NE(cached.at(100)[0]->getEnergy(), cached.at(2000)[0]->getEnergy());
+}
+
+TEST_F(SceneManagerSimpleTest, SeedGivesTheSameReflectionsInEveryThread) {
+  BasicSimulationProperties basicProperties({kSkipFreq}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/30,
+                                            /*maxTracking=*/4);
+  basicProperties.seed = 1234;
+  SimpleFourSidedReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  SceneManager serialManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  const Collectors serial =
+      std::move(serialManager.newRun(&collectorBuilder).at(kSkipFreq));
+
+  basicProperties.numOfThreads = 3;
+  SceneManager parallelManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  const Collectors parallel =
+      std::move(parallelManager.newRun(&collectorBuilder).at(kSkipFreq));
+
+  basicProperties.seed = 4321;
+  SceneManager otherSeedManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  const Collectors otherSeed =
+      std::move(otherSeedManager.newRun(&collectorBuilder).at(kSkipFreq));
+
+  ASSERT_EQ(serial.size(), parallel.size());
+  bool seedChangedResults = false;
+  for (size_t index = 0; index < serial.size(); ++index) {
+    // Only order of summation differs between threads.
+    ASSERT_EQ(serial[index]->getEnergy().length(),
+              parallel[index]->getEnergy().length());
+    float expected = totalEnergy(*serial[index]);
+    ASSERT_NEAR(expected, totalEnergy(*parallel[index]), 1e-4 * expected)
+        << "collector: " << index;
+    seedChangedResults |=
+        serial[index]->getEnergy() != otherSeed[index]->getEnergy();
+  }
+  ASSERT_TRUE(seedChangedResults);
+}
+
+TEST_F(SceneManagerSimpleTest, AdaptiveRunStopsAtDiffusionTolerance) {
+  BasicSimulationProperties basicProperties({250, 1000}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/64,
+                                            /*maxTracking=*/4);
+  basicProperties.raysPerBatch = 256;
+  FakeReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+  const float kMinRays = SceneManager::kMinBatches * 256;
+  const float kMaxRays = 64 * 64;
+
+  basicProperties.diffusionTolerance = 1;
+  RecordingPositionTracker looseTracker;
+  SceneManager looseManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &looseTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> loose =
+      looseManager.newRun(&collectorBuilder);
+  ASSERT_EQ(looseManager.raysUsed(),
+            (std::map<float, float>{{250, kMinRays}, {1000, kMinRays}}));
+  ASSERT_EQ(looseTracker.frequencies, basicProperties.frequencies);
+  ASSERT_EQ(looseTracker.numOfTrackings, 0);
+  ASSERT_EQ(looseTracker.numOfSaves, 1);
+
+  basicProperties.diffusionTolerance = 1e-9;
+  SceneManager strictManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> strict =
+      strictManager.newRun(&collectorBuilder);
+  ASSERT_EQ(strictManager.raysUsed(),
+            (std::map<float, float>{{250, kMaxRays}, {1000, kMaxRays}}));
+
+  // Collected energy is the mean of batches, so it does not grow with the
+  // number of rays.
+  float looseEnergy = 0, strictEnergy = 0;
+  for (size_t index = 0; index < loose.at(1000).size(); ++index) {
+    looseEnergy += totalEnergy(*loose.at(1000)[index]);
+    strictEnergy += totalEnergy(*strict.at(1000)[index]);
+  }
+  ASSERT_GT(looseEnergy, 0);
+  ASSERT_NEAR(looseEnergy, strictEnergy, 0.05 * looseEnergy);
+
+  // Without the geometric path cache, every frequency is traced separately.
+  basicProperties.reuseGeometricPaths = false;
+  SceneManager tracedManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> traced =
+      tracedManager.newRun(&collectorBuilder);
+  ASSERT_EQ(strictManager.raysUsed(), tracedManager.raysUsed());
+  for (float frequency : basicProperties.frequencies) {
+    for (size_t index = 0; index < traced.at(frequency).size(); ++index) {
+      ASSERT_EQ(strict.at(frequency)[index]->getEnergy(),
+                traced.at(frequency)[index]->getEnergy());
+    }
+  }
+
+  // Batches of deterministic sources would be the same.
+  basicProperties.sourceSampling = generators::SourceSampling::kScrambledSobol;
+  ASSERT_NO_THROW(SceneManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine));
+  basicProperties.sourceSampling = generators::SourceSampling::kHalton;
+  ASSERT_THROW(SceneManager(model.get(),
+                            SimulationProperties(&energyCollectionRules,
+                                                 basicProperties),
+                            &positionTracker, &collectorsTracker,
+                            &reflectionEngine),
+               std::invalid_argument);
+  basicProperties.sourceSampling = generators::SourceSampling::kGrid;
+
+  basicProperties.checkpointPath =
+      ::testing::TempDir() + "sceneManager.adaptive.checkpoint";
+  ASSERT_THROW(SceneManager(model.get(),
+                            SimulationProperties(&energyCollectionRules,
+                                                 basicProperties),
+                            &positionTracker, &collectorsTracker,
+                            &reflectionEngine),
+               std::invalid_argument);
+  basicProperties.checkpointPath.clear();
+
+  // Estimate of the diffusion coefficient needs at least |kMinBatches|.
+  basicProperties.numOfRaysSquared = 32;
+  ASSERT_NO_THROW(SceneManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine));
+  basicProperties.numOfRaysSquared = 31;
+  ASSERT_THROW(SceneManager(model.get(),
+                            SimulationProperties(&energyCollectionRules,
+                                                 basicProperties),
+                            &positionTracker, &collectorsTracker,
+                            &reflectionEngine),
+               std::invalid_argument);
+
+  basicProperties.diffusionTolerance = -1;
+  ASSERT_THROW(SceneManager(model.get(),
+                            SimulationProperties(&energyCollectionRules,
+                                                 basicProperties),
+                            &positionTracker, &collectorsTracker,
+                            &reflectionEngine),
+               std::invalid_argument);
+}
+
+// Simulates crash of the simulation after given number of traced rays.
+class CrashingPositionTracker : public RecordingPositionTracker {
+public:
+  explicit CrashingPositionTracker(int numOfTrackingsToCrash)
+      : numOfTrackingsToCrash_(numOfTrackingsToCrash) {}
+  void initializeNewTracking() override {
+    if (++numOfTrackings > numOfTrackingsToCrash_) {
+      throw std::runtime_error("Simulation crashed");
+    }
+  }
+
+private:
+  int numOfTrackingsToCrash_;
+};
+
+TEST_F(SceneManagerSimpleTest, ResumedRunGivesTheSameResults) {
+  BasicSimulationProperties basicProperties({250, 1000}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/20,
+                                            /*maxTracking=*/3);
+  SimpleFourSidedReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  SceneManager uninterruptedManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> uninterrupted =
+      uninterruptedManager.newRun(&collectorBuilder);
+
+  basicProperties.checkpointPath =
+      ::testing::TempDir() + "sceneManager.checkpoint";
+  basicProperties.raysPerCheckpoint = 100;
+  std::remove(basicProperties.checkpointPath.c_str());
+  // Crashes in the middle of the second frequency, after its first
+  // checkpoint.
+  CrashingPositionTracker crashingTracker(/*numOfTrackingsToCrash=*/550);
+  SceneManager crashingManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &crashingTracker, &collectorsTracker, &reflectionEngine);
+  ASSERT_THROW(crashingManager.newRun(&collectorBuilder), std::runtime_error);
+
+  RecordingPositionTracker resumedTracker;
+  SceneManager resumedManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &resumedTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> resumed =
+      resumedManager.newRun(&collectorBuilder);
+  ASSERT_EQ(resumedTracker.numOfTrackings, 300);
+
+  for (float frequency : basicProperties.frequencies) {
+    for (size_t index = 0; index < uninterrupted.at(frequency).size();
+         ++index) {
+      ASSERT_EQ(uninterrupted.at(frequency)[index]->getEnergy(),
+                resumed.at(frequency)[index]->getEnergy())
+          << "frequency: " << frequency << ", collector: " << index;
+    }
+    ASSERT_EQ(
+        uninterruptedManager.tracingStatistics().at(frequency).emittedEnergy,
+        resumedManager.tracingStatistics().at(frequency).emittedEnergy);
+  }
+
+  // Number of threads does not change results, so completed checkpoint is
+  // resumed without tracing any ray.
+  basicProperties.numOfThreads = 2;
+  basicProperties.raysPerCheckpoint = 50;
+  RecordingPositionTracker threadsTracker;
+  SceneManager threadsManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &threadsTracker, &collectorsTracker, &reflectionEngine);
+  threadsManager.newRun(&collectorBuilder);
+  ASSERT_EQ(threadsTracker.numOfTrackings, 0);
+
+  // Checkpoint of a different simulation is neither resumed nor overwritten.
+  basicProperties.seed = 1;
+  RecordingPositionTracker otherTracker;
+  SceneManager otherManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &otherTracker, &collectorsTracker, &reflectionEngine);
+  ASSERT_THROW(otherManager.newRun(&collectorBuilder), std::invalid_argument);
+  ASSERT_EQ(otherTracker.numOfTrackings, 0);
+  std::optional<checkpoints::Checkpoint> saved =
+      checkpoints::load(basicProperties.checkpointPath);
+  ASSERT_TRUE(saved.has_value());
+  for (const auto &band : saved->bands) {
+    ASSERT_TRUE(band->completed());
+  }
+}
+
+TEST_F(SceneManagerSimpleTest, MergedShardsGiveTheSameResults) {
+  BasicSimulationProperties basicProperties({250, 1000}, /*sourcePower=*/100,
+                                            /*numOfCollectors=*/37,
+                                            /*numOfRaysSquared=*/20,
+                                            /*maxTracking=*/3);
+  SimpleFourSidedReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+
+  SceneManager wholeManager(
+      model.get(), SimulationProperties(&energyCollectionRules, basicProperties),
+      &positionTracker, &collectorsTracker, &reflectionEngine);
+  std::unordered_map<float, Collectors> whole =
+      wholeManager.newRun(&collectorBuilder);
+
+  basicProperties.numOfShards = 3;
+  std::vector<checkpoints::Checkpoint> shards;
+  for (int shard = 0; shard < basicProperties.numOfShards; ++shard) {
+    basicProperties.shardIndex = shard;
+    basicProperties.checkpointPath = ::testing::TempDir() +
+                                     "sceneManager.shard." +
+                                     std::to_string(shard);
+    std::remove(basicProperties.checkpointPath.c_str());
+    RecordingPositionTracker shardTracker;
+    SceneManager shardManager(
+        model.get(),
+        SimulationProperties(&energyCollectionRules, basicProperties),
+        &shardTracker, &collectorsTracker, &reflectionEngine);
+    shardManager.newRun(&collectorBuilder);
+    ASSERT_EQ(shardTracker.numOfTrackings, (shard == 2 ? 134 : 133) * 2);
+    shards.push_back(*checkpoints::load(basicProperties.checkpointPath));
+  }
+
+  std::unordered_map<float, Collectors> merged =
+      checkpoints::toCollectors(checkpoints::mergeShards(shards));
+  std::reverse(shards.begin(), shards.end());
+  std::unordered_map<float, Collectors> reversed =
+      checkpoints::toCollectors(checkpoints::mergeShards(shards));
+  for (float frequency : basicProperties.frequencies) {
+    ASSERT_EQ(merged.at(frequency).size(), whole.at(frequency).size());
+    for (size_t index = 0; index < whole.at(frequency).size(); ++index) {
+      const float wholeEnergy =
+          whole.at(frequency)[index]->getEnergy().totalEnergy();
+      ASSERT_NEAR(wholeEnergy,
+                  merged.at(frequency)[index]->getEnergy().totalEnergy(),
+                  1e-4 * wholeEnergy)
+          << "frequency: " << frequency << ", collector: " << index;
+      ASSERT_EQ(merged.at(frequency)[index]->getEnergy(),
+                reversed.at(frequency)[index]->getEnergy());
+      ASSERT_EQ(merged.at(frequency)[index]->getOrigin(),
+                whole.at(frequency)[index]->getOrigin());
+    }
+  }
+
+  basicProperties.checkpointPath.clear();
+  SimulationProperties withoutCheckpoint(&energyCollectionRules,
+                                         basicProperties);
+  ASSERT_THROW(SceneManager(model.get(), withoutCheckpoint, &positionTracker,
+                            &collectorsTracker, &reflectionEngine),
+               std::invalid_argument);
+}
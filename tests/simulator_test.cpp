@@ -1,10 +1,14 @@
 #include "core/constants.h"
+#include "main/policySimulator.h"
 #include "main/simulator.h"
 #include "nlohmann/json.hpp"
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <random>
+#include <stdexcept>
 #include <string_view>
 
 // Checks if |TRY_BLOCK| throws right |EXCPETION_TYPE| with exception message
@@ -288,3 +292,479 @@ TEST_F(EnergyCollectorTest, HitRayStraightUpEvenCollectors) {
   ASSERT_FLOAT_EQ(collectorsMaxZ - refCollectorRadius * std::sqrt(3) / 2,
                   hitData.time);
 }
+
+// Returns reflected ray and ray, that goes back to the hit point from above,
+// so every hit creates one ray escaping the simulation and one hitting the
+// model again.
+struct ReturningReflectionEngine : public ReflectionEngineInterface {
+  std::vector<Ray> modelReflectedSoundWave(const Ray &reflected,
+                                           float frequency) const override {
+    return {Ray(reflected.origin() + Vec3::kZ, -Vec3::kZ, reflected.energy()),
+            reflected};
+  }
+  void printItself(std::ostream &os) const noexcept override {
+    os << "Returning Reflection Engine";
+  }
+};
+
+TEST(SimulatorTest, PerformRayTracingIsLimitedByMaxTracking) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  RayTracer rayTracer(model.get());
+  generators::CustomPointRayFactory source(Vec3(0.1, 0.2, 1), -Vec3::kZ, 1);
+  generators::FakeOffseter offseter;
+  trackers::SimplePositionTracker positionTracker;
+  collectionRules::LinearEnergyCollection energyCollectionRules;
+  ReturningReflectionEngine reflectionEngine;
+  Simulator simulator(&rayTracer, model.get(), &source, &offseter,
+                      &positionTracker, &energyCollectionRules,
+                      &reflectionEngine);
+  Collectors collectors =
+      DoubleAxisCollectorBuilder().buildCollectors(model.get(), kSkipNumber);
+
+  const int maxTracking = 5;
+  TracingStatistics statistics =
+      simulator.runRayTracing(kSkipFrequency, &collectors, maxTracking);
+
+  ASSERT_EQ(maxTracking, statistics.depthLimit);
+  ASSERT_EQ(maxTracking, statistics.maxReachedDepth);
+  // Stack grows by one ray with every reflection.
+  ASSERT_EQ(maxTracking + 1, statistics.maxPendingRays);
+  // Every tracking ends with hit of the model and every reflected ray, except
+  // the ones from the last reflection, reaches the sphere wall.
+  ASSERT_EQ(2 * maxTracking - 1,
+            positionTracker.getNumberOfAcquiredTrackings());
+}
+
+// Returns |count| random points at distance from the origin in range
+// [0.5 * |maxDistance|, 1.5 * |maxDistance|].
+std::vector<Vec3> randomPoints(int count, float maxDistance) {
+  std::mt19937 engine(2137);
+  std::normal_distribution<float> direction(0, 1);
+  std::uniform_real_distribution<float> distance(0.5 * maxDistance,
+                                                 1.5 * maxDistance);
+  std::vector<Vec3> points;
+  for (int point = 0; point < count; ++point) {
+    Vec3 randomDirection(direction(engine), direction(engine),
+                         direction(engine));
+    points.push_back(randomDirection.normalize() * distance(engine));
+  }
+  return points;
+}
+
+TEST(CollectorIndexTest, CandidatesContainEveryCollectorContainingPosition) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  const float wallRadius = getSphereWallRadius(*model);
+  std::vector<Vec3> points = randomPoints(20000, wallRadius);
+  std::vector<std::unique_ptr<CollectorBuilderInterface>> builders;
+  builders.push_back(std::make_unique<DoubleAxisCollectorBuilder>());
+  builders.push_back(std::make_unique<GeometricDomeCollectorBuilder>());
+  for (const auto &builder : builders) {
+    Collectors collectors = builder->buildCollectors(model.get(), kSkipNumber);
+    collectionRules::CollectorIndex index(collectors);
+    ASSERT_EQ(collectors.size(), index.numOfCollectors());
+    ASSERT_LT(index.averageNumOfCandidates(), collectors.size());
+
+    // Points on the collectors are the hardest cases.
+    for (const auto &collector : collectors) {
+      points.push_back(collector->getOrigin() +
+                       Vec3::kX * collector->getRadius() * 0.999);
+    }
+    for (const Vec3 &point : points) {
+      const std::vector<uint32_t> &candidates = index.candidates(point);
+      ASSERT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+      for (uint32_t collector = 0; collector < collectors.size();
+           ++collector) {
+        if (collectors[collector]->isVecInside(point)) {
+          ASSERT_TRUE(std::binary_search(candidates.begin(), candidates.end(),
+                                         collector))
+              << "collector: " << *collectors[collector]
+              << "point: " << point << "\n"
+              << *builder;
+        }
+      }
+    }
+  }
+}
+
+TEST(CollectorIndexTest, IndexedCollectionCollectsTheSameEnergy) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  const float wallRadius = getSphereWallRadius(*model);
+  Collectors collectors =
+      GeometricDomeCollectorBuilder().buildCollectors(model.get(), kSkipNumber);
+  Collectors indexedCollectors = cloneEmptyCollectors(collectors);
+  collectionRules::CollectorIndex index(collectors);
+  collectionRules::NonLinearEnergyCollection energyCollectionRules;
+
+  for (const Vec3 &point : randomPoints(5000, wallRadius)) {
+    RayHitData hitData(point.magnitude(), Vec3::kZ,
+                       Ray(Vec3::kZero, point.normalize()), kSkipFrequency,
+                       point.magnitude() / constants::kSoundSpeed);
+    RayHitData indexedHitData = hitData;
+    energyCollectionRules.collectEnergy(collectors, &hitData);
+    energyCollectionRules.collectEnergy(indexedCollectors, index,
+                                        &indexedHitData);
+  }
+
+  bool anyEnergyCollected = false;
+  for (size_t collector = 0; collector < collectors.size(); ++collector) {
+    ASSERT_EQ(collectors[collector]->getEnergy(),
+              indexedCollectors[collector]->getEnergy());
+    anyEnergyCollected |= !collectors[collector]->getEnergy().empty();
+  }
+  ASSERT_TRUE(anyEnergyCollected);
+}
+
+template <typename EnergyCollectionRules>
+void expectBandsCollectTheSameEnergyAsSingleFrequencies() {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  const float wallRadius = getSphereWallRadius(*model);
+  // More bands than collection rules process at once.
+  std::vector<float> frequencies;
+  for (int band = 0; band < 20; ++band) {
+    frequencies.push_back(100 * std::pow(2.0f, band / 3.0f));
+  }
+  Collectors collectors =
+      DoubleAxisCollectorBuilder().buildCollectors(model.get(), kSkipNumber);
+  collectionRules::CollectorIndex index(collectors);
+  std::vector<Collectors> expected, collectorsPerBand;
+  std::vector<Collectors *> bands;
+  for (size_t band = 0; band < frequencies.size(); ++band) {
+    expected.push_back(cloneEmptyCollectors(collectors));
+    collectorsPerBand.push_back(cloneEmptyCollectors(collectors));
+  }
+  for (Collectors &band : collectorsPerBand) {
+    bands.push_back(&band);
+  }
+
+  EnergyCollectionRules energyCollectionRules;
+  for (const Vec3 &point : randomPoints(2000, wallRadius)) {
+    RayHitData hitData(point.magnitude(), Vec3::kZ,
+                       Ray(Vec3::kZero, point.normalize(), /*energy=*/2),
+                       kSkipFrequency,
+                       point.magnitude() / constants::kSoundSpeed);
+    energyCollectionRules.collectEnergyInBands(bands, frequencies, index,
+                                               hitData);
+    for (size_t band = 0; band < frequencies.size(); ++band) {
+      RayHitData bandHitData = hitData;
+      bandHitData.frequency = frequencies[band];
+      energyCollectionRules.collectEnergy(expected[band], &bandHitData);
+    }
+  }
+
+  bool anyEnergyCollected = false;
+  for (size_t band = 0; band < frequencies.size(); ++band) {
+    for (size_t collector = 0; collector < collectors.size(); ++collector) {
+      ASSERT_EQ(expected[band][collector]->getEnergy(),
+                collectorsPerBand[band][collector]->getEnergy())
+          << energyCollectionRules << "\nfrequency: " << frequencies[band]
+          << ", collector: " << collector;
+      anyEnergyCollected |= !expected[band][collector]->getEnergy().empty();
+    }
+  }
+  ASSERT_TRUE(anyEnergyCollected);
+}
+
+TEST(CollectEnergyInBandsTest, BandsCollectTheSameEnergyAsSingleFrequencies) {
+  expectBandsCollectTheSameEnergyAsSingleFrequencies<
+      collectionRules::LinearEnergyCollection>();
+  expectBandsCollectTheSameEnergyAsSingleFrequencies<
+      collectionRules::LinearEnergyCollectionWithPhaseImpact>();
+  expectBandsCollectTheSameEnergyAsSingleFrequencies<
+      collectionRules::NonLinearEnergyCollection>();
+}
+
+TEST(CollectEnergyInBandsTest, ThrowsWhenNumberOfBandsIsDifferent) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  Collectors collectors =
+      DoubleAxisCollectorBuilder().buildCollectors(model.get(), kSkipNumber);
+  collectionRules::CollectorIndex index(collectors);
+  collectionRules::LinearEnergyCollection energyCollectionRules;
+  ASSERT_THROW(energyCollectionRules.collectEnergyInBands(
+                   {&collectors}, {100, 200}, index, RayHitData()),
+               std::invalid_argument);
+}
+
+// Splits every reflection into the reflected ray and the ray, that goes back
+// to the hit point, each carrying half of the energy.
+struct HalvingReflectionEngine : public ReflectionEngineInterface {
+  std::vector<Ray> modelReflectedSoundWave(const Ray &reflected,
+                                           float frequency) const override {
+    const float energy = reflected.energy() / 2;
+    Ray escaping = reflected;
+    escaping.setEnergy(energy);
+    return {Ray(reflected.origin() + Vec3::kZ, -Vec3::kZ, energy), escaping};
+  }
+  void printItself(std::ostream &os) const noexcept override {
+    os << "Halving Reflection Engine";
+  }
+};
+
+class EnergyCutoffTest : public ::testing::Test {
+protected:
+  // Traces rays of the point speaker and returns energy of the rays that
+  // reached the sphere wall.
+  double traceEscapedEnergy(float energyCutoff, bool russianRoulette,
+                            TracingStatistics *statistics) {
+    generators::PointSpeakerRayFactory source(/*numOfRaysAlongEachAxis=*/40,
+                                              /*sourcePower=*/1000,
+                                              model.get());
+    Simulator simulator(&rayTracer, model.get(), &source, &offseter,
+                        &positionTracker, &energyCollectionRules,
+                        &reflectionEngine);
+    simulator.setEnergyCutoff(energyCutoff, russianRoulette);
+    EscapeEvents escapeEvents;
+    *statistics =
+        simulator.recordEscapeEvents(kSkipFrequency, kMaxTracking, &escapeEvents);
+    double escapedEnergy = 0;
+    for (const EscapeEvent &event : escapeEvents) {
+      escapedEnergy += event.energy;
+    }
+    return escapedEnergy;
+  }
+
+  static constexpr int kMaxTracking = 12;
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  RayTracer rayTracer{model.get()};
+  generators::FakeOffseter offseter;
+  trackers::FakePositionTracker positionTracker;
+  collectionRules::LinearEnergyCollection energyCollectionRules;
+  HalvingReflectionEngine reflectionEngine;
+};
+
+TEST_F(EnergyCutoffTest, EveryEmittedEnergyIsAccounted) {
+  for (float energyCutoff : {0.0f, 0.01f}) {
+    TracingStatistics statistics;
+    double escapedEnergy =
+        traceEscapedEnergy(energyCutoff, /*russianRoulette=*/false, &statistics);
+    ASSERT_NEAR(statistics.emittedEnergy,
+                escapedEnergy + statistics.discardedEnergy +
+                    statistics.energyAtDepthLimit,
+                1e-5 * statistics.emittedEnergy)
+        << statistics;
+    ASSERT_EQ(energyCutoff > 0, statistics.discardedRays > 0) << statistics;
+  }
+}
+
+TEST_F(EnergyCutoffTest, RussianRouletteIsUnbiased) {
+  TracingStatistics traced;
+  double tracedEnergy = traceEscapedEnergy(/*energyCutoff=*/0,
+                                           /*russianRoulette=*/true, &traced);
+  TracingStatistics roulette;
+  double rouletteEnergy = traceEscapedEnergy(/*energyCutoff=*/0.01,
+                                             /*russianRoulette=*/true,
+                                             &roulette);
+
+  ASSERT_EQ(traced.emittedEnergy, roulette.emittedEnergy);
+  ASSERT_GT(roulette.discardedRays, 0);
+  ASSERT_LE(roulette.maxPendingRays, traced.maxPendingRays);
+  // Discarded energy is given back to the rays that survived.
+  ASSERT_NEAR(tracedEnergy + traced.energyAtDepthLimit,
+              rouletteEnergy + roulette.energyAtDepthLimit,
+              0.02 * traced.emittedEnergy);
+}
+
+TEST(SimulatorTest, InvalidEnergyCutoff) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  RayTracer rayTracer(model.get());
+  generators::CustomPointRayFactory source(Vec3(0.1, 0.2, 1), -Vec3::kZ, 1);
+  generators::FakeOffseter offseter;
+  trackers::FakePositionTracker positionTracker;
+  collectionRules::LinearEnergyCollection energyCollectionRules;
+  FakeReflectionEngine reflectionEngine;
+  Simulator simulator(&rayTracer, model.get(), &source, &offseter,
+                      &positionTracker, &energyCollectionRules,
+                      &reflectionEngine);
+  ASSERT_THROW(simulator.setEnergyCutoff(-0.1), std::invalid_argument);
+  ASSERT_THROW(simulator.setEnergyCutoff(1), std::invalid_argument);
+}
+
+TEST(StochasticFourSidedReflectionEngineTest, ChoosesEveryRayWithEqualChance) {
+  SimpleFourSidedReflectionEngine simpleEngine;
+  StochasticFourSidedReflectionEngine stochasticEngine;
+  const Ray reflected(Vec3(0, 0, 1), Vec3(1, 2, 3).normalize(), 10);
+  const int kNumOfReflections = 5000;
+  std::vector<int> timesChosen(5, 0);
+  for (int pathId = 0; pathId < kNumOfReflections; ++pathId) {
+    core::CounterRandomStream simpleStream(/*seed=*/0, 0, 0, pathId);
+    core::CounterRandomStream stochasticStream(/*seed=*/0, 0, 0, pathId);
+    std::vector<Ray> rays = simpleEngine.modelReflectedSoundWave(
+        reflected, kSkipFrequency, &simpleStream);
+    std::vector<Ray> chosen = stochasticEngine.modelReflectedSoundWave(
+        reflected, kSkipFrequency, &stochasticStream);
+
+    ASSERT_EQ(chosen.size(), 1);
+    ASSERT_EQ(chosen[0].energy(), reflected.energy());
+    auto sameDirection = [&](const Ray &ray) {
+      return ray.direction() == chosen[0].direction();
+    };
+    auto found = std::find_if(rays.begin(), rays.end(), sameDirection);
+    ASSERT_NE(found, rays.end()) << "Chosen ray: " << chosen[0];
+    ++timesChosen[std::distance(rays.begin(), found)];
+  }
+
+  // Expected energy is the same only when every ray is equally likely.
+  for (int count : timesChosen) {
+    ASSERT_NEAR(count, kNumOfReflections / 5, 0.1 * kNumOfReflections / 5);
+  }
+}
+
+TEST(ReflectionEngineTest, BufferAndBatchGiveTheSameRays) {
+  FakeReflectionEngine fakeEngine;
+  SimpleFourSidedReflectionEngine simpleEngine;
+  StochasticFourSidedReflectionEngine stochasticEngine;
+  const int kNumOfReflected = 16;
+  std::vector<Ray> reflected;
+  for (int index = 0; index < kNumOfReflected; ++index) {
+    const float angle = 2 * kPi * index / kNumOfReflected;
+    reflected.emplace_back(Vec3(0, 0, 1),
+                           Vec3(std::cos(angle), std::sin(angle), 1).normalize(),
+                           /*energy=*/10);
+  }
+
+  ReflectedRays buffer;
+  for (const ReflectionEngineInterface *engine :
+       std::vector<const ReflectionEngineInterface *>{
+           &fakeEngine, &simpleEngine, &stochasticEngine}) {
+    std::vector<core::CounterRandomStream> batchStreams;
+    for (int index = 0; index < kNumOfReflected; ++index) {
+      batchStreams.emplace_back(/*seed=*/0, 0, 0, index);
+    }
+    std::vector<ReflectedRays> batch(kNumOfReflected);
+    engine->modelReflectedSoundWaves(reflected.data(), reflected.size(),
+                                     kSkipFrequency, batchStreams.data(),
+                                     batch.data());
+
+    for (int index = 0; index < kNumOfReflected; ++index) {
+      core::CounterRandomStream vectorStream(/*seed=*/0, 0, 0, index);
+      core::CounterRandomStream bufferStream(/*seed=*/0, 0, 0, index);
+      std::vector<Ray> expected = engine->modelReflectedSoundWave(
+          reflected[index], kSkipFrequency, &vectorStream);
+      engine->modelReflectedSoundWave(reflected[index], kSkipFrequency,
+                                      &bufferStream, &buffer);
+      ASSERT_EQ(expected, std::vector<Ray>(buffer.begin(), buffer.end()))
+          << *engine;
+      ASSERT_EQ(expected, std::vector<Ray>(batch[index].begin(),
+                                           batch[index].end()))
+          << *engine;
+    }
+  }
+
+  // Stochastic engine left single ray in the buffer.
+  for (size_t index = buffer.size(); index < ReflectedRays::kCapacity;
+       ++index) {
+    buffer.push_back(reflected[0]);
+  }
+  ASSERT_THROW(buffer.push_back(reflected[0]), std::length_error);
+}
+
+TEST(PolicySimulatorTest, BoundPoliciesGiveTheSameResultsAsInterfaces) {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  RayTracer rayTracer(model.get());
+  const objects::SphereWall sphereWall(getSphereWallRadius(*model));
+  trackers::FakePositionTracker positionTracker;
+  collectionRules::LinearEnergyCollection energyCollectionRules;
+  StochasticFourSidedReflectionEngine reflectionEngine;
+  const int kMaxTracking = 6;
+
+  generators::PointSpeakerRayFactory boundSource(
+      /*numOfRaysAlongEachAxis=*/20, /*sourcePower=*/1000, model.get());
+  PolicySimulator<generators::PointSpeakerRayFactory,
+                  trackers::FakePositionTracker,
+                  collectionRules::LinearEnergyCollection,
+                  StochasticFourSidedReflectionEngine>
+      boundSimulator(&rayTracer, &sphereWall, &boundSource, &positionTracker,
+                     &energyCollectionRules, &reflectionEngine, /*seed=*/3,
+                     /*energyCutoff=*/0.05, /*russianRoulette=*/true);
+  EscapeEvents boundEvents;
+  TracingStatistics boundStatistics;
+  boundSimulator.traceSource({kSkipFrequency, kMaxTracking,
+                              /*collectors=*/nullptr,
+                              /*collectorIndex=*/nullptr, &boundEvents,
+                              &positionTracker, &boundStatistics});
+
+  generators::PointSpeakerRayFactory virtualSource(
+      /*numOfRaysAlongEachAxis=*/20, /*sourcePower=*/1000, model.get());
+  PolicySimulator<generators::RayFactory, trackers::PositionTrackerInterface,
+                  collectionRules::CollectEnergyInterface,
+                  ReflectionEngineInterface>
+      virtualSimulator(&rayTracer, &sphereWall, &virtualSource,
+                       &positionTracker, &energyCollectionRules,
+                       &reflectionEngine, /*seed=*/3, /*energyCutoff=*/0.05,
+                       /*russianRoulette=*/true);
+  EscapeEvents virtualEvents;
+  TracingStatistics virtualStatistics;
+  virtualSimulator.traceSource({kSkipFrequency, kMaxTracking,
+                                /*collectors=*/nullptr,
+                                /*collectorIndex=*/nullptr, &virtualEvents,
+                                &positionTracker, &virtualStatistics});
+
+  ASSERT_FALSE(boundEvents.empty());
+  ASSERT_EQ(boundEvents.size(), virtualEvents.size());
+  for (size_t index = 0; index < boundEvents.size(); ++index) {
+    ASSERT_EQ(boundEvents[index].hitPoint, virtualEvents[index].hitPoint);
+    ASSERT_EQ(boundEvents[index].energy, virtualEvents[index].energy);
+    ASSERT_EQ(boundEvents[index].accumulatedTime,
+              virtualEvents[index].accumulatedTime);
+  }
+  ASSERT_EQ(boundStatistics.emittedEnergy, virtualStatistics.emittedEnergy);
+  ASSERT_EQ(boundStatistics.discardedRays, virtualStatistics.discardedRays);
+}
+
+// Collects energy of the rays of the point speaker with |rules|. Only
+// candidates of CollectorIndex are checked when |useCollectorIndex| is true.
+template <typename Rules>
+Collectors collectEnergyWithRules(Model *model, Rules *rules,
+                                  bool useCollectorIndex) {
+  RayTracer rayTracer(model);
+  const objects::SphereWall sphereWall(getSphereWallRadius(*model));
+  trackers::FakePositionTracker positionTracker;
+  StochasticFourSidedReflectionEngine reflectionEngine;
+  DoubleAxisCollectorBuilder collectorBuilder;
+  Collectors collectors =
+      collectorBuilder.buildCollectors(model, /*numCollectors=*/37);
+  const collectionRules::CollectorIndex collectorIndex(collectors);
+
+  generators::PointSpeakerRayFactory source(
+      /*numOfRaysAlongEachAxis=*/20, /*sourcePower=*/1000, model);
+  PolicySimulator<generators::RayFactory, trackers::PositionTrackerInterface,
+                  Rules, ReflectionEngineInterface>
+      simulator(&rayTracer, &sphereWall, &source, &positionTracker, rules,
+                &reflectionEngine, /*seed=*/3, /*energyCutoff=*/0.05,
+                /*russianRoulette=*/true);
+  TracingStatistics statistics;
+  simulator.traceSource({kSkipFrequency, /*maxTracking=*/6, &collectors,
+                         useCollectorIndex ? &collectorIndex : nullptr,
+                         /*escapeEvents=*/nullptr, &positionTracker,
+                         &statistics});
+  return collectors;
+}
+
+template <typename Rules> void expectBoundRulesCollectTheSameEnergy() {
+  std::unique_ptr<Model> model = Model::NewReferenceModel(1);
+  Rules rules;
+  for (bool useCollectorIndex : {false, true}) {
+    Collectors bound =
+        collectEnergyWithRules(model.get(), &rules, useCollectorIndex);
+    collectionRules::CollectEnergyInterface *virtualRules = &rules;
+    Collectors virtualCollectors =
+        collectEnergyWithRules(model.get(), virtualRules, useCollectorIndex);
+    ASSERT_EQ(bound.size(), virtualCollectors.size());
+    float totalEnergy = 0;
+    for (size_t index = 0; index < bound.size(); ++index) {
+      ASSERT_EQ(bound[index]->getEnergy(),
+                virtualCollectors[index]->getEnergy())
+          << rules << ", collector: " << index;
+      totalEnergy += std::abs(bound[index]->getEnergy().totalEnergy());
+    }
+    ASSERT_GT(totalEnergy, 0) << rules;
+  }
+}
+
+TEST(PolicySimulatorTest, BoundRulesCollectTheSameEnergyAsInterface) {
+  expectBoundRulesCollectTheSameEnergy<
+      collectionRules::LinearEnergyCollection>();
+  expectBoundRulesCollectTheSameEnergy<
+      collectionRules::LinearEnergyCollectionWithPhaseImpact>();
+  expectBoundRulesCollectTheSameEnergy<
+      collectionRules::NonLinearEnergyCollection>();
+}
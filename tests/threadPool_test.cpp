@@ -0,0 +1,36 @@
+#include "core/threadPool.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using core::ThreadPool;
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool threadPool(4);
+  std::vector<std::atomic<int>> visits(1000);
+  threadPool.parallelFor(visits.size(),
+                         [&visits](size_t index) { ++visits[index]; });
+  for (size_t index = 0; index < visits.size(); ++index) {
+    ASSERT_EQ(1, visits[index].load()) << "index: " << index;
+  }
+}
+
+TEST(ThreadPoolTest, ExceptionIsRethrown) {
+  ThreadPool threadPool(2);
+  std::atomic<int> finished(0);
+  ASSERT_THROW(threadPool.parallelFor(10,
+                                      [&finished](size_t index) {
+                                        if (index == 3) {
+                                          throw std::runtime_error("task");
+                                        }
+                                        ++finished;
+                                      }),
+               std::runtime_error);
+  ASSERT_EQ(9, finished.load());
+}
+
+TEST(ThreadPoolTest, InvalidNumberOfThreads) {
+  ASSERT_THROW(ThreadPool(0), std::invalid_argument);
+}
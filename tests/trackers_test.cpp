@@ -1,7 +1,11 @@
 #include "main/trackers.h"
 #include "gtest/gtest.h"
 
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 using Json = nlohmann::json;
 using trackers::File;
@@ -32,3 +36,144 @@ TEST(TrackersTest, AcquiringJsonFileToBuffer) {
   FakeFile file;
   file.write(buffer);
 }
+
+// Scale of BinaryPositionTracker is 1 / 1024 m, so positions of the
+// trackings are stored without any loss.
+const float kExactMaxDistance = 32767.0f / 1024;
+
+// Tracks rays of the model and the reference model, like SceneManager does.
+void trackTwoModels(trackers::PositionTrackerInterface *tracker) {
+  for (bool referenceModel : {false, true}) {
+    if (referenceModel) {
+      tracker->switchToReferenceModel();
+    }
+    for (float frequency : {500.0f, 1000.0f}) {
+      tracker->initializeNewFrequency(frequency);
+      for (int ray = 0; ray < 3; ++ray) {
+        tracker->initializeNewTracking();
+        // Second ray does not hit anything.
+        const int numOfPositions = ray == 1 ? 1 : ray + 2;
+        for (int position = 0; position < numOfPositions; ++position) {
+          core::Ray hitRay(core::Vec3(0.5 * position, -1.25, 2),
+                           position % 2 == 0 ? core::Vec3::kZ
+                                             : core::Vec3(-1, 0, 0),
+                           1.0f / (position + 1));
+          tracker->addNewPositionToCurrentTracking(core::RayHitData(
+              position + 0.5, core::Vec3::kZ, hitRay, frequency));
+        }
+        tracker->endCurrentTracking();
+      }
+      tracker->endCurrentFrequency();
+    }
+    tracker->save();
+  }
+}
+
+std::string readFile(const std::string &path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+TEST(TrackersTest, BinaryTrackerIndexesRecordsOfEveryFrequency) {
+  const std::string path = ::testing::TempDir() + "binaryTracking";
+  std::filesystem::create_directories(path);
+  {
+    trackers::BinaryPositionTracker tracker(path, kExactMaxDistance);
+    trackTwoModels(&tracker);
+  }
+
+  trackers::BinaryTrackingReader reader(path);
+  ASSERT_EQ(reader.index().size(), 4u);
+  uint64_t firstRecord = 0;
+  for (size_t entry = 0; entry < reader.index().size(); ++entry) {
+    const trackers::TrackingIndexEntry &index = reader.index()[entry];
+    EXPECT_EQ(index.frequency, entry % 2 == 0 ? 500 : 1000);
+    EXPECT_EQ(index.referenceModel, static_cast<uint32_t>(entry >= 2));
+    EXPECT_EQ(index.firstRecord, firstRecord);
+    // Tracking of the ray that did not hit anything is skipped.
+    EXPECT_EQ(index.numOfRecords, 2u + 4u);
+    firstRecord += index.numOfRecords;
+  }
+
+  const trackers::TrackingIndexEntry &entry = reader.index()[1];
+  const trackers::TrackingRecord record = reader.record(entry.firstRecord + 3);
+  EXPECT_EQ(record.indexInTracking, 1);
+  const core::RayHitData hitData = reader.decode(record, entry);
+  EXPECT_EQ(hitData.origin(), core::Vec3(0.5, -1.25, 2));
+  EXPECT_EQ(hitData.direction(), core::Vec3(-1, 0, 0));
+  EXPECT_EQ(hitData.collisionPoint(), core::Vec3(-1, -1.25, 2));
+  EXPECT_EQ(hitData.energy(), 0.5);
+  EXPECT_EQ(hitData.frequency, 1000);
+}
+
+TEST(TrackersTest, ConvertedBinaryTrackingIsTheSameAsJsonTracking) {
+  const std::string jsonPath = ::testing::TempDir() + "jsonTracking";
+  const std::string binaryPath = ::testing::TempDir() + "binaryTracking";
+  std::filesystem::create_directories(jsonPath);
+  std::filesystem::create_directories(binaryPath);
+  {
+    trackers::JsonPositionTracker tracker(jsonPath);
+    trackTwoModels(&tracker);
+  }
+  {
+    trackers::BinaryPositionTracker tracker(binaryPath, kExactMaxDistance);
+    trackTwoModels(&tracker);
+  }
+
+  trackers::convertBinaryTrackingToJs(binaryPath);
+
+  const std::string expected = readFile(jsonPath + "/trackingData.js");
+  EXPECT_NE(expected.find("referenceTrackingData"), std::string::npos);
+  EXPECT_EQ(readFile(binaryPath + "/trackingData.js"), expected);
+}
+
+TEST(TrackersTest, BinaryTrackingReaderThrowsAtMissingFiles) {
+  EXPECT_THROW(trackers::BinaryTrackingReader("./doesNotExist"),
+               std::invalid_argument);
+}
+
+TEST(TrackersTest, AsyncFileWriterKeepsOrderOfAppends) {
+  const std::string firstPath = ::testing::TempDir() + "firstAsync.txt";
+  const std::string secondPath = ::testing::TempDir() + "secondAsync.txt";
+  // Buffer smaller than appended data makes appends wait for the writer.
+  trackers::AsyncFileWriter writer(/*bufferSize=*/64);
+  File first(firstPath, &writer);
+  File second(secondPath, &writer);
+  first.openFileWithOverwrite();
+  second.openFileWithOverwrite();
+
+  std::string expectedFirst, expectedSecond;
+  for (int line = 0; line < 1000; ++line) {
+    FileBuffer buffer;
+    buffer.stream << "line: " << line;
+    if (line % 3 == 0) {
+      second.write(buffer);
+      expectedSecond += "line: " + std::to_string(line) + "\n";
+    } else {
+      first.write(buffer);
+      expectedFirst += "line: " + std::to_string(line) + "\n";
+    }
+  }
+  first.flush();
+
+  EXPECT_EQ(readFile(firstPath), expectedFirst);
+  EXPECT_EQ(readFile(secondPath), expectedSecond);
+  const trackers::AsyncFileWriter::Statistics statistics = writer.statistics();
+  EXPECT_EQ(statistics.numOfAppends, 1000u);
+  EXPECT_EQ(statistics.writtenBytes,
+            expectedFirst.size() + expectedSecond.size());
+  // Append, which does not wait, may exceed the buffer by one line.
+  EXPECT_LE(statistics.maxBufferedBytes,
+            64u + std::string("line: 999\n").size());
+}
+
+TEST(TrackersTest, AsyncFileWriterRethrowsFailedWrite) {
+  trackers::AsyncFileWriter writer;
+  writer.append("./doesNotExist/file.txt", "data");
+  EXPECT_THROW(writer.flush(), std::invalid_argument);
+  EXPECT_NO_THROW(writer.flush());
+  EXPECT_THROW(File("./doesNotExist/file.txt", &writer).openFileWithOverwrite(),
+               std::invalid_argument);
+}